@@ -1,7 +1,16 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #define MEMORY_SIZE 0x1000000
 
@@ -628,6 +637,774 @@ void execute_cycle(Registers* registers, uint8_t* memory) {
     printf("\n");
 }
 
+// ============================================================================
+// Threaded-code 실행 엔진
+// 로드된 프로그램을 한 번 번역해서 명령어마다 핸들러 포인터와 미리 풀어 둔
+// 필드를 가진 배열로 만든다. 실행 시에는 디코드 없이 PC로 배열을 인덱싱해
+// 핸들러만 호출한다. 결과(레지스터, 명령어 종류별 카운트)는 위의
+// execute_cycle 루프와 동일하다.
+// ============================================================================
+
+typedef struct ThreadedOp ThreadedOp;
+typedef void (*ThreadedHandler)(const ThreadedOp* op, Registers* registers);
+
+struct ThreadedOp {
+    ThreadedHandler handler;
+    uint32_t rs;
+    uint32_t rt;
+    uint32_t rd;
+    uint32_t shamt;
+    uint32_t imm;       // 확장된 immediate, 분기 오프셋 또는 점프 목적지
+};
+
+static ThreadedOp* threaded_ops = NULL;
+static uint32_t threaded_limit = 0;    // 번역된 영역의 끝 주소
+
+#define TPC(r)          ((uint32_t)(r)->program_counter)
+#define NEXT_PC(r)      ((r)->program_counter += 4)
+#define WRITE_REG(r, n, v) do { if ((n) != 0) (r)->regs[(n)] = (v); } while (0)
+
+static void translate_at(uint32_t pc);
+
+static uint32_t threaded_read_word(uint32_t address) {
+    return (uint32_t)memory[address] | ((uint32_t)memory[address + 1] << 8) |
+           ((uint32_t)memory[address + 2] << 16) | ((uint32_t)memory[address + 3] << 24);
+}
+
+// --- R-type ---
+static void op_add(const ThreadedOp* op, Registers* r) {
+    instruction_count++; rtype_count++;
+    WRITE_REG(r, op->rd, r->regs[op->rs] + r->regs[op->rt]);
+    NEXT_PC(r);
+}
+static void op_sub(const ThreadedOp* op, Registers* r) {
+    instruction_count++; rtype_count++;
+    WRITE_REG(r, op->rd, r->regs[op->rs] - r->regs[op->rt]);
+    NEXT_PC(r);
+}
+static void op_and(const ThreadedOp* op, Registers* r) {
+    instruction_count++; rtype_count++;
+    WRITE_REG(r, op->rd, r->regs[op->rs] & r->regs[op->rt]);
+    NEXT_PC(r);
+}
+static void op_or(const ThreadedOp* op, Registers* r) {
+    instruction_count++; rtype_count++;
+    WRITE_REG(r, op->rd, r->regs[op->rs] | r->regs[op->rt]);
+    NEXT_PC(r);
+}
+static void op_xor(const ThreadedOp* op, Registers* r) {
+    instruction_count++; rtype_count++;
+    WRITE_REG(r, op->rd, r->regs[op->rs] ^ r->regs[op->rt]);
+    NEXT_PC(r);
+}
+static void op_nor(const ThreadedOp* op, Registers* r) {
+    instruction_count++; rtype_count++;
+    WRITE_REG(r, op->rd, ~(r->regs[op->rs] | r->regs[op->rt]));
+    NEXT_PC(r);
+}
+static void op_slt(const ThreadedOp* op, Registers* r) {      // slt, sltu (alu_operation과 같이 부호 비교)
+    instruction_count++; rtype_count++;
+    WRITE_REG(r, op->rd, ((int32_t)r->regs[op->rs] < (int32_t)r->regs[op->rt]) ? 1 : 0);
+    NEXT_PC(r);
+}
+static void op_sll(const ThreadedOp* op, Registers* r) {
+    instruction_count++; rtype_count++;
+    WRITE_REG(r, op->rd, r->regs[op->rt] << op->shamt);
+    NEXT_PC(r);
+}
+static void op_srl(const ThreadedOp* op, Registers* r) {
+    instruction_count++; rtype_count++;
+    WRITE_REG(r, op->rd, r->regs[op->rt] >> op->shamt);
+    NEXT_PC(r);
+}
+static void op_mult(const ThreadedOp* op, Registers* r) {
+    instruction_count++; rtype_count++;
+    uint64_t temp = (uint64_t)r->regs[op->rs] * (uint64_t)r->regs[op->rt];
+    high_word = (temp >> 32) & 0xffffffff;
+    low_word = temp & 0xffffffff;
+    WRITE_REG(r, op->rd, 0);
+    NEXT_PC(r);
+}
+static void op_mflo(const ThreadedOp* op, Registers* r) {
+    instruction_count++; rtype_count++;
+    WRITE_REG(r, op->rd, (uint32_t)low_word);
+    NEXT_PC(r);
+}
+static void op_jr(const ThreadedOp* op, Registers* r) {
+    instruction_count++; rtype_count++;
+    r->program_counter = r->regs[op->rs];
+}
+static void op_jalr(const ThreadedOp* op, Registers* r) {
+    instruction_count++; rtype_count++;
+    uint32_t target = r->regs[op->rs];
+    // execute_instruction이 rd에 PC+4를 쓴 뒤 write_back이 ALU 결과(0)로 덮어쓴다
+    WRITE_REG(r, op->rd, 0);
+    r->program_counter = target;
+}
+
+// --- I-type ---
+static void op_addi(const ThreadedOp* op, Registers* r) {
+    instruction_count++; itype_count++;
+    WRITE_REG(r, op->rt, r->regs[op->rs] + op->imm);
+    NEXT_PC(r);
+}
+static void op_slti(const ThreadedOp* op, Registers* r) {
+    instruction_count++; itype_count++;
+    WRITE_REG(r, op->rt, ((int32_t)r->regs[op->rs] < (int32_t)op->imm) ? 1 : 0);
+    NEXT_PC(r);
+}
+static void op_andi(const ThreadedOp* op, Registers* r) {
+    instruction_count++; itype_count++;
+    WRITE_REG(r, op->rt, r->regs[op->rs] & op->imm);
+    NEXT_PC(r);
+}
+static void op_ori(const ThreadedOp* op, Registers* r) {
+    instruction_count++; itype_count++;
+    WRITE_REG(r, op->rt, r->regs[op->rs] | op->imm);
+    NEXT_PC(r);
+}
+static void op_lui(const ThreadedOp* op, Registers* r) {
+    instruction_count++; itype_count++;
+    WRITE_REG(r, op->rt, op->imm);
+    NEXT_PC(r);
+}
+static void op_lw(const ThreadedOp* op, Registers* r) {
+    instruction_count++; itype_count++; memory_count++;
+    WRITE_REG(r, op->rt, read_from_memory(r->regs[op->rs] + op->imm));
+    NEXT_PC(r);
+}
+static void op_sw(const ThreadedOp* op, Registers* r) {
+    instruction_count++; itype_count++; memory_count++;
+    uint32_t address = r->regs[op->rs] + op->imm;
+    write_to_memory(address, r->regs[op->rt]);
+    NEXT_PC(r);
+    // 번역된 코드 영역에 쓰면 해당 엔트리를 다시 번역
+    if (address < threaded_limit) {
+        translate_at(address & ~0x3u);
+        if ((address & 0x3) != 0 && (address & ~0x3u) + 4 < threaded_limit) {
+            translate_at((address & ~0x3u) + 4);
+        }
+    }
+}
+static void op_beq(const ThreadedOp* op, Registers* r) {
+    instruction_count++; itype_count++; branch_count++;
+    NEXT_PC(r);
+    if (r->regs[op->rs] == r->regs[op->rt]) {
+        r->program_counter += op->imm;
+    }
+}
+static void op_bne(const ThreadedOp* op, Registers* r) {
+    instruction_count++; itype_count++; branch_count++;
+    NEXT_PC(r);
+    if (r->regs[op->rs] != r->regs[op->rt]) {
+        r->program_counter += op->imm;
+    }
+}
+static void op_itype_nop(const ThreadedOp* op, Registers* r) {     // 제어 신호가 없는 I-type
+    instruction_count++; itype_count++;
+    NEXT_PC(r);
+}
+
+// --- J-type ---
+static void op_j(const ThreadedOp* op, Registers* r) {
+    instruction_count++; jtype_count++;
+    r->program_counter = op->imm;
+}
+static void op_jal(const ThreadedOp* op, Registers* r) {
+    instruction_count++; jtype_count++;
+    r->regs[31] = TPC(r) + 4;
+    r->program_counter = op->imm;
+}
+
+// instruction == 0 (카운트하지 않음)
+static void op_nop(const ThreadedOp* op, Registers* r) {
+    NEXT_PC(r);
+}
+
+static void translate_instruction(uint32_t pc, uint32_t instruction, ThreadedOp* op) {
+    uint32_t opcode = instruction >> 26;
+    uint32_t funct = instruction & 0x3f;
+    uint32_t imm16 = instruction & 0xffff;
+    uint32_t sign_imm = (imm16 >> 15) ? (imm16 | 0xffff0000) : imm16;
+
+    memset(op, 0, sizeof(*op));
+    op->rs = (instruction >> 21) & 0x1f;
+    op->rt = (instruction >> 16) & 0x1f;
+    op->rd = (instruction >> 11) & 0x1f;
+    op->shamt = (instruction >> 6) & 0x1f;
+
+    if (instruction == 0) {
+        op->handler = op_nop;
+        return;
+    }
+
+    switch (opcode) {
+        case 0:
+            switch (funct) {
+                case 0x20: case 0x21: op->handler = op_add; break;
+                case 0x22: case 0x23: op->handler = op_sub; break;
+                case 0x24: op->handler = op_and; break;
+                case 0x25: op->handler = op_or; break;
+                case 0x26: op->handler = op_xor; break;
+                case 0x27: op->handler = op_nor; break;
+                case 0x2a: case 0x2b: op->handler = op_slt; break;
+                case 0x00: op->handler = op_sll; break;
+                case 0x02: op->handler = op_srl; break;
+                case 0x18: op->handler = op_mult; break;
+                case 0x12: op->handler = op_mflo; break;
+                case 0x08: op->handler = op_jr; break;
+                case 0x09: op->handler = op_jalr; break;
+                default: op->handler = op_add; break;   // select_alu_operation의 기본값 (더하기)
+            }
+            break;
+        case 2:
+            op->handler = op_j;
+            op->imm = (pc & 0xf0000000) | ((instruction & 0x3ffffff) << 2);
+            break;
+        case 3:
+            op->handler = op_jal;
+            op->imm = (pc & 0xf0000000) | ((instruction & 0x3ffffff) << 2);
+            break;
+        case 4:
+        case 5:
+            op->handler = (opcode == 4) ? op_beq : op_bne;
+            op->imm = (imm16 << 2) | ((imm16 >> 15) ? 0xfffc0000 : 0);
+            break;
+        case 8: case 9: op->handler = op_addi; op->imm = sign_imm; break;
+        case 10: case 11: op->handler = op_slti; op->imm = sign_imm; break;
+        case 12: op->handler = op_andi; op->imm = imm16; break;
+        case 13: op->handler = op_ori; op->imm = imm16; break;
+        case 15: op->handler = op_lui; op->imm = imm16 << 16; break;
+        case 35: op->handler = op_lw; op->imm = sign_imm; break;
+        case 43: op->handler = op_sw; op->imm = sign_imm; break;
+        default: op->handler = op_itype_nop; break;
+    }
+}
+
+static void translate_at(uint32_t pc) {
+    translate_instruction(pc, threaded_read_word(pc), &threaded_ops[pc >> 2]);
+}
+
+void translate_program(uint32_t code_size) {
+    threaded_limit = code_size & ~0x3u;
+    threaded_ops = calloc(threaded_limit / 4 + 1, sizeof(ThreadedOp));
+    for (uint32_t pc = 0; pc < threaded_limit; pc += 4) {
+        translate_at(pc);
+    }
+}
+
+void run_threaded(Registers* registers) {
+    ThreadedOp* ops = threaded_ops;
+    uint32_t limit = threaded_limit;
+    ThreadedOp scratch;
+
+    while (TPC(registers) != 0xffffffff) {
+        uint32_t pc = TPC(registers);
+
+        if (pc < limit && (pc & 0x3) == 0) {
+            const ThreadedOp* op = &ops[pc >> 2];
+            op->handler(op, registers);
+        } else {
+            // 번역 영역 밖: 그 자리에서 한 개만 번역해서 실행
+            translate_instruction(pc, threaded_read_word(pc), &scratch);
+            scratch.handler(&scratch, registers);
+        }
+    }
+}
+
+// ============================================================================
+// 기본 블록 단위 동적 바이너리 번역기 (MIPS -> x86-64)
+// 처음 실행되는 게스트 PC에서 분기/점프까지를 한 블록으로 묶어 호스트 코드로
+// 번역하고, 게스트 PC를 키로 캐시한다. 목적지가 고정된 exit는 처음 지나갈 때
+// 다음 블록으로 직접 jmp하도록 패치(체이닝)한다. 지원하지 않는 명령어와
+// 범위를 벗어난 메모리 접근은 위의 threaded 핸들러로 한 개씩 해석한다.
+//
+// 생성 코드 레지스터 규약: rbx = DbtContext*, r12 = memory, eax/ecx = 임시
+// ============================================================================
+#if defined(__x86_64__) && defined(__linux__)
+
+#define DBT_CODE_SIZE       (16 * 1024 * 1024)
+#define DBT_CODE_MARGIN     (64 * 1024)     // 블록 하나의 최대 코드 크기보다 넉넉하게
+#define DBT_MAX_BLOCK       64              // 블록당 최대 게스트 명령어 수
+#define DBT_HASH_SIZE       65536
+#define DBT_MAX_EXITS       (1 << 20)
+
+#define DBT_EXIT_INDIRECT   (-1)    // jr/jalr: 목적지가 런타임 값
+#define DBT_EXIT_INTERP     (-2)    // 지원하지 않는 명령어 또는 범위 밖 메모리 접근
+#define DBT_EXIT_SMC        (-3)    // 번역된 코드 영역에 저장 -> 번역 캐시 비움
+
+enum { CNT_INST, CNT_R, CNT_I, CNT_J, CNT_MEM, CNT_BRANCH, CNT_NUM };
+
+typedef struct {
+    Registers regs;                 // regs[32], program_counter
+    int32_t counts[CNT_NUM];        // 생성 코드가 직접 더하는 명령어 카운트
+    uint32_t code_limit;            // 번역된 게스트 코드의 끝 주소 (SMC 검사용)
+} DbtContext;
+
+typedef struct {
+    uint32_t guest_pc;
+    uint8_t* code;                  // NULL이면 빈 슬롯
+} DbtBlock;
+
+typedef struct {
+    uint8_t* site;                  // 패치할 jmp/jcc rel32 명령어
+    int length;                     // 명령어 길이 (jmp 5, jcc 6)
+} DbtExit;
+
+typedef struct {
+    uint8_t* site;
+    int length;
+    uint32_t pc;                    // stub이 기록할 게스트 PC
+    int32_t counts[CNT_NUM];        // stub에서 더할 카운트 (직접 exit는 0)
+    int code;                       // 반환 코드 (>= 0 이면 체이닝 가능한 exit 번호)
+} DbtStub;
+
+typedef int (*DbtEntryFn)(DbtContext* ctx, uint8_t* mem, uint8_t* code);
+
+static uint8_t* dbt_code = NULL;
+static uint8_t* dbt_ptr;
+static uint8_t* dbt_entry;
+static uint8_t* dbt_epilogue;
+static DbtBlock dbt_blocks[DBT_HASH_SIZE];
+static DbtExit* dbt_exits = NULL;
+static int dbt_num_exits = 0;
+static int dbt_last_exit = -1;      // 직전에 빠져나온 직접 exit (다음 블록으로 체이닝)
+
+#define CTX_REG(n)      ((int32_t)(offsetof(DbtContext, regs.regs) + 4 * (n)))
+#define CTX_PC          ((int32_t)offsetof(DbtContext, regs.program_counter))
+#define CTX_CNT(k)      ((int32_t)(offsetof(DbtContext, counts) + 4 * (k)))
+#define CTX_CODE_LIMIT  ((int32_t)offsetof(DbtContext, code_limit))
+
+#define X_EAX 0
+#define X_ECX 1
+
+#define CC_B  0x2
+#define CC_E  0x4
+#define CC_NE 0x5
+#define CC_A  0x7
+
+static void emit8(uint8_t b) { *dbt_ptr++ = b; }
+static void emit32(uint32_t v) { memcpy(dbt_ptr, &v, 4); dbt_ptr += 4; }
+
+// mov r32, [rbx+disp32]
+static void emit_load(int reg, int32_t disp) { emit8(0x8B); emit8(0x83 | (reg << 3)); emit32(disp); }
+// mov [rbx+disp32], r32
+static void emit_store(int reg, int32_t disp) { emit8(0x89); emit8(0x83 | (reg << 3)); emit32(disp); }
+// <op> eax, [rbx+disp32]   (add 03, or 0B, and 23, sub 2B, cmp 3B)
+static void emit_op_mem(uint8_t opc, int32_t disp) { emit8(opc); emit8(0x83); emit32(disp); }
+// <op> eax, imm32          (add 05, or 0D, and 25, cmp 3D)
+static void emit_op_imm(uint8_t opc, uint32_t imm) { emit8(opc); emit32(imm); }
+// mov dword [rbx+disp32], imm32
+static void emit_store_imm(int32_t disp, uint32_t imm) { emit8(0xC7); emit8(0x83); emit32(disp); emit32(imm); }
+// add dword [rbx+disp32], imm32
+static void emit_add_mem_imm(int32_t disp, uint32_t imm) { emit8(0x81); emit8(0x83); emit32(disp); emit32(imm); }
+// setl al; movzx eax, al
+static void emit_setl_eax(void) { emit8(0x0F); emit8(0x9C); emit8(0xC0); emit8(0x0F); emit8(0xB6); emit8(0xC0); }
+
+static void patch_rel32(uint8_t* site, int length, uint8_t* target) {
+    int32_t rel = (int32_t)(target - (site + length));
+    memcpy(site + length - 4, &rel, 4);
+}
+
+static uint8_t* emit_jmp(uint8_t* target) {
+    uint8_t* site = dbt_ptr;
+    emit8(0xE9); emit32(0);
+    if (target) patch_rel32(site, 5, target);
+    return site;
+}
+
+static uint8_t* emit_jcc(uint8_t cc) {
+    uint8_t* site = dbt_ptr;
+    emit8(0x0F); emit8(0x80 | cc); emit32(0);
+    return site;
+}
+
+static void emit_counts(const int32_t counts[CNT_NUM]) {
+    for (int k = 0; k < CNT_NUM; k++) {
+        if (counts[k] != 0) {
+            emit_add_mem_imm(CTX_CNT(k), (uint32_t)counts[k]);
+        }
+    }
+}
+
+// 게스트 PC를 기록하고 디스패처로 돌아간다
+static void emit_exit_inline(uint32_t pc, int code) {
+    emit_store_imm(CTX_PC, pc);
+    emit8(0xB8); emit32((uint32_t)code);       // mov eax, code
+    emit_jmp(dbt_epilogue);
+}
+
+static void dbt_flush(void) {
+    memset(dbt_blocks, 0, sizeof(dbt_blocks));
+    dbt_num_exits = 0;
+    dbt_last_exit = -1;
+    dbt_ptr = dbt_epilogue + 8;
+}
+
+static void dbt_init(void) {
+    dbt_code = mmap(NULL, DBT_CODE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (dbt_code == MAP_FAILED) {
+        perror("mmap");
+        exit(1);
+    }
+    dbt_exits = calloc(DBT_MAX_EXITS, sizeof(DbtExit));
+    dbt_ptr = dbt_code;
+
+    // 진입 트램펄린: int entry(DbtContext* rdi, uint8_t* rsi, code rdx)
+    dbt_entry = dbt_ptr;
+    emit8(0x53);                                // push rbx
+    emit8(0x41); emit8(0x54);                   // push r12
+    emit8(0x55);                                // push rbp
+    emit8(0x48); emit8(0x89); emit8(0xFB);      // mov rbx, rdi
+    emit8(0x49); emit8(0x89); emit8(0xF4);      // mov r12, rsi
+    emit8(0xFF); emit8(0xE2);                   // jmp rdx
+
+    dbt_epilogue = dbt_ptr;
+    emit8(0x5D);                                // pop rbp
+    emit8(0x41); emit8(0x5C);                   // pop r12
+    emit8(0x5B);                                // pop rbx
+    emit8(0xC3);                                // ret
+
+    dbt_flush();
+}
+
+static uint8_t* dbt_lookup(uint32_t pc) {
+    uint32_t index = (pc >> 2) & (DBT_HASH_SIZE - 1);
+    while (dbt_blocks[index].code != NULL) {
+        if (dbt_blocks[index].guest_pc == pc) {
+            return dbt_blocks[index].code;
+        }
+        index = (index + 1) & (DBT_HASH_SIZE - 1);
+    }
+    return NULL;
+}
+
+static void dbt_insert(uint32_t pc, uint8_t* code) {
+    uint32_t index = (pc >> 2) & (DBT_HASH_SIZE - 1);
+    while (dbt_blocks[index].code != NULL) {
+        index = (index + 1) & (DBT_HASH_SIZE - 1);
+    }
+    dbt_blocks[index].guest_pc = pc;
+    dbt_blocks[index].code = code;
+}
+
+static int dbt_is_supported(uint32_t instruction) {
+    uint32_t opcode = instruction >> 26;
+    uint32_t funct = instruction & 0x3f;
+
+    switch (opcode) {
+        case 0:
+            switch (funct) {
+                case 0x20: case 0x21: case 0x22: case 0x23: case 0x24: case 0x25:
+                case 0x27: case 0x2a: case 0x2b: case 0x00: case 0x02: case 0x08: case 0x09:
+                    return 1;
+                default:
+                    return 0;
+            }
+        case 2: case 3: case 4: case 5: case 8: case 9: case 10: case 11:
+        case 12: case 13: case 15: case 35: case 43:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// start_pc부터 한 블록을 번역한다. 첫 명령어부터 지원하지 않으면 NULL.
+static uint8_t* dbt_translate(DbtContext* ctx, uint32_t start_pc) {
+    if (dbt_ptr + DBT_CODE_MARGIN > dbt_code + DBT_CODE_SIZE ||
+        dbt_num_exits + 2 > DBT_MAX_EXITS) {
+        dbt_flush();
+    }
+
+    uint8_t* entry = dbt_ptr;
+    DbtStub stubs[DBT_MAX_BLOCK * 2 + 2];
+    int num_stubs = 0;
+    int32_t counts[CNT_NUM] = {0};
+    uint32_t pc = start_pc;
+    int length = 0;
+    int ended = 0;
+
+#define ADD_STUB(site_, len_, pc_, code_, with_counts_) do {                \
+        DbtStub* st = &stubs[num_stubs++];                                  \
+        st->site = (site_); st->length = (len_); st->pc = (pc_);            \
+        st->code = (code_);                                                 \
+        if (with_counts_) memcpy(st->counts, counts, sizeof(counts));       \
+        else memset(st->counts, 0, sizeof(st->counts));                     \
+    } while (0)
+
+#define DIRECT_EXIT(site_, len_, target_) do {                              \
+        int e = dbt_num_exits++;                                            \
+        dbt_exits[e].site = (site_); dbt_exits[e].length = (len_);          \
+        ADD_STUB((site_), (len_), (target_), e, 0);                         \
+    } while (0)
+
+    while (!ended) {
+        if (length >= DBT_MAX_BLOCK || (pc & 0x3) || pc > MEMORY_SIZE - 4) {
+            // 블록 길이 제한: 다음 PC로 직접 exit
+            emit_counts(counts);
+            uint8_t* site = emit_jmp(NULL);
+            DIRECT_EXIT(site, 5, pc);
+            break;
+        }
+
+        uint32_t instruction = threaded_read_word(pc);
+        uint32_t opcode = instruction >> 26;
+        uint32_t funct = instruction & 0x3f;
+        uint32_t rs = (instruction >> 21) & 0x1f;
+        uint32_t rt = (instruction >> 16) & 0x1f;
+        uint32_t rd = (instruction >> 11) & 0x1f;
+        uint32_t shamt = (instruction >> 6) & 0x1f;
+        uint32_t imm16 = instruction & 0xffff;
+        uint32_t sign_imm = (imm16 >> 15) ? (imm16 | 0xffff0000) : imm16;
+
+        length++;
+
+        if (instruction == 0) {         // NOP: 카운트하지 않음
+            pc += 4;
+            continue;
+        }
+
+        if (!dbt_is_supported(instruction)) {
+            if (pc == start_pc) {
+                dbt_ptr = entry;
+                return NULL;
+            }
+            emit_counts(counts);
+            emit_exit_inline(pc, DBT_EXIT_INTERP);
+            break;
+        }
+
+        counts[CNT_INST]++;
+
+        if (opcode == 0) {
+            counts[CNT_R]++;
+
+            if (funct == 0x08 || funct == 0x09) {   // jr, jalr
+                emit_load(X_EAX, CTX_REG(rs));
+                if (funct == 0x09 && rd != 0) {
+                    emit_store_imm(CTX_REG(rd), 0);     // write_back이 rd를 0으로 덮어씀
+                }
+                emit_store(X_EAX, CTX_PC);
+                emit_counts(counts);
+                emit8(0xB8); emit32((uint32_t)DBT_EXIT_INDIRECT);
+                emit_jmp(dbt_epilogue);
+                ended = 1;
+                continue;
+            }
+
+            if (rd != 0) {
+                switch (funct) {
+                    case 0x20: case 0x21:
+                        emit_load(X_EAX, CTX_REG(rs)); emit_op_mem(0x03, CTX_REG(rt)); break;
+                    case 0x22: case 0x23:
+                        emit_load(X_EAX, CTX_REG(rs)); emit_op_mem(0x2B, CTX_REG(rt)); break;
+                    case 0x24:
+                        emit_load(X_EAX, CTX_REG(rs)); emit_op_mem(0x23, CTX_REG(rt)); break;
+                    case 0x25:
+                        emit_load(X_EAX, CTX_REG(rs)); emit_op_mem(0x0B, CTX_REG(rt)); break;
+                    case 0x27:
+                        emit_load(X_EAX, CTX_REG(rs)); emit_op_mem(0x0B, CTX_REG(rt));
+                        emit8(0xF7); emit8(0xD0);       // not eax
+                        break;
+                    case 0x2a: case 0x2b:               // slt, sltu (부호 비교)
+                        emit_load(X_EAX, CTX_REG(rs)); emit_op_mem(0x3B, CTX_REG(rt));
+                        emit_setl_eax();
+                        break;
+                    case 0x00:
+                        emit_load(X_EAX, CTX_REG(rt));
+                        emit8(0xC1); emit8(0xE0); emit8((uint8_t)shamt);     // shl eax, shamt
+                        break;
+                    case 0x02:
+                        emit_load(X_EAX, CTX_REG(rt));
+                        emit8(0xC1); emit8(0xE8); emit8((uint8_t)shamt);     // shr eax, shamt
+                        break;
+                }
+                emit_store(X_EAX, CTX_REG(rd));
+            }
+            pc += 4;
+            continue;
+        }
+
+        if (opcode == 2 || opcode == 3) {           // j, jal
+            uint32_t target = (pc & 0xf0000000) | ((instruction & 0x3ffffff) << 2);
+            counts[CNT_J]++;
+            if (opcode == 3) {
+                emit_store_imm(CTX_REG(31), pc + 4);
+            }
+            emit_counts(counts);
+            uint8_t* site = emit_jmp(NULL);
+            DIRECT_EXIT(site, 5, target);
+            ended = 1;
+            continue;
+        }
+
+        counts[CNT_I]++;
+
+        switch (opcode) {
+            case 4: case 5: {                       // beq, bne
+                uint32_t offset = (imm16 << 2) | ((imm16 >> 15) ? 0xfffc0000 : 0);
+                counts[CNT_BRANCH]++;
+                emit_counts(counts);
+                emit_load(X_EAX, CTX_REG(rs));
+                emit_op_mem(0x3B, CTX_REG(rt));
+                uint8_t* taken = emit_jcc(opcode == 4 ? CC_E : CC_NE);
+                DIRECT_EXIT(taken, 6, pc + 4 + offset);
+                uint8_t* fall = emit_jmp(NULL);
+                DIRECT_EXIT(fall, 5, pc + 4);
+                ended = 1;
+                continue;
+            }
+            case 8: case 9:                         // addi, addiu
+                if (rt != 0) {
+                    emit_load(X_EAX, CTX_REG(rs)); emit_op_imm(0x05, sign_imm);
+                    emit_store(X_EAX, CTX_REG(rt));
+                }
+                break;
+            case 10: case 11:                       // slti, sltiu (부호 비교)
+                if (rt != 0) {
+                    emit_load(X_EAX, CTX_REG(rs)); emit_op_imm(0x3D, sign_imm);
+                    emit_setl_eax();
+                    emit_store(X_EAX, CTX_REG(rt));
+                }
+                break;
+            case 12:                                // andi
+                if (rt != 0) {
+                    emit_load(X_EAX, CTX_REG(rs)); emit_op_imm(0x25, imm16);
+                    emit_store(X_EAX, CTX_REG(rt));
+                }
+                break;
+            case 13:                                // ori
+                if (rt != 0) {
+                    emit_load(X_EAX, CTX_REG(rs)); emit_op_imm(0x0D, imm16);
+                    emit_store(X_EAX, CTX_REG(rt));
+                }
+                break;
+            case 15:                                // lui
+                if (rt != 0) {
+                    emit_store_imm(CTX_REG(rt), imm16 << 16);
+                }
+                break;
+            case 35:                                // lw
+            case 43: {                              // sw
+                counts[CNT_INST]--; counts[CNT_I]--;    // 범위 밖이면 이 명령어는 인터프리터가 센다
+                emit_load(X_EAX, CTX_REG(rs));
+                emit_op_imm(0x05, sign_imm);
+                emit_op_imm(0x3D, MEMORY_SIZE - 4);
+                uint8_t* oob = emit_jcc(CC_A);
+                ADD_STUB(oob, 6, pc, DBT_EXIT_INTERP, 1);
+                counts[CNT_INST]++; counts[CNT_I]++; counts[CNT_MEM]++;
+
+                if (opcode == 35) {
+                    emit8(0x41); emit8(0x8B); emit8(0x04); emit8(0x04);     // mov eax, [r12+rax]
+                    if (rt != 0) {
+                        emit_store(X_EAX, CTX_REG(rt));
+                    }
+                } else {
+                    emit_load(X_ECX, CTX_REG(rt));
+                    emit8(0x41); emit8(0x89); emit8(0x0C); emit8(0x04);     // mov [r12+rax], ecx
+                    emit_op_mem(0x3B, CTX_CODE_LIMIT);
+                    uint8_t* smc = emit_jcc(CC_B);
+                    ADD_STUB(smc, 6, pc + 4, DBT_EXIT_SMC, 1);
+                }
+                break;
+            }
+        }
+        pc += 4;
+    }
+
+    // 블록 밖으로 나가는 stub들
+    for (int i = 0; i < num_stubs; i++) {
+        patch_rel32(stubs[i].site, stubs[i].length, dbt_ptr);
+        emit_counts(stubs[i].counts);
+        emit_exit_inline(stubs[i].pc, stubs[i].code);
+    }
+
+#undef ADD_STUB
+#undef DIRECT_EXIT
+
+    if (pc + 4 > ctx->code_limit) {
+        ctx->code_limit = pc + 4;
+    }
+    dbt_insert(start_pc, entry);
+    return entry;
+}
+
+static void dbt_interpret_one(DbtContext* ctx) {
+    ThreadedOp op;
+    uint32_t pc = TPC(&ctx->regs);
+    translate_instruction(pc, threaded_read_word(pc), &op);
+    op.handler(&op, &ctx->regs);
+}
+
+void run_dbt(Registers* registers) {
+    static DbtContext ctx;
+    DbtEntryFn enter;
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.regs = *registers;
+
+    if (dbt_code == NULL) {
+        dbt_init();
+    }
+    enter = (DbtEntryFn)(void*)dbt_entry;
+
+    while (TPC(&ctx.regs) != 0xffffffff) {
+        uint32_t pc = TPC(&ctx.regs);
+        uint8_t* code = dbt_lookup(pc);
+
+        if (code == NULL) {
+            code = dbt_translate(&ctx, pc);
+        }
+        if (code == NULL) {
+            dbt_interpret_one(&ctx);
+            dbt_last_exit = -1;
+            continue;
+        }
+
+        // 직전 블록의 직접 exit를 이 블록으로 연결
+        if (dbt_last_exit >= 0) {
+            DbtExit* e = &dbt_exits[dbt_last_exit];
+            patch_rel32(e->site, e->length, code);
+        }
+
+        int result = enter(&ctx, memory, code);
+        dbt_last_exit = (result >= 0) ? result : -1;
+
+        if (result == DBT_EXIT_INTERP) {
+            dbt_interpret_one(&ctx);
+        } else if (result == DBT_EXIT_SMC) {
+            dbt_flush();
+            ctx.code_limit = 0;
+        }
+    }
+
+    instruction_count += ctx.counts[CNT_INST];
+    rtype_count += ctx.counts[CNT_R];
+    itype_count += ctx.counts[CNT_I];
+    jtype_count += ctx.counts[CNT_J];
+    memory_count += ctx.counts[CNT_MEM];
+    branch_count += ctx.counts[CNT_BRANCH];
+    *registers = ctx.regs;
+}
+
+#else
+
+// x86-64 리눅스가 아니면 threaded 엔진으로 대신 실행
+void run_dbt(Registers* registers) {
+    fprintf(stderr, "DBT backend requires x86-64 Linux; using the threaded engine.\n");
+    run_threaded(registers);
+}
+
+#endif
+
+void print_final_result(Registers* registers) {
+    printf("===== Final Result =====\n");
+    printf("Cycles: %d, R-type instructions: %d, I-type instructions: %d, J-type instructions: %d\n", instruction_count, rtype_count, itype_count, jtype_count);
+    printf("Memory operations: %d, Branch instructions: %d\n", memory_count, branch_count);
+    printf("Return value(v0) : %d (0x%x)\n", registers->regs[2], registers->regs[2]);
+}
+
 void run_processor(Registers* registers, uint8_t* memory) {
     while (registers->program_counter != 0xffffffff) {
         printf("================================\n");
@@ -636,10 +1413,7 @@ void run_processor(Registers* registers, uint8_t* memory) {
         execute_cycle(registers, memory);
     }
 
-    printf("===== Final Result =====\n");
-    printf("Cycles: %d, R-type instructions: %d, I-type instructions: %d, J-type instructions: %d\n", instruction_count, rtype_count, itype_count, jtype_count);
-    printf("Memory operations: %d, Branch instructions: %d\n", memory_count, branch_count);
-    printf("Return value(v0) : %d (0x%x)\n", registers->regs[2], registers->regs[2]);
+    print_final_result(registers);
 }
 
 void init_registers(Registers* registers) {
@@ -651,35 +1425,207 @@ void init_registers(Registers* registers) {
     registers->regs[29] = 0x1000000;   // $sp 
 }
 
-int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        printf("Usage: %s <filename.bin>\n", argv[0]);
-        return 1;
+// 프로그램 로더: raw .bin (빅엔디안 워드 나열, 주소 0) 또는 ELF32 BE/LE 실행 파일.
+// 이 시뮬레이터의 메모리는 전부 리틀엔디안이므로 BE 파일은 워드 단위로 뒤집어 복사한다.
+// 성공하면 0, *entry와 *code_end(텍스트 끝 주소)를 채운다.
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    int big_endian;
+} ProgramImage;
+
+static uint32_t image_read(const ProgramImage* img, size_t off, int bytes) {
+    uint32_t v = 0;
+    for (int i = 0; i < bytes; i++) {
+        int k = img->big_endian ? i : bytes - 1 - i;
+        v = (v << 8) | img->data[off + k];
+    }
+    return v;
+}
+
+static int copy_segment(uint32_t addr, const uint8_t* src, size_t size, int swap) {
+    if (addr >= MEMORY_SIZE || size > MEMORY_SIZE - addr) {
+        fprintf(stderr, "Program too big for memory.\n");
+        return -1;
+    }
+    if (!swap) {
+        memcpy(&memory[addr], src, size);
+        return 0;
     }
-    FILE* file = fopen(argv[1], "rb");
+    size_t i;
+    for (i = 0; i + 4 <= size; i += 4) {
+        memory[addr + i] = src[i + 3];
+        memory[addr + i + 1] = src[i + 2];
+        memory[addr + i + 2] = src[i + 1];
+        memory[addr + i + 3] = src[i];
+    }
+    // 마지막 워드의 남은 1~3바이트는 빅엔디안 자리에 넣고 나머지 자리는 0
+    if (i < size) {
+        if (MEMORY_SIZE - addr - i < 4) {
+            fprintf(stderr, "Program too big for memory.\n");
+            return -1;
+        }
+        memset(&memory[addr + i], 0, 4);
+        for (size_t k = 0; i + k < size; k++) {
+            memory[addr + i + 3 - k] = src[i + k];
+        }
+    }
+    return 0;
+}
+
+static int load_elf_image(const ProgramImage* img, uint32_t* entry, uint32_t* code_end) {
+    if (img->size < 52 || img->data[4] != 1 || image_read(img, 18, 2) != 8) {
+        fprintf(stderr, "ELF: only ELF32 MIPS files are supported\n");
+        return -1;
+    }
+    if (image_read(img, 16, 2) != 2) {
+        fprintf(stderr, "ELF: only executables are supported (link the object first)\n");
+        return -1;
+    }
+
+    uint32_t phoff = image_read(img, 28, 4);
+    uint32_t phentsize = image_read(img, 42, 2);
+    uint32_t phnum = image_read(img, 44, 2);
+    // ELF32 프로그램 헤더는 32바이트 (더 크면 뒤는 무시)
+    if (phentsize < 32 || phoff + (size_t)phnum * phentsize > img->size) {
+        fprintf(stderr, "ELF: bad program headers\n");
+        return -1;
+    }
+
+    *code_end = 0;
+    for (uint32_t i = 0; i < phnum; i++) {
+        size_t ph = phoff + (size_t)i * phentsize;
+        if (ph + 32 > img->size) {
+            fprintf(stderr, "ELF: bad program headers\n");
+            return -1;
+        }
+        if (image_read(img, ph, 4) != 1) {      // PT_LOAD
+            continue;
+        }
+        uint32_t offset = image_read(img, ph + 4, 4);
+        uint32_t vaddr = image_read(img, ph + 8, 4);
+        uint32_t filesz = image_read(img, ph + 16, 4);
+        uint32_t memsz = image_read(img, ph + 20, 4);
+        uint32_t flags = image_read(img, ph + 24, 4);
 
+        if (offset > img->size || filesz > img->size - offset ||
+            vaddr >= MEMORY_SIZE || memsz > MEMORY_SIZE - vaddr) {
+            fprintf(stderr, "ELF: segment does not fit\n");
+            return -1;
+        }
+        if (copy_segment(vaddr, img->data + offset, filesz, img->big_endian) != 0) {
+            return -1;
+        }
+        // .bss (BE 파일은 꼬리 워드를 copy_segment가 채웠으므로 다음 워드부터)
+        uint32_t copied = img->big_endian ? ((filesz + 3) & ~3u) : filesz;
+        if (memsz > copied) {
+            memset(&memory[vaddr + copied], 0, memsz - copied);
+        }
+        if ((flags & 1) && vaddr + filesz > *code_end) {        // PF_X
+            *code_end = vaddr + filesz;
+        }
+    }
+
+    *entry = image_read(img, 24, 4);
+    return 0;
+}
+
+int load_program(const char* filename, uint32_t* entry, uint32_t* code_end) {
+    ProgramImage img = {NULL, 0, 1};
+    int status;
+
+#ifndef _WIN32
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        perror("File opening failed");
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    img.size = (size_t)st.st_size;
+    void* map = (img.size > 0) ? mmap(NULL, img.size, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("mmap");
+        return -1;
+    }
+    img.data = map;
+#else
+    FILE* file = fopen(filename, "rb");
     if (!file) {
         perror("File opening failed");
-        return 1;
+        return -1;
     }
+    fseek(file, 0, SEEK_END);
+    img.size = (size_t)ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t* buffer = malloc(img.size ? img.size : 1);
+    img.size = fread(buffer, 1, img.size, file);
+    fclose(file);
+    img.data = buffer;
+#endif
 
-    uint32_t buffer;            
-    size_t bytes_read;      
-    size_t memory_index = 0;   
+    if (img.size >= 4 && memcmp(img.data, "\177ELF", 4) == 0) {
+        img.big_endian = (img.data[5] == 2);
+        status = load_elf_image(&img, entry, code_end);
+    } else {
+        // raw: 빅엔디안 워드 나열을 주소 0부터 (워드가 안 되는 꼬리는 버림)
+        size_t size = img.size & ~(size_t)3;
+        status = copy_segment(0, img.data, size, 1);
+        *entry = 0;
+        *code_end = (uint32_t)size;
+    }
 
-    while ((bytes_read = fread(&buffer, sizeof(uint32_t), 1, file)) > 0 && 
-           memory_index < (MEMORY_SIZE - 3)) {
-        // 빅엔디안 형식으로 메모리에 저장 (가장 중요한 바이트 먼저)
-        memory[memory_index++] = (buffer >> 24) & 0xFF;
-        memory[memory_index++] = (buffer >> 16) & 0xFF;  
-        memory[memory_index++] = (buffer >> 8) & 0xFF;   
-        memory[memory_index++] = buffer & 0xFF;         
+#ifndef _WIN32
+    if (img.data != NULL) {
+        munmap((void*)img.data, img.size);
+    }
+#else
+    free((void*)img.data);
+#endif
+    return status;
+}
+
+int main(int argc, char* argv[]) {
+    // --threaded: 디코드 없이 threaded-code 배열로 실행 (사이클별 출력 없음)
+    // --dbt: 기본 블록을 x86-64 코드로 번역해서 실행
+    int use_threaded = 0;
+    int use_dbt = 0;
+    const char* filename = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threaded") == 0) {
+            use_threaded = 1;
+        } else if (strcmp(argv[i], "--dbt") == 0) {
+            use_dbt = 1;
+        } else {
+            filename = argv[i];
+        }
+    }
+
+    if (filename == NULL) {
+        printf("Usage: %s [--threaded | --dbt] <filename.bin | filename.elf>\n", argv[0]);
+        return 1;
+    }
+    uint32_t entry, code_end;
+    if (load_program(filename, &entry, &code_end) != 0) {
+        return 1;
     }
-    fclose(file);
 
     Registers registers;
     init_registers(&registers);
-    run_processor(&registers, memory);
+    registers.program_counter = entry;
+
+    if (use_dbt) {
+        run_dbt(&registers);
+        print_final_result(&registers);
+    } else if (use_threaded) {
+        translate_program(code_end);
+        run_threaded(&registers);
+        print_final_result(&registers);
+    } else {
+        run_processor(&registers, memory);
+    }
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,284 @@
+#include "bintrace.h"
+#include <string.h>
+
+// 바이너리 트레이스 형식: 레코드 인코딩, 청크 압축, 헤더 (형식 설명은 bintrace.h)
+
+static void put_le32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static uint8_t* put_varint(uint8_t* p, uint32_t v) {
+    while (v >= 0x80) {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+// 읽은 바이트 수, 잘렸거나 너무 길면 0
+static size_t get_varint(const uint8_t* p, size_t len, uint32_t* v) {
+    uint32_t result = 0;
+    for (size_t i = 0; i < len && i < 5; i++) {
+        result |= (uint32_t)(p[i] & 0x7f) << (7 * i);
+        if ((p[i] & 0x80) == 0) {
+            *v = result;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+void bintrace_codec_reset(TraceCodec* codec) {
+    codec->prev_pc = 0xFFFFFFFC;            // 첫 레코드는 PC 0일 때만 순차
+    codec->prev_addr = 0;
+    memset(codec->cache_pc, 0xff, sizeof(codec->cache_pc));    // 정렬되지 않은 PC는 없음
+    memset(codec->cache_word, 0, sizeof(codec->cache_word));
+}
+
+size_t bintrace_encode(TraceCodec* codec, const TraceRecord* rec, uint8_t* out) {
+    uint8_t flags = rec->flags & BT_RECORD_FLAGS;
+    uint32_t slot = (rec->pc >> 2) & (BINTRACE_WORD_CACHE - 1);
+    uint8_t* p = out + 1;
+
+    if (rec->pc == codec->prev_pc + 4) {
+        flags |= BT_PC_SEQ;
+    } else {
+        p = put_varint(p, zigzag((int32_t)(rec->pc - codec->prev_pc - 4) >> 2));
+    }
+    codec->prev_pc = rec->pc;
+
+    if (codec->cache_pc[slot] == rec->pc && codec->cache_word[slot] == rec->word) {
+        flags |= BT_WORD_CACHED;
+    } else {
+        put_le32(p, rec->word);
+        p += 4;
+        codec->cache_pc[slot] = rec->pc;
+        codec->cache_word[slot] = rec->word;
+    }
+
+    if (flags & (BT_LOAD | BT_STORE)) {
+        p = put_varint(p, zigzag((int32_t)(rec->addr - codec->prev_addr)));
+        codec->prev_addr = rec->addr;
+    }
+
+    out[0] = flags;
+    return (size_t)(p - out);
+}
+
+size_t bintrace_decode(TraceCodec* codec, const uint8_t* in, size_t len, TraceRecord* rec) {
+    if (len == 0) {
+        return 0;
+    }
+    uint8_t flags = in[0];
+    size_t pos = 1;
+
+    if (flags & BT_PC_SEQ) {
+        rec->pc = codec->prev_pc + 4;
+    } else {
+        uint32_t v;
+        size_t n = get_varint(in + pos, len - pos, &v);
+        if (n == 0) return 0;
+        pos += n;
+        rec->pc = codec->prev_pc + 4 + ((uint32_t)unzigzag(v) << 2);
+    }
+    codec->prev_pc = rec->pc;
+
+    uint32_t slot = (rec->pc >> 2) & (BINTRACE_WORD_CACHE - 1);
+    if (flags & BT_WORD_CACHED) {
+        if (codec->cache_pc[slot] != rec->pc) return 0;
+        rec->word = codec->cache_word[slot];
+    } else {
+        if (len - pos < 4) return 0;
+        rec->word = get_le32(in + pos);
+        pos += 4;
+        codec->cache_pc[slot] = rec->pc;
+        codec->cache_word[slot] = rec->word;
+    }
+
+    rec->addr = 0;
+    if (flags & (BT_LOAD | BT_STORE)) {
+        uint32_t v;
+        size_t n = get_varint(in + pos, len - pos, &v);
+        if (n == 0) return 0;
+        pos += n;
+        rec->addr = codec->prev_addr + (uint32_t)unzigzag(v);
+        codec->prev_addr = rec->addr;
+    }
+
+    rec->flags = flags & BT_RECORD_FLAGS;
+    return pos;
+}
+
+// LZ77: 시퀀스 = 토큰(리터럴 길이 4비트 | 일치 길이-4 4비트), 추가 길이(255 단위),
+// 리터럴, 오프셋(16비트 LE), 추가 일치 길이. 마지막 시퀀스는 리터럴만 있다.
+#define LZ_HASH_BITS    12
+#define LZ_MIN_MATCH    4
+#define LZ_MAX_OFFSET   0xFFFF
+
+static uint32_t lz_hash(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+static uint8_t* lz_put_length(uint8_t* op, size_t len) {
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+static uint8_t* lz_put_literals(uint8_t* op, const uint8_t* lit, size_t lit_len, size_t match_code) {
+    *op++ = (uint8_t)(((lit_len >= 15) ? 15 : lit_len) << 4 | ((match_code >= 15) ? 15 : match_code));
+    if (lit_len >= 15) {
+        op = lz_put_length(op, lit_len - 15);
+    }
+    memcpy(op, lit, lit_len);
+    return op + lit_len;
+}
+
+size_t bintrace_lz_bound(size_t len) {
+    return len + len / 255 + 16;
+}
+
+size_t bintrace_lz_compress(const uint8_t* in, size_t len, uint8_t* out) {
+    int32_t table[1 << LZ_HASH_BITS];
+    const uint8_t* ip = in;
+    const uint8_t* anchor = in;
+    const uint8_t* end = in + len;
+    uint8_t* op = out;
+
+    for (int i = 0; i < (1 << LZ_HASH_BITS); i++) {
+        table[i] = -1;
+    }
+
+    while (ip + LZ_MIN_MATCH <= end) {
+        uint32_t h = lz_hash(ip);
+        int32_t candidate = table[h];
+        table[h] = (int32_t)(ip - in);
+
+        if (candidate < 0 || (ip - in) - candidate > LZ_MAX_OFFSET ||
+            memcmp(in + candidate, ip, LZ_MIN_MATCH) != 0) {
+            ip++;
+            continue;
+        }
+
+        const uint8_t* ref = in + candidate;
+        size_t match_len = LZ_MIN_MATCH;
+        while (ip + match_len < end && ref[match_len] == ip[match_len]) {
+            match_len++;
+        }
+
+        size_t offset = (size_t)(ip - ref);
+        op = lz_put_literals(op, anchor, (size_t)(ip - anchor), match_len - LZ_MIN_MATCH);
+        *op++ = (uint8_t)offset;
+        *op++ = (uint8_t)(offset >> 8);
+        if (match_len - LZ_MIN_MATCH >= 15) {
+            op = lz_put_length(op, match_len - LZ_MIN_MATCH - 15);
+        }
+        ip += match_len;
+        anchor = ip;
+    }
+
+    op = lz_put_literals(op, anchor, (size_t)(end - anchor), 0);
+    return (size_t)(op - out);
+}
+
+static int lz_get_length(const uint8_t** ip, const uint8_t* end, size_t* len) {
+    uint8_t b;
+    do {
+        if (*ip >= end) return -1;
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255);
+    return 0;
+}
+
+int bintrace_lz_decompress(const uint8_t* in, size_t len, uint8_t* out, size_t out_len) {
+    const uint8_t* ip = in;
+    const uint8_t* end = in + len;
+    uint8_t* op = out;
+    uint8_t* out_end = out + out_len;
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+        size_t lit_len = token >> 4;
+        if (lit_len == 15 && lz_get_length(&ip, end, &lit_len) != 0) return -1;
+        if (lit_len > (size_t)(end - ip) || lit_len > (size_t)(out_end - op)) return -1;
+        memcpy(op, ip, lit_len);
+        ip += lit_len;
+        op += lit_len;
+
+        if (op == out_end) {
+            return (ip == end) ? 0 : -1;
+        }
+
+        if (end - ip < 2) return -1;
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        size_t match_len = token & 0x0f;
+        if (match_len == 15 && lz_get_length(&ip, end, &match_len) != 0) return -1;
+        match_len += LZ_MIN_MATCH;
+        if (offset == 0 || offset > (size_t)(op - out) || match_len > (size_t)(out_end - op)) return -1;
+
+        // 겹치는 복사가 가능하므로 바이트 단위
+        const uint8_t* ref = op - offset;
+        for (size_t i = 0; i < match_len; i++) {
+            op[i] = ref[i];
+        }
+        op += match_len;
+    }
+    return (op == out_end) ? 0 : -1;
+}
+
+void bintrace_write_file_header(uint8_t* out) {
+    memset(out, 0, BINTRACE_FILE_HEADER_SIZE);
+    memcpy(out, BINTRACE_MAGIC, sizeof(BINTRACE_MAGIC));
+    put_le32(out + 8, BINTRACE_VERSION);
+    put_le32(out + 12, BINTRACE_CHUNK_SIZE);
+}
+
+int bintrace_check_file_header(const uint8_t* in, size_t len) {
+    if (len < BINTRACE_FILE_HEADER_SIZE || memcmp(in, BINTRACE_MAGIC, sizeof(BINTRACE_MAGIC)) != 0) {
+        return -1;
+    }
+    if (get_le32(in + 8) != BINTRACE_VERSION || get_le32(in + 12) > BINTRACE_CHUNK_SIZE) {
+        return -1;
+    }
+    return 0;
+}
+
+void bintrace_write_chunk_header(const TraceChunkHeader* hdr, uint8_t* out) {
+    put_le32(out, (uint32_t)hdr->first_seq);
+    put_le32(out + 4, (uint32_t)(hdr->first_seq >> 32));
+    put_le32(out + 8, hdr->records);
+    put_le32(out + 12, hdr->raw_bytes);
+    put_le32(out + 16, hdr->stored_bytes);
+    put_le32(out + 20, hdr->method);
+}
+
+void bintrace_read_chunk_header(const uint8_t* in, TraceChunkHeader* hdr) {
+    hdr->first_seq = (uint64_t)get_le32(in) | ((uint64_t)get_le32(in + 4) << 32);
+    hdr->records = get_le32(in + 8);
+    hdr->raw_bytes = get_le32(in + 12);
+    hdr->stored_bytes = get_le32(in + 16);
+    hdr->method = get_le32(in + 20);
+}
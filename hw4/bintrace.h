@@ -0,0 +1,80 @@
+#ifndef BINTRACE_H
+#define BINTRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// 바이너리 실행 트레이스 형식 (mips_pipeline --trace-out, mips_replay가 공유)
+//
+// 파일 = 파일 헤더 + 청크들 + 끝 표시 청크(records == 0)
+// 청크마다 인코딩 상태를 새로 시작하므로 청크 단위로 독립적으로 풀 수 있다.
+//
+// 레코드 (프로그램 순서, 명령어 하나당 하나):
+//   flags 1바이트
+//   PC가 직전 PC+4가 아니면   zigzag varint((pc - (prev_pc + 4)) / 4)
+//   명령어가 PC 캐시에 없으면  명령어 워드 4바이트 (LE)
+//   load/store면             zigzag varint(addr - prev_addr)
+
+#define BINTRACE_MAGIC          "MIPSTRC"       // 8바이트 (NUL 포함)
+#define BINTRACE_VERSION        1
+#define BINTRACE_CHUNK_SIZE     65536           // 인코딩된 레코드 기준, LZ 오프셋이 16비트에 들어감
+#define BINTRACE_MAX_RECORD     16
+#define BINTRACE_WORD_CACHE     1024            // PC -> 명령어 워드 캐시 (direct-mapped)
+
+// 레코드 플래그 (bit 0, 1은 인코딩 내부용)
+#define BT_PC_SEQ       0x01
+#define BT_WORD_CACHED  0x02
+#define BT_LOAD         0x04
+#define BT_STORE        0x08
+#define BT_BRANCH       0x10    // beq/bne
+#define BT_TAKEN        0x20    // 분기 taken (점프는 항상 설정)
+#define BT_JUMP         0x40    // j, jal, jr
+#define BT_RECORD_FLAGS (BT_LOAD | BT_STORE | BT_BRANCH | BT_TAKEN | BT_JUMP)
+
+// 청크 저장 방식
+#define BT_CHUNK_RAW    0
+#define BT_CHUNK_LZ     1
+
+typedef struct {
+    uint64_t seq;               // 0부터 시작하는 동적 명령어 번호
+    uint32_t pc;
+    uint32_t word;
+    uint32_t addr;              // BT_LOAD/BT_STORE일 때만 의미 있음
+    uint8_t flags;              // BT_RECORD_FLAGS
+} TraceRecord;
+
+typedef struct {
+    uint64_t first_seq;
+    uint32_t records;
+    uint32_t raw_bytes;         // 인코딩된 레코드 바이트 수
+    uint32_t stored_bytes;      // 파일에 저장된 바이트 수
+    uint32_t method;            // BT_CHUNK_RAW / BT_CHUNK_LZ
+} TraceChunkHeader;
+
+#define BINTRACE_FILE_HEADER_SIZE   16
+#define BINTRACE_CHUNK_HEADER_SIZE  24
+
+// 청크 하나의 인코딩/디코딩 상태
+typedef struct {
+    uint32_t prev_pc;
+    uint32_t prev_addr;
+    uint32_t cache_pc[BINTRACE_WORD_CACHE];
+    uint32_t cache_word[BINTRACE_WORD_CACHE];
+} TraceCodec;
+
+extern void bintrace_codec_reset(TraceCodec* codec);
+extern size_t bintrace_encode(TraceCodec* codec, const TraceRecord* rec, uint8_t* out);
+extern size_t bintrace_decode(TraceCodec* codec, const uint8_t* in, size_t len, TraceRecord* rec);
+
+// 청크 압축 (LZ77 계열, 최대 BINTRACE_CHUNK_SIZE 입력)
+extern size_t bintrace_lz_bound(size_t len);
+extern size_t bintrace_lz_compress(const uint8_t* in, size_t len, uint8_t* out);
+extern int bintrace_lz_decompress(const uint8_t* in, size_t len, uint8_t* out, size_t out_len);
+
+extern void bintrace_write_file_header(uint8_t* out);
+extern int bintrace_check_file_header(const uint8_t* in, size_t len);
+extern void bintrace_write_chunk_header(const TraceChunkHeader* hdr, uint8_t* out);
+extern void bintrace_read_chunk_header(const uint8_t* in, TraceChunkHeader* hdr);
+
+#endif
@@ -0,0 +1,251 @@
+#include "structure.h"
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+// 바이너리 실행 트레이스 기록 (--trace-out)
+// 시뮬레이터 스레드는 고정 크기 레코드를 슬롯에 복사만 하고, 가득 찬 슬롯을
+// 단일 생산자/단일 소비자 링으로 넘긴다. 인코딩과 압축, 파일 쓰기는 모두
+// 백그라운드 스레드가 한다. 링에는 락이 없고 head/tail 두 카운터만 원자적으로 주고받는다.
+
+#define TRACE_RING_SLOTS    8
+#define TRACE_SLOT_RECORDS  8192
+
+typedef struct {
+    uint32_t pc;
+    uint32_t word;
+    uint32_t addr;
+    uint32_t flags;
+} SlotRecord;
+
+typedef struct {
+    uint64_t first_seq;
+    uint32_t records;
+    SlotRecord data[TRACE_SLOT_RECORDS];
+} TraceSlot;
+
+struct TraceWriter {
+    FILE* file;
+    TraceSlot* slots;
+    uint64_t head;              // 생산자가 넘긴 슬롯 수 (생산자만 씀)
+    uint64_t tail;              // 기록을 마친 슬롯 수 (writer 스레드만 씀)
+    int closing;
+    bool thread_started;
+    pthread_t thread;
+
+    // 생산자 쪽 상태
+    TraceSlot* current;
+    uint64_t seq;
+    uint64_t producer_waits;    // 링이 가득 차서 기다린 횟수
+
+    // writer 스레드 쪽 상태
+    TraceCodec codec;
+    uint8_t* chunk;             // 인코딩된 청크
+    uint8_t* lz_buf;
+    uint64_t raw_bytes;
+    uint64_t file_bytes;
+    int io_error;
+};
+
+static void write_chunk(struct TraceWriter* tw, uint64_t first_seq, uint32_t records, uint32_t len) {
+    TraceChunkHeader hdr = {first_seq, records, len, len, BT_CHUNK_RAW};
+    uint8_t header[BINTRACE_CHUNK_HEADER_SIZE];
+    const uint8_t* payload = tw->chunk;
+
+    size_t packed = bintrace_lz_compress(tw->chunk, len, tw->lz_buf);
+    if (packed < len) {
+        hdr.stored_bytes = (uint32_t)packed;
+        hdr.method = BT_CHUNK_LZ;
+        payload = tw->lz_buf;
+    }
+
+    bintrace_write_chunk_header(&hdr, header);
+    if (fwrite(header, sizeof(header), 1, tw->file) != 1 ||
+        fwrite(payload, hdr.stored_bytes, 1, tw->file) != 1) {
+        tw->io_error = 1;
+    }
+    tw->raw_bytes += len;
+    tw->file_bytes += sizeof(header) + hdr.stored_bytes;
+}
+
+// 슬롯 하나를 청크 크기 단위로 인코딩해서 쓴다 (청크마다 인코딩 상태를 새로 시작)
+static void write_slot(struct TraceWriter* tw, const TraceSlot* slot) {
+    uint32_t i = 0;
+    while (i < slot->records) {
+        uint64_t first_seq = slot->first_seq + i;
+        uint32_t start = i;
+        uint32_t len = 0;
+
+        bintrace_codec_reset(&tw->codec);
+        while (i < slot->records && len + BINTRACE_MAX_RECORD <= BINTRACE_CHUNK_SIZE) {
+            const SlotRecord* r = &slot->data[i];
+            TraceRecord rec = {first_seq + (i - start), r->pc, r->word, r->addr, (uint8_t)r->flags};
+            len += (uint32_t)bintrace_encode(&tw->codec, &rec, tw->chunk + len);
+            i++;
+        }
+        write_chunk(tw, first_seq, i - start, len);
+    }
+}
+
+static void* writer_main(void* arg) {
+    struct TraceWriter* tw = arg;
+    const struct timespec idle = {0, 100000};      // 100us
+
+    for (;;) {
+        uint64_t head = __atomic_load_n(&tw->head, __ATOMIC_ACQUIRE);
+        if (tw->tail == head) {
+            if (__atomic_load_n(&tw->closing, __ATOMIC_ACQUIRE)) {
+                // closing을 본 뒤 head를 다시 확인해야 마지막 슬롯을 놓치지 않는다
+                if (__atomic_load_n(&tw->head, __ATOMIC_ACQUIRE) == tw->tail) {
+                    break;
+                }
+                continue;
+            }
+            nanosleep(&idle, NULL);
+            continue;
+        }
+
+        write_slot(tw, &tw->slots[tw->tail % TRACE_RING_SLOTS]);
+        __atomic_store_n(&tw->tail, tw->tail + 1, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+// 다음 빈 슬롯을 잡는다. 링이 가득 차면 writer가 하나 비울 때까지 양보.
+static void acquire_slot(struct TraceWriter* tw) {
+    if (tw->head - __atomic_load_n(&tw->tail, __ATOMIC_ACQUIRE) >= TRACE_RING_SLOTS) {
+        tw->producer_waits++;
+        while (tw->head - __atomic_load_n(&tw->tail, __ATOMIC_ACQUIRE) >= TRACE_RING_SLOTS) {
+            sched_yield();
+        }
+    }
+    tw->current = &tw->slots[tw->head % TRACE_RING_SLOTS];
+    tw->current->first_seq = tw->seq;
+    tw->current->records = 0;
+}
+
+static void publish_slot(struct TraceWriter* tw) {
+    __atomic_store_n(&tw->head, tw->head + 1, __ATOMIC_RELEASE);
+    tw->current = NULL;
+}
+
+int bintrace_open(const char* path) {
+    struct TraceWriter* tw = calloc(1, sizeof(struct TraceWriter));
+    if (tw == NULL) {
+        fprintf(stderr, "binary trace: out of memory\n");
+        return -1;
+    }
+    sim->bintrace = tw;
+
+    tw->slots = malloc(sizeof(TraceSlot) * TRACE_RING_SLOTS);
+    tw->chunk = malloc(BINTRACE_CHUNK_SIZE);
+    tw->lz_buf = malloc(bintrace_lz_bound(BINTRACE_CHUNK_SIZE));
+    if (tw->slots == NULL || tw->chunk == NULL || tw->lz_buf == NULL) {
+        fprintf(stderr, "binary trace: out of memory\n");
+        return -1;
+    }
+
+    tw->file = fopen(path, "wb");
+    if (tw->file == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    uint8_t header[BINTRACE_FILE_HEADER_SIZE];
+    bintrace_write_file_header(header);
+    fwrite(header, sizeof(header), 1, tw->file);
+    tw->file_bytes = sizeof(header);
+
+    if (pthread_create(&tw->thread, NULL, writer_main, tw) != 0) {
+        fprintf(stderr, "binary trace: failed to start writer thread\n");
+        return -1;
+    }
+    tw->thread_started = true;
+
+    acquire_slot(tw);
+    return 0;
+}
+
+void bintrace_record(uint32_t pc, uint32_t word, uint8_t flags, uint32_t addr) {
+    struct TraceWriter* tw = sim->bintrace;
+
+    if (tw->current->records == TRACE_SLOT_RECORDS) {
+        publish_slot(tw);
+        acquire_slot(tw);
+    }
+
+    SlotRecord* r = &tw->current->data[tw->current->records++];
+    r->pc = pc;
+    r->word = word;
+    r->addr = addr;
+    r->flags = flags;
+    tw->seq++;
+}
+
+// 남은 청크를 넘기고 writer 스레드를 기다린 뒤 끝 표시를 쓴다.
+// 통계는 print_bintrace_stats를 위해 free_bintrace까지 남겨 둔다.
+int bintrace_close(void) {
+    struct TraceWriter* tw = sim->bintrace;
+    if (tw == NULL || tw->file == NULL) {
+        return 0;
+    }
+
+    if (tw->thread_started) {
+        if (tw->current != NULL && tw->current->records > 0) {
+            publish_slot(tw);
+        }
+        __atomic_store_n(&tw->closing, 1, __ATOMIC_RELEASE);
+        pthread_join(tw->thread, NULL);
+        tw->thread_started = false;
+    }
+
+    TraceChunkHeader end = {tw->seq, 0, 0, 0, BT_CHUNK_RAW};
+    uint8_t header[BINTRACE_CHUNK_HEADER_SIZE];
+    bintrace_write_chunk_header(&end, header);
+    if (fwrite(header, sizeof(header), 1, tw->file) != 1) {
+        tw->io_error = 1;
+    }
+    tw->file_bytes += sizeof(header);
+
+    if (fclose(tw->file) != 0) {
+        tw->io_error = 1;
+    }
+    tw->file = NULL;
+
+    if (tw->io_error) {
+        fprintf(stderr, "binary trace: write error\n");
+        return -1;
+    }
+    return 0;
+}
+
+void print_bintrace_stats(void) {
+    const struct TraceWriter* tw = sim->bintrace;
+    if (tw == NULL || tw->seq == 0) {
+        return;
+    }
+    printf("binary trace                         : %llu records, %llu bytes (%.2f bytes/inst, encoded %llu, ring waits %llu)\n",
+           (unsigned long long)tw->seq, (unsigned long long)tw->file_bytes,
+           (double)tw->file_bytes / tw->seq, (unsigned long long)tw->raw_bytes,
+           (unsigned long long)tw->producer_waits);
+}
+
+void free_bintrace(void) {
+    struct TraceWriter* tw = sim->bintrace;
+    if (tw == NULL) {
+        return;
+    }
+    if (tw->thread_started) {
+        __atomic_store_n(&tw->closing, 1, __ATOMIC_RELEASE);
+        pthread_join(tw->thread, NULL);
+    }
+    if (tw->file != NULL) {
+        fclose(tw->file);
+    }
+    free(tw->slots);
+    free(tw->chunk);
+    free(tw->lz_buf);
+    free(tw);
+    sim->bintrace = NULL;
+}
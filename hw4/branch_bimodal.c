@@ -0,0 +1,78 @@
+#include "structure.h"
+#include <stdlib.h>
+
+// Bimodal: PC로 인덱싱하는 2-bit saturating counter 테이블
+// 기본 예산(64바이트)에서 원래의 256-엔트리 예측기와 같다.
+
+// 2-bit saturating counter states
+typedef enum {
+    STRONGLY_NOT_TAKEN = 0,   // 00
+    WEAKLY_NOT_TAKEN = 1,     // 01
+    WEAKLY_TAKEN = 2,         // 10
+    STRONGLY_TAKEN = 3        // 11
+} BranchState;
+
+typedef struct {
+    uint32_t entries;
+    uint32_t mask;
+    uint8_t* table;
+} Bimodal;
+
+static void* bimodal_create(uint32_t budget_bytes) {
+    Bimodal* bp = malloc(sizeof(Bimodal));
+    bp->entries = bp_floor_pow2((uint64_t)budget_bytes * 8 / 2);
+    bp->mask = bp->entries - 1;
+    bp->table = malloc(bp->entries);
+
+    // 모든 엔트리를 WEAKLY_NOT_TAKEN으로 초기화
+    memset(bp->table, WEAKLY_NOT_TAKEN, bp->entries);
+    return bp;
+}
+
+static uint32_t get_predictor_index(const Bimodal* bp, uint32_t pc) {
+    // PC의 하위 비트들을 사용 (word aligned이므로 2비트 shift)
+    return (pc >> 2) & bp->mask;
+}
+
+static bool bimodal_predict(void* state, uint32_t pc) {
+    Bimodal* bp = state;
+    // WEAKLY_TAKEN 이상이면 taken으로 예측
+    return bp->table[get_predictor_index(bp, pc)] >= WEAKLY_TAKEN;
+}
+
+static void bimodal_update(void* state, uint32_t pc, bool taken) {
+    Bimodal* bp = state;
+    bp_counter_update(&bp->table[get_predictor_index(bp, pc)], taken);
+}
+
+static void bimodal_destroy(void* state) {
+    Bimodal* bp = state;
+    free(bp->table);
+    free(bp);
+}
+
+static uint64_t bimodal_storage_bits(const void* state) {
+    const Bimodal* bp = state;
+    return (uint64_t)bp->entries * 2;
+}
+
+static void bimodal_describe(const void* state, char* buf, size_t len) {
+    const Bimodal* bp = state;
+    snprintf(buf, len, "%u x 2-bit counters", bp->entries);
+}
+
+static void bimodal_checkpoint(void* state, Checkpoint* ck) {
+    Bimodal* bp = state;
+    ckpt_region(ck, bp->table, bp->entries);
+}
+
+const BranchPredictorOps bimodal_predictor = {
+    "bimodal",
+    bimodal_create,
+    bimodal_predict,
+    bimodal_update,
+    bimodal_destroy,
+    bimodal_storage_bits,
+    bimodal_describe,
+    bimodal_checkpoint,
+};
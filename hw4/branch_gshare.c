@@ -0,0 +1,77 @@
+#include "structure.h"
+#include <stdlib.h>
+
+// gshare: 전역 분기 히스토리와 PC를 XOR해서 2-bit counter 테이블을 인덱싱
+// 히스토리 길이 = log2(엔트리 수)
+
+typedef struct {
+    uint32_t entries;
+    uint32_t mask;
+    int history_bits;
+    uint32_t history;
+    uint8_t* table;
+} Gshare;
+
+static void* gshare_create(uint32_t budget_bytes) {
+    Gshare* bp = calloc(1, sizeof(Gshare));
+    uint64_t bits = (uint64_t)budget_bytes * 8;
+
+    // 2 * entries + log2(entries) <= bits
+    bp->entries = bp_floor_pow2(bits / 2);
+    while (bp->entries > 1 && (uint64_t)bp->entries * 2 + bp_log2(bp->entries) > bits) {
+        bp->entries /= 2;
+    }
+    bp->mask = bp->entries - 1;
+    bp->history_bits = bp_log2(bp->entries);
+    bp->table = malloc(bp->entries);
+    memset(bp->table, 1, bp->entries);      // weakly not taken
+    return bp;
+}
+
+static uint32_t gshare_index(const Gshare* bp, uint32_t pc) {
+    return ((pc >> 2) ^ bp->history) & bp->mask;
+}
+
+static bool gshare_predict(void* state, uint32_t pc) {
+    Gshare* bp = state;
+    return bp->table[gshare_index(bp, pc)] >= 2;
+}
+
+static void gshare_update(void* state, uint32_t pc, bool taken) {
+    Gshare* bp = state;
+    bp_counter_update(&bp->table[gshare_index(bp, pc)], taken);
+    bp->history = ((bp->history << 1) | (taken ? 1 : 0)) & bp->mask;
+}
+
+static void gshare_destroy(void* state) {
+    Gshare* bp = state;
+    free(bp->table);
+    free(bp);
+}
+
+static uint64_t gshare_storage_bits(const void* state) {
+    const Gshare* bp = state;
+    return (uint64_t)bp->entries * 2 + bp->history_bits;
+}
+
+static void gshare_describe(const void* state, char* buf, size_t len) {
+    const Gshare* bp = state;
+    snprintf(buf, len, "%u x 2-bit counters, %d-bit global history", bp->entries, bp->history_bits);
+}
+
+static void gshare_checkpoint(void* state, Checkpoint* ck) {
+    Gshare* bp = state;
+    ckpt_region(ck, bp->table, bp->entries);
+    ckpt_region(ck, &bp->history, sizeof(bp->history));
+}
+
+const BranchPredictorOps gshare_predictor = {
+    "gshare",
+    gshare_create,
+    gshare_predict,
+    gshare_update,
+    gshare_destroy,
+    gshare_storage_bits,
+    gshare_describe,
+    gshare_checkpoint,
+};
@@ -0,0 +1,108 @@
+#include "structure.h"
+#include <stdlib.h>
+
+// Perceptron 예측기 (Jimenez & Lin)
+// PC로 고른 퍼셉트론의 가중치와 전역 히스토리(+1/-1)의 내적이 0 이상이면 taken.
+// 틀렸거나 |y|가 임계값 이하이면 가중치를 학습한다. 가중치는 8-bit.
+
+#define PERCEPTRON_WEIGHT_MAX   127
+#define PERCEPTRON_WEIGHT_MIN   (-128)
+
+typedef struct {
+    uint32_t count;             // 퍼셉트론 개수
+    int history_bits;
+    int threshold;
+    int8_t* weights;            // [count][history_bits + 1], 0번은 bias
+    uint64_t history;
+} Perceptron;
+
+static void* perceptron_create(uint32_t budget_bytes) {
+    static const int history_options[] = {32, 24, 16, 12, 8, 4};
+    Perceptron* bp = calloc(1, sizeof(Perceptron));
+    uint64_t bits = (uint64_t)budget_bytes * 8;
+
+    // 퍼셉트론 수가 히스토리 길이의 두 배 이상 되는 가장 긴 히스토리
+    bp->history_bits = 4;
+    for (size_t i = 0; i < sizeof(history_options) / sizeof(history_options[0]); i++) {
+        int h = history_options[i];
+        if (bits / ((uint64_t)(h + 1) * 8) >= (uint64_t)(2 * h)) {
+            bp->history_bits = h;
+            break;
+        }
+    }
+    bp->count = bp_floor_pow2(bits / ((uint64_t)(bp->history_bits + 1) * 8));
+    bp->threshold = (int)(1.93 * bp->history_bits + 14);
+    bp->weights = calloc((size_t)bp->count * (bp->history_bits + 1), 1);
+    return bp;
+}
+
+static int perceptron_output(const Perceptron* bp, uint32_t pc) {
+    const int8_t* w = &bp->weights[(size_t)((pc >> 2) & (bp->count - 1)) * (bp->history_bits + 1)];
+    int y = w[0];
+    for (int i = 0; i < bp->history_bits; i++) {
+        y += ((bp->history >> i) & 1) ? w[i + 1] : -w[i + 1];
+    }
+    return y;
+}
+
+static bool perceptron_predict(void* state, uint32_t pc) {
+    return perceptron_output(state, pc) >= 0;
+}
+
+static void train_weight(int8_t* w, int delta) {
+    int v = *w + delta;
+    if (v > PERCEPTRON_WEIGHT_MAX) v = PERCEPTRON_WEIGHT_MAX;
+    if (v < PERCEPTRON_WEIGHT_MIN) v = PERCEPTRON_WEIGHT_MIN;
+    *w = (int8_t)v;
+}
+
+static void perceptron_update(void* state, uint32_t pc, bool taken) {
+    Perceptron* bp = state;
+    int y = perceptron_output(bp, pc);
+    int t = taken ? 1 : -1;
+
+    if ((y >= 0) != taken || abs(y) <= bp->threshold) {
+        int8_t* w = &bp->weights[(size_t)((pc >> 2) & (bp->count - 1)) * (bp->history_bits + 1)];
+        train_weight(&w[0], t);
+        for (int i = 0; i < bp->history_bits; i++) {
+            int x = ((bp->history >> i) & 1) ? 1 : -1;
+            train_weight(&w[i + 1], t * x);
+        }
+    }
+
+    bp->history = (bp->history << 1) | (taken ? 1 : 0);
+}
+
+static void perceptron_destroy(void* state) {
+    Perceptron* bp = state;
+    free(bp->weights);
+    free(bp);
+}
+
+static uint64_t perceptron_storage_bits(const void* state) {
+    const Perceptron* bp = state;
+    return (uint64_t)bp->count * (bp->history_bits + 1) * 8 + bp->history_bits;
+}
+
+static void perceptron_describe(const void* state, char* buf, size_t len) {
+    const Perceptron* bp = state;
+    snprintf(buf, len, "%u perceptrons, %d-bit history, 8-bit weights, threshold %d",
+             bp->count, bp->history_bits, bp->threshold);
+}
+
+static void perceptron_checkpoint(void* state, Checkpoint* ck) {
+    Perceptron* bp = state;
+    ckpt_region(ck, bp->weights, (size_t)bp->count * (bp->history_bits + 1));
+    ckpt_region(ck, &bp->history, sizeof(bp->history));
+}
+
+const BranchPredictorOps perceptron_predictor = {
+    "perceptron",
+    perceptron_create,
+    perceptron_predict,
+    perceptron_update,
+    perceptron_destroy,
+    perceptron_storage_bits,
+    perceptron_describe,
+    perceptron_checkpoint,
+};
@@ -1,94 +1,149 @@
 #include "structure.h"
+#include <stdlib.h>
 
-// 브랜치 예측 테이블 
-#define BRANCH_PREDICTOR_SIZE 256
-#define BRANCH_PREDICTOR_MASK (BRANCH_PREDICTOR_SIZE - 1)
+// 분기 예측기 프레임워크
+// 실제 예측 알고리즘은 branch_*.c의 BranchPredictorOps 구현이 담당하고,
+// 여기서는 선택, 정확도 집계, 통계 출력만 한다.
 
-// 2-bit saturating counter states
-typedef enum {
-    STRONGLY_NOT_TAKEN = 0,   // 00
-    WEAKLY_NOT_TAKEN = 1,     // 01
-    WEAKLY_TAKEN = 2,         // 10
-    STRONGLY_TAKEN = 3        // 11
-} BranchState;
+static const BranchPredictorOps* const predictor_list[] = {
+    &bimodal_predictor,
+    &gshare_predictor,
+    &tournament_predictor,
+    &tage_predictor,
+    &perceptron_predictor,
+};
 
-static BranchState branch_predictor_table[BRANCH_PREDICTOR_SIZE];
-static bool predictor_initialized = false;
+#define NUM_PREDICTORS ((int)(sizeof(predictor_list) / sizeof(predictor_list[0])))
 
-extern uint64_t branch_predictions;
-extern uint64_t branch_correct_predictions;
-extern uint64_t branch_mispredictions;
+struct PredictorState {
+    const BranchPredictorOps* ops;
+    void* state;
+};
 
-void init_branch_predictor(void) {
-    if (!predictor_initialized) {
-        // 모든 엔트리를 WEAKLY_NOT_TAKEN으로 초기화
-        for (int i = 0; i < BRANCH_PREDICTOR_SIZE; i++) {
-            branch_predictor_table[i] = WEAKLY_NOT_TAKEN;
+int parse_branch_predictor(const char* name, int* kind) {
+    for (int i = 0; i < NUM_PREDICTORS; i++) {
+        if (strcmp(name, predictor_list[i]->name) == 0) {
+            *kind = i;
+            return 0;
         }
-        predictor_initialized = true;
-        
-        branch_predictions = 0;
-        branch_correct_predictions = 0;
-        branch_mispredictions = 0;
     }
+    fprintf(stderr, "Unknown branch predictor: %s (", name);
+    for (int i = 0; i < NUM_PREDICTORS; i++) {
+        fprintf(stderr, "%s%s", i ? ", " : "", predictor_list[i]->name);
+    }
+    fprintf(stderr, ")\n");
+    return -1;
 }
 
-static uint32_t get_predictor_index(uint32_t pc) {
-    // PC의 하위 비트들을 사용 (word aligned이므로 2비트 shift)
-    return (pc >> 2) & BRANCH_PREDICTOR_MASK;
+void init_branch_predictor(void) {
+    if (sim->predictor == NULL) {
+        sim->predictor = malloc(sizeof(struct PredictorState));
+        if (sim->predictor == NULL) {
+            fprintf(stderr, "branch predictor: out of memory\n");
+            exit(1);
+        }
+
+        int kind = (sim->bp_kind >= 0 && sim->bp_kind < NUM_PREDICTORS) ? sim->bp_kind : 0;
+        sim->predictor->ops = predictor_list[kind];
+        sim->predictor->state = sim->predictor->ops->create(sim->bp_budget);
+
+        sim->branch_predictions = 0;
+        sim->branch_correct_predictions = 0;
+        sim->branch_mispredictions = 0;
+    }
 }
 
 bool predict_branch(uint32_t pc) {
     init_branch_predictor();
-    
-    uint32_t index = get_predictor_index(pc);
-    BranchState state = branch_predictor_table[index];
-    
-    branch_predictions++;
-    
-    // WEAKLY_TAKEN 이상이면 taken으로 예측
-    return (state >= WEAKLY_TAKEN);
+
+    sim->branch_predictions++;
+
+    return sim->predictor->ops->predict(sim->predictor->state, pc);
 }
 
 void update_branch_predictor(uint32_t pc, bool actual_taken, bool predicted_taken) {
-    uint32_t index = get_predictor_index(pc);
-    BranchState current_state = branch_predictor_table[index];
-    
     // 예측 정확도 업데이트
     if (actual_taken == predicted_taken) {
-        branch_correct_predictions++;
+        sim->branch_correct_predictions++;
     } else {
-        branch_mispredictions++;
-    }
-    
-    // 2-bit saturating counter 업데이트
-    if (actual_taken) {
-        // 브랜치가 taken됨 - counter 증가 (최대 3)
-        if (current_state < STRONGLY_TAKEN) {
-            branch_predictor_table[index] = current_state + 1;
-        }
-    } else {
-        // 브랜치가 not taken됨 - counter 감소 (최소 0)
-        if (current_state > STRONGLY_NOT_TAKEN) {
-            branch_predictor_table[index] = current_state - 1;
-        }
+        sim->branch_mispredictions++;
     }
+
+    sim->predictor->ops->update(sim->predictor->state, pc, actual_taken);
+}
+
+uint64_t branch_predictor_storage_bits(void) {
+    init_branch_predictor();
+    return sim->predictor->ops->storage_bits(sim->predictor->state);
+}
+
+const char* branch_predictor_name(void) {
+    init_branch_predictor();
+    return sim->predictor->ops->name;
 }
 
 void print_branch_prediction_stats(void) {
-    if (branch_predictions > 0) {
-        double accuracy = (double)branch_correct_predictions / branch_predictions * 100.0;
+    if (sim->branch_predictions > 0) {
+        double accuracy = (double)sim->branch_correct_predictions / sim->branch_predictions * 100.0;
+        char desc[128];
+        uint64_t bits = branch_predictor_storage_bits();
+
+        sim->predictor->ops->describe(sim->predictor->state, desc, sizeof(desc));
         printf("Branch Prediction Statistics:\n");
-        printf("  Total predictions: %llu\n", (unsigned long long)branch_predictions);
-        printf("  Correct predictions: %llu\n", (unsigned long long)branch_correct_predictions);
-        printf("  Mispredictions: %llu\n", (unsigned long long)branch_mispredictions);
+        printf("  Total predictions: %llu\n", (unsigned long long)sim->branch_predictions);
+        printf("  Correct predictions: %llu\n", (unsigned long long)sim->branch_correct_predictions);
+        printf("  Mispredictions: %llu\n", (unsigned long long)sim->branch_mispredictions);
         printf("  Prediction accuracy: %.2f%%\n", accuracy);
+        printf("  Predictor: %s (%s)\n", sim->predictor->ops->name, desc);
+        printf("  Storage: %llu bits (%.1f bytes, budget %u bytes)\n",
+               (unsigned long long)bits, bits / 8.0, sim->bp_budget);
     }
 }
 
 void reset_branch_predictor(void) {
     init_branch_predictor();
-    branch_predictions = 0;
-    branch_correct_predictions = 0;
-    branch_mispredictions = 0;
-}
\ No newline at end of file
+    sim->branch_predictions = 0;
+    sim->branch_correct_predictions = 0;
+    sim->branch_mispredictions = 0;
+}
+
+// 예측기 테이블은 구현마다 다르므로 ops에 맡긴다
+void branch_predictor_checkpoint(Checkpoint* ck) {
+    init_branch_predictor();
+    sim->predictor->ops->checkpoint(sim->predictor->state, ck);
+}
+
+void free_branch_predictor(void) {
+    if (sim->predictor == NULL) {
+        return;
+    }
+    sim->predictor->ops->destroy(sim->predictor->state);
+    free(sim->predictor);
+    sim->predictor = NULL;
+}
+
+// 예측기들이 공유하는 도우미
+uint32_t bp_floor_pow2(uint64_t n) {
+    uint32_t p = 1;
+    while ((uint64_t)p * 2 <= n && p < (1u << 30)) {
+        p *= 2;
+    }
+    return p;
+}
+
+int bp_log2(uint32_t n) {
+    int bits = 0;
+    while ((1u << bits) < n) {
+        bits++;
+    }
+    return bits;
+}
+
+// 2-bit saturating counter
+void bp_counter_update(uint8_t* counter, bool taken) {
+    if (taken) {
+        if (*counter < 3) (*counter)++;
+    } else {
+        if (*counter > 0) (*counter)--;
+    }
+}
@@ -0,0 +1,236 @@
+#include "structure.h"
+#include <stdlib.h>
+
+// TAGE: bimodal 기본 예측기 + 기하급수 길이의 전역 히스토리를 쓰는 태그 테이블들
+// 가장 긴 히스토리에서 태그가 일치한 엔트리(provider)가 예측하고, 새로 할당된
+// 약한 엔트리면 다음으로 긴 일치(alternate)를 쓴다. 예측이 틀리면 더 긴
+// 테이블에 엔트리를 할당하고, useful 비트로 교체 대상을 고른다.
+
+#define TAGE_TABLES         4
+#define TAGE_TAG_BITS       8
+#define TAGE_CTR_MAX        3       // 3-bit signed counter: -4 .. 3
+#define TAGE_CTR_MIN        (-4)
+#define TAGE_U_MAX          3       // 2-bit useful counter
+#define TAGE_U_RESET_PERIOD (1u << 18)
+
+static const int tage_history_lengths[TAGE_TABLES] = {4, 8, 16, 32};
+
+typedef struct {
+    int8_t ctr;
+    uint8_t u;
+    uint16_t tag;
+} TageEntry;
+
+typedef struct {
+    uint32_t base_entries;
+    uint8_t* base;
+    uint32_t entries;               // 태그 테이블당 엔트리 수
+    int index_bits;
+    TageEntry* tables[TAGE_TABLES];
+    uint64_t history;               // 전역 히스토리 (최근 분기가 bit 0)
+    uint32_t updates;
+    uint64_t provider_hits[TAGE_TABLES + 1];    // [0]: 기본 예측기
+} Tage;
+
+// 히스토리 하위 length 비트를 bits 비트 단위로 XOR 접기
+static uint32_t fold_history(uint64_t history, int length, int bits) {
+    uint64_t h = (length >= 64) ? history : (history & ((1ULL << length) - 1));
+    uint32_t folded = 0;
+    while (h != 0) {
+        folded ^= (uint32_t)(h & ((1u << bits) - 1));
+        h >>= bits;
+    }
+    return folded;
+}
+
+static uint32_t tage_index(const Tage* bp, int t, uint32_t pc) {
+    uint32_t p = pc >> 2;
+    return (p ^ (p >> bp->index_bits) ^ fold_history(bp->history, tage_history_lengths[t], bp->index_bits))
+           & (bp->entries - 1);
+}
+
+static uint16_t tage_tag(const Tage* bp, int t, uint32_t pc) {
+    uint32_t p = pc >> 2;
+    uint32_t h1 = fold_history(bp->history, tage_history_lengths[t], TAGE_TAG_BITS);
+    uint32_t h2 = fold_history(bp->history, tage_history_lengths[t], TAGE_TAG_BITS - 1);
+    return (uint16_t)((p ^ h1 ^ (h2 << 1)) & ((1u << TAGE_TAG_BITS) - 1));
+}
+
+static void* tage_create(uint32_t budget_bytes) {
+    Tage* bp = calloc(1, sizeof(Tage));
+    uint64_t bits = (uint64_t)budget_bytes * 8;
+    const int entry_bits = 3 + 2 + TAGE_TAG_BITS;
+
+    // 예산의 1/4은 기본 예측기, 나머지(히스토리 64비트 제외)를 태그 테이블에 균등 분배
+    bp->base_entries = bp_floor_pow2(bits / 4 / 2);
+    uint64_t rest = bits - (uint64_t)bp->base_entries * 2;
+    rest = (rest > 64) ? rest - 64 : 0;
+    bp->entries = bp_floor_pow2(rest / TAGE_TABLES / entry_bits);
+    if (bp->entries < 4) {
+        bp->entries = 4;
+    }
+    bp->index_bits = bp_log2(bp->entries);
+
+    bp->base = malloc(bp->base_entries);
+    memset(bp->base, 1, bp->base_entries);
+    for (int t = 0; t < TAGE_TABLES; t++) {
+        bp->tables[t] = calloc(bp->entries, sizeof(TageEntry));
+    }
+    return bp;
+}
+
+typedef struct {
+    int provider;           // -1이면 기본 예측기
+    int alternate;
+    uint32_t index[TAGE_TABLES];
+    uint16_t tag[TAGE_TABLES];
+    bool provider_pred;
+    bool alt_pred;
+    bool final_pred;
+} TageLookup;
+
+static void tage_lookup(const Tage* bp, uint32_t pc, TageLookup* l) {
+    l->provider = -1;
+    l->alternate = -1;
+
+    for (int t = TAGE_TABLES - 1; t >= 0; t--) {
+        l->index[t] = tage_index(bp, t, pc);
+        l->tag[t] = tage_tag(bp, t, pc);
+        if (bp->tables[t][l->index[t]].tag == l->tag[t]) {
+            if (l->provider < 0) {
+                l->provider = t;
+            } else if (l->alternate < 0) {
+                l->alternate = t;
+            }
+        }
+    }
+
+    bool base_pred = bp->base[(pc >> 2) & (bp->base_entries - 1)] >= 2;
+    l->alt_pred = (l->alternate >= 0) ? bp->tables[l->alternate][l->index[l->alternate]].ctr >= 0 : base_pred;
+
+    if (l->provider < 0) {
+        l->provider_pred = base_pred;
+        l->final_pred = base_pred;
+        return;
+    }
+
+    const TageEntry* e = &bp->tables[l->provider][l->index[l->provider]];
+    l->provider_pred = e->ctr >= 0;
+
+    // 방금 할당된 약한 엔트리는 아직 믿지 않는다
+    bool weak = (e->ctr == 0 || e->ctr == -1) && e->u == 0;
+    l->final_pred = weak ? l->alt_pred : l->provider_pred;
+}
+
+static bool tage_predict(void* state, uint32_t pc) {
+    Tage* bp = state;
+    TageLookup l;
+    tage_lookup(bp, pc, &l);
+    bp->provider_hits[l.provider + 1]++;
+    return l.final_pred;
+}
+
+static void tage_update(void* state, uint32_t pc, bool taken) {
+    Tage* bp = state;
+    TageLookup l;
+
+    // 예측 이후 히스토리가 바뀌지 않았으므로 같은 인덱스가 다시 계산된다
+    tage_lookup(bp, pc, &l);
+
+    if (l.provider >= 0) {
+        TageEntry* e = &bp->tables[l.provider][l.index[l.provider]];
+        if (taken) {
+            if (e->ctr < TAGE_CTR_MAX) e->ctr++;
+        } else {
+            if (e->ctr > TAGE_CTR_MIN) e->ctr--;
+        }
+        if (l.provider_pred != l.alt_pred) {
+            if (l.provider_pred == taken) {
+                if (e->u < TAGE_U_MAX) e->u++;
+            } else if (e->u > 0) {
+                e->u--;
+            }
+        }
+    } else {
+        bp_counter_update(&bp->base[(pc >> 2) & (bp->base_entries - 1)], taken);
+    }
+
+    // 틀렸으면 더 긴 히스토리 테이블에 할당
+    if (l.final_pred != taken && l.provider < TAGE_TABLES - 1) {
+        bool allocated = false;
+        for (int t = l.provider + 1; t < TAGE_TABLES; t++) {
+            TageEntry* e = &bp->tables[t][l.index[t]];
+            if (e->u == 0) {
+                e->tag = l.tag[t];
+                e->ctr = taken ? 0 : -1;
+                allocated = true;
+                break;
+            }
+        }
+        if (!allocated) {
+            for (int t = l.provider + 1; t < TAGE_TABLES; t++) {
+                TageEntry* e = &bp->tables[t][l.index[t]];
+                if (e->u > 0) e->u--;
+            }
+        }
+    }
+
+    // useful 비트는 주기적으로 절반으로 낮춘다
+    if (++bp->updates % TAGE_U_RESET_PERIOD == 0) {
+        for (int t = 0; t < TAGE_TABLES; t++) {
+            for (uint32_t i = 0; i < bp->entries; i++) {
+                bp->tables[t][i].u >>= 1;
+            }
+        }
+    }
+
+    bp->history = (bp->history << 1) | (taken ? 1 : 0);
+}
+
+static void tage_destroy(void* state) {
+    Tage* bp = state;
+    free(bp->base);
+    for (int t = 0; t < TAGE_TABLES; t++) {
+        free(bp->tables[t]);
+    }
+    free(bp);
+}
+
+static uint64_t tage_storage_bits(const void* state) {
+    const Tage* bp = state;
+    return (uint64_t)bp->base_entries * 2 +
+           (uint64_t)TAGE_TABLES * bp->entries * (3 + 2 + TAGE_TAG_BITS) + 64;
+}
+
+static void tage_describe(const void* state, char* buf, size_t len) {
+    const Tage* bp = state;
+    uint64_t total = 0;
+    for (int t = 0; t <= TAGE_TABLES; t++) {
+        total += bp->provider_hits[t];
+    }
+    double tagged = total ? 100.0 * (total - bp->provider_hits[0]) / total : 0.0;
+    snprintf(buf, len, "base %u x 2-bit, %d x %u tagged entries, histories 4/8/16/32, tagged provider %.1f%%",
+             bp->base_entries, TAGE_TABLES, bp->entries, tagged);
+}
+
+static void tage_checkpoint(void* state, Checkpoint* ck) {
+    Tage* bp = state;
+    ckpt_region(ck, bp->base, bp->base_entries);
+    for (int t = 0; t < TAGE_TABLES; t++) {
+        ckpt_region(ck, bp->tables[t], sizeof(TageEntry) * bp->entries);
+    }
+    ckpt_region(ck, &bp->history, sizeof(bp->history));
+    ckpt_region(ck, &bp->updates, sizeof(bp->updates));
+    ckpt_region(ck, bp->provider_hits, sizeof(bp->provider_hits));
+}
+
+const BranchPredictorOps tage_predictor = {
+    "tage",
+    tage_create,
+    tage_predict,
+    tage_update,
+    tage_destroy,
+    tage_storage_bits,
+    tage_describe,
+    tage_checkpoint,
+};
@@ -0,0 +1,107 @@
+#include "structure.h"
+#include <stdlib.h>
+
+// Tournament: bimodal(PC)과 gshare(전역 히스토리) 중 PC별 chooser가 고른 쪽을 사용
+// chooser도 2-bit counter (2 이상이면 gshare 선택), 세 테이블은 같은 크기
+
+typedef struct {
+    uint32_t entries;
+    uint32_t mask;
+    int history_bits;
+    uint32_t history;
+    uint8_t* local;         // bimodal
+    uint8_t* global;        // gshare
+    uint8_t* chooser;
+    uint64_t chose_global;
+    uint64_t lookups;
+} Tournament;
+
+static void* tournament_create(uint32_t budget_bytes) {
+    Tournament* bp = calloc(1, sizeof(Tournament));
+    uint64_t bits = (uint64_t)budget_bytes * 8;
+
+    // 3 * 2 * entries + log2(entries) <= bits
+    bp->entries = bp_floor_pow2(bits / 6);
+    while (bp->entries > 1 && (uint64_t)bp->entries * 6 + bp_log2(bp->entries) > bits) {
+        bp->entries /= 2;
+    }
+    bp->mask = bp->entries - 1;
+    bp->history_bits = bp_log2(bp->entries);
+    bp->local = malloc(bp->entries);
+    bp->global = malloc(bp->entries);
+    bp->chooser = malloc(bp->entries);
+    memset(bp->local, 1, bp->entries);
+    memset(bp->global, 1, bp->entries);
+    memset(bp->chooser, 1, bp->entries);    // 처음에는 bimodal 쪽으로 약하게
+    return bp;
+}
+
+static bool tournament_predict(void* state, uint32_t pc) {
+    Tournament* bp = state;
+    uint32_t li = (pc >> 2) & bp->mask;
+    uint32_t gi = ((pc >> 2) ^ bp->history) & bp->mask;
+
+    bp->lookups++;
+    if (bp->chooser[li] >= 2) {
+        bp->chose_global++;
+        return bp->global[gi] >= 2;
+    }
+    return bp->local[li] >= 2;
+}
+
+static void tournament_update(void* state, uint32_t pc, bool taken) {
+    Tournament* bp = state;
+    uint32_t li = (pc >> 2) & bp->mask;
+    uint32_t gi = ((pc >> 2) ^ bp->history) & bp->mask;
+    bool local_correct = (bp->local[li] >= 2) == taken;
+    bool global_correct = (bp->global[gi] >= 2) == taken;
+
+    // 두 예측이 다를 때만 맞힌 쪽으로 chooser 이동
+    if (local_correct != global_correct) {
+        bp_counter_update(&bp->chooser[li], global_correct);
+    }
+    bp_counter_update(&bp->local[li], taken);
+    bp_counter_update(&bp->global[gi], taken);
+    bp->history = ((bp->history << 1) | (taken ? 1 : 0)) & bp->mask;
+}
+
+static void tournament_destroy(void* state) {
+    Tournament* bp = state;
+    free(bp->local);
+    free(bp->global);
+    free(bp->chooser);
+    free(bp);
+}
+
+static uint64_t tournament_storage_bits(const void* state) {
+    const Tournament* bp = state;
+    return (uint64_t)bp->entries * 6 + bp->history_bits;
+}
+
+static void tournament_describe(const void* state, char* buf, size_t len) {
+    const Tournament* bp = state;
+    double global_share = bp->lookups ? 100.0 * bp->chose_global / bp->lookups : 0.0;
+    snprintf(buf, len, "3 x %u x 2-bit counters, %d-bit history, gshare chosen %.1f%%",
+             bp->entries, bp->history_bits, global_share);
+}
+
+static void tournament_checkpoint(void* state, Checkpoint* ck) {
+    Tournament* bp = state;
+    ckpt_region(ck, bp->local, bp->entries);
+    ckpt_region(ck, bp->global, bp->entries);
+    ckpt_region(ck, bp->chooser, bp->entries);
+    ckpt_region(ck, &bp->history, sizeof(bp->history));
+    ckpt_region(ck, &bp->chose_global, sizeof(bp->chose_global));
+    ckpt_region(ck, &bp->lookups, sizeof(bp->lookups));
+}
+
+const BranchPredictorOps tournament_predictor = {
+    "tournament",
+    tournament_create,
+    tournament_predict,
+    tournament_update,
+    tournament_destroy,
+    tournament_storage_bits,
+    tournament_describe,
+    tournament_checkpoint,
+};
@@ -0,0 +1,207 @@
+#include "structure.h"
+#include <stdlib.h>
+
+// 분기 목적지 버퍼(BTB)와 리턴 주소 스택(RAS)
+// stage_IF는 BTB로 다음 페치 주소를 고르고, stage_ID는 실제 목적지를 확인한 뒤
+// resolve_control_flow로 BTB와 RAS를 갱신한다. RAS는 디코드 시점에 push/pop하고
+// IF는 맨 위 값만 읽는다 (잘못된 경로의 페치가 스택을 망가뜨리지 않음).
+
+typedef struct {
+    bool valid;
+    uint32_t pc;                // 전체 PC를 태그로 사용
+    uint32_t target;
+    ControlFlowKind kind;
+} BtbEntry;
+
+typedef struct {
+    uint64_t lookups;           // 해석된 제어 흐름 명령어 수
+    uint64_t hits;
+    uint64_t wrong_target;      // BTB 적중이지만 목적지가 틀림
+    uint64_t returns;
+    uint64_t ras_correct;
+    uint64_t ras_overflows;
+    uint64_t ras_underflows;
+} TargetStats;
+
+struct TargetPredictor {
+    uint32_t btb_entries;       // 0이면 BTB 없음
+    BtbEntry* btb;
+    int ras_depth;              // 0이면 RAS 없음
+    int ras_top;                // 다음 push 위치 (원형)
+    int ras_count;
+    uint32_t* ras;
+    TargetStats stats;
+};
+
+static const char* const kind_names[] = {"branch", "jump", "call", "return", "indirect"};
+
+void init_target_predictor(void) {
+    if (sim->target != NULL) {
+        return;
+    }
+
+    struct TargetPredictor* tp = calloc(1, sizeof(struct TargetPredictor));
+    if (tp == NULL) {
+        fprintf(stderr, "target predictor: out of memory\n");
+        exit(1);
+    }
+    tp->btb_entries = sim->btb_entries;
+    tp->ras_depth = sim->ras_depth;
+    if (tp->btb_entries > 0) {
+        tp->btb = calloc(tp->btb_entries, sizeof(BtbEntry));
+    }
+    if (tp->ras_depth > 0) {
+        tp->ras = calloc(tp->ras_depth, sizeof(uint32_t));
+    }
+    if ((tp->btb_entries > 0 && tp->btb == NULL) || (tp->ras_depth > 0 && tp->ras == NULL)) {
+        fprintf(stderr, "target predictor: out of memory\n");
+        exit(1);
+    }
+    sim->target = tp;
+}
+
+static BtbEntry* btb_find(struct TargetPredictor* tp, uint32_t pc) {
+    if (tp->btb_entries == 0) {
+        return NULL;
+    }
+    BtbEntry* e = &tp->btb[(pc >> 2) & (tp->btb_entries - 1)];
+    return (e->valid && e->pc == pc) ? e : NULL;
+}
+
+static bool ras_peek(const struct TargetPredictor* tp, uint32_t* addr) {
+    if (tp->ras_count == 0) {
+        return false;
+    }
+    *addr = tp->ras[(tp->ras_top + tp->ras_depth - 1) % tp->ras_depth];
+    return true;
+}
+
+static void ras_push(struct TargetPredictor* tp, uint32_t addr) {
+    if (tp->ras_depth == 0) {
+        return;
+    }
+    // 가득 차면 가장 오래된 항목을 덮어쓴다
+    tp->ras[tp->ras_top] = addr;
+    tp->ras_top = (tp->ras_top + 1) % tp->ras_depth;
+    if (tp->ras_count == tp->ras_depth) {
+        tp->stats.ras_overflows++;
+    } else {
+        tp->ras_count++;
+    }
+}
+
+static void ras_pop(struct TargetPredictor* tp) {
+    if (tp->ras_count == 0) {
+        if (tp->ras_depth > 0) {
+            tp->stats.ras_underflows++;
+        }
+        return;
+    }
+    tp->ras_top = (tp->ras_top + tp->ras_depth - 1) % tp->ras_depth;
+    tp->ras_count--;
+}
+
+// IF 단계: pc 다음에 가져올 주소. BTB에 없으면 pc+4.
+// 조건 분기는 방향 예측기가 taken이라고 할 때만 BTB 목적지로 간다.
+uint32_t predict_fetch_target(uint32_t pc, bool predicted_taken, bool* btb_hit) {
+    init_target_predictor();
+    struct TargetPredictor* tp = sim->target;
+    const BtbEntry* e = btb_find(tp, pc);
+
+    *btb_hit = (e != NULL);
+    if (e == NULL || (e->kind == CF_BRANCH && !predicted_taken)) {
+        return pc + 4;
+    }
+
+    uint32_t target = e->target;
+    if (e->kind == CF_RETURN) {
+        ras_peek(tp, &target);
+    }
+    TRACE(TRACE_BRANCH, "[IF] BTB hit: PC=0x%08x %s -> 0x%08x\n", pc, kind_names[e->kind], target);
+    return target;
+}
+
+// ID 단계(또는 워밍 중인 기능 시뮬레이션): 실제 결과로 BTB/RAS 갱신
+void resolve_control_flow(uint32_t pc, ControlFlowKind kind, uint32_t target, bool taken, bool btb_hit) {
+    init_target_predictor();
+    struct TargetPredictor* tp = sim->target;
+    BtbEntry* e = btb_find(tp, pc);
+
+    tp->stats.lookups++;
+    if (btb_hit) {
+        tp->stats.hits++;
+    }
+
+    if (kind == CF_RETURN) {
+        uint32_t top;
+        tp->stats.returns++;
+        if (ras_peek(tp, &top) && top == target) {
+            tp->stats.ras_correct++;
+        }
+        ras_pop(tp);
+    } else if (kind == CF_CALL) {
+        ras_push(tp, pc + 8);           // jal은 PC+8을 링크
+    }
+
+    if (btb_hit && e != NULL && kind != CF_RETURN && taken && e->target != target) {
+        tp->stats.wrong_target++;
+    }
+
+    // 분기가 taken이었을 때만 할당 (not-taken은 fall-through로 충분)
+    if (taken && tp->btb_entries > 0) {
+        BtbEntry* slot = &tp->btb[(pc >> 2) & (tp->btb_entries - 1)];
+        slot->valid = true;
+        slot->pc = pc;
+        slot->target = target;
+        slot->kind = kind;
+    }
+}
+
+void reset_target_predictor(void) {
+    init_target_predictor();
+    memset(&sim->target->stats, 0, sizeof(sim->target->stats));
+    sim->fetch_redirects = 0;
+    sim->fetch_squashed = 0;
+}
+
+void target_predictor_checkpoint(Checkpoint* ck) {
+    init_target_predictor();
+    struct TargetPredictor* tp = sim->target;
+    ckpt_region(ck, tp->btb, sizeof(BtbEntry) * tp->btb_entries);
+    ckpt_region(ck, tp->ras, sizeof(uint32_t) * tp->ras_depth);
+    ckpt_region(ck, &tp->ras_top, sizeof(tp->ras_top));
+    ckpt_region(ck, &tp->ras_count, sizeof(tp->ras_count));
+    ckpt_region(ck, &tp->stats, sizeof(tp->stats));
+}
+
+void print_target_prediction_stats(void) {
+    const struct TargetPredictor* tp = sim->target;
+    if (tp == NULL || tp->stats.lookups == 0) {
+        return;
+    }
+    const TargetStats* s = &tp->stats;
+
+    printf("Target Prediction Statistics:\n");
+    printf("  BTB: %u entries, %llu lookups, %llu hits (%.2f%%), %llu wrong targets\n",
+           tp->btb_entries, (unsigned long long)s->lookups, (unsigned long long)s->hits,
+           100.0 * s->hits / s->lookups, (unsigned long long)s->wrong_target);
+    if (s->returns > 0) {
+        printf("  RAS: depth %d, %llu returns, %llu correct (%.2f%%), %llu overflows, %llu underflows\n",
+               tp->ras_depth, (unsigned long long)s->returns, (unsigned long long)s->ras_correct,
+               100.0 * s->ras_correct / s->returns,
+               (unsigned long long)s->ras_overflows, (unsigned long long)s->ras_underflows);
+    }
+    printf("  Fetch redirects: %llu (%llu squashed fetch slots, penalty %d)\n",
+           (unsigned long long)sim->fetch_redirects, (unsigned long long)sim->fetch_squashed,
+           sim->mispredict_penalty);
+}
+
+void free_target_predictor(void) {
+    if (sim->target == NULL) {
+        return;
+    }
+    free(sim->target->btb);
+    free(sim->target->ras);
+    free(sim->target);
+    sim->target = NULL;
+}
@@ -1,363 +1,1536 @@
 #include "structure.h"
+#include <stdlib.h>
 
-#define CACHE_SET_SIZE 2048     // 캐시 세트의 개수
+// 태그 비교 벡터화: 기본은 SSE2, make SIMD=avx2면 AVX2, SIMD=none이면 스칼라
+#if !defined(CACHE_NO_SIMD) && defined(__AVX2__)
+#include <immintrin.h>
+#define TAG_LANES 8
+#define REPL_LANES 16
+#elif !defined(CACHE_NO_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#define TAG_LANES 4
+#define REPL_LANES 16
+#else
+#define TAG_LANES 1
+#define REPL_LANES 1
+#endif
+
+// 기본 L1 구성 (명령행 --l1i/--l1d로 변경 가능)
+#define CACHE_SET_SIZE 512      // 캐시 세트의 개수
 #define CACHE_ASSOC 4          // 4-way associative
-#define CACHE_LINE_SIZE 4      // 캐시 라인 데이터 크기 
+#define CACHE_LINE_SIZE 16     // 캐시 라인 데이터 크기 (4워드, 32KB 용량 유지)
 
-typedef struct {
-    uint32_t tag;
-    uint8_t data[CACHE_LINE_SIZE];
-    int valid;
-    int dirty;
-    int lru;
-    int accessed;   
-} CacheLine;
+#define CACHE_MAX_LINE_SIZE 256 // 워드 사용 비트맵(64비트)에 들어가는 최대 크기
+#define CACHE_MAX_ASSOC 256     // 교체 순서를 8비트로 저장
+
+// RRIP: 2비트 재참조 예측값 (0 = 곧 다시 씀, 3 = 먼 미래)
+#define RRPV_MAX        3
+#define BRRIP_LONG_ODDS 32      // BRRIP는 1/32 확률로만 RRPV_MAX-1로 넣는다
+
+// DRRIP set dueling: 32세트마다 SRRIP 리더 하나, BRRIP 리더 하나
+#define DUEL_PERIOD     32
+#define PSEL_MAX        1023    // 10비트 포화 카운터
+
+// 빈 라인의 태그. 태그는 주소 / (sets * line_size) < 2^30이므로 실제 태그와 겹치지 않고,
+// 덕분에 한 번의 비교로 valid 검사까지 끝난다.
+#define CACHE_INVALID_TAG 0xFFFFFFFFu
+
+// 프리페치가 내보낸 블록을 기억하는 표 (직접 사상). demand 미스가 여기 걸리면 오염.
+#define PF_FILTER_ENTRIES 1024
+
+// 라인이 빠질 때까지 쓴 워드 비율 구간: 0, ~25%, ~50%, ~75%, 100% 미만, 전부
+#define LINE_USE_BUCKETS 6
 
 typedef struct {
-    CacheLine lines[CACHE_ASSOC];
-} CacheSet;
+    uint64_t access;
+    uint64_t hit;
+    uint64_t compulsory_miss;       // 3C 분류 (cache_3c.c)
+    uint64_t capacity_miss;
+    uint64_t conflict_miss;
+    uint64_t writebacks;            // 하위 레벨(메모리)로 내려보낸 dirty 라인
+    uint64_t back_invalidations;    // inclusive 정책으로 상위 캐시에서 지운 라인
+    uint64_t retired_lines;         // 교체/무효화로 빠진 라인
+    uint64_t retired_words_used;    // 그 라인들이 있는 동안 접근한 워드 수의 합
+    uint64_t line_use_hist[LINE_USE_BUCKETS];
+    uint64_t pf_issued;             // 캐시나 스트림 버퍼로 가져온 프리페치
+    uint64_t pf_useful;             // 쓰이기 전에 빠지지 않은 것
+    uint64_t pf_late;               // 그중 demand가 채우기 완료 전에 온 것
+    uint64_t pf_unused;             // 쓰이지 않고 빠진 것
+    uint64_t pf_polluting;          // 프리페치에 밀려난 블록에 대한 demand 미스
+    uint64_t victim_hits;           // L1 미스를 victim cache가 받아 준 횟수
+    uint64_t victim_conflict_hits;  // 그중 conflict miss였던 것
+} CacheStats;
 
+// L1과 하위 레벨 사이의 작은 완전 연관 victim cache (Jouppi).
+// L1에서 빠지는 라인을 받고, L1 미스 때 먼저 찾아서 히트면 L1 victim과 맞바꾼다.
+// 블록은 L1과 victim cache 중 한 곳에만 있다.
 typedef struct {
-    CacheSet sets[CACHE_SET_SIZE];
-} Cache;
+    int entries;
+    uint32_t* blocks;               // [entries] 블록 주소, 빈 칸은 CACHE_INVALID_TAG
+    uint8_t* dirty;
+    uint64_t* stamp;                // 마지막으로 넣은 시각 (LRU)
+    uint8_t* data;                  // [entries][line_size]
+    uint64_t clock;
+} VictimCache;
+
+// 태그 저장소는 구조체 배열 대신 필드별 배열로 나눈다. 세트 하나의 태그가
+// 연속해 있어서 태그 비교가 벡터 몇 번으로 끝나고, 데이터는 히트가 확정된 뒤에만 건드린다.
+typedef struct CacheLevel {
+    const char* name;
+    int level;
+    CacheConfig config;
+    int tag_stride;                 // 세트당 태그 슬롯 (assoc를 TAG_LANES 배수로 올림)
+    int offset_bits;                // log2(line_size)
+    int set_bits;                   // log2(sets), sets가 2의 거듭제곱이 아니면 -1
+    uint32_t* tags;                 // [sets][tag_stride], 빈 라인과 패딩은 CACHE_INVALID_TAG
+    int repl_stride;                // 세트당 교체 정보 슬롯 (assoc를 REPL_LANES 배수로 올림)
+    uint8_t* repl;                  // [sets][repl_stride] 정책별 교체 정보 (아래 "교체 정책" 참고), 패딩은 0xFF
+    uint8_t* dirty;                 // [sets][assoc]
+    uint64_t* used;                 // [sets][assoc] 채운 뒤 접근한 워드 (비트 i = i번째 워드)
+    uint8_t* data;                  // [sets][assoc][line_size]
+    uint64_t* pf_ready;             // [sets][assoc] 프리페치한 뒤 아직 안 쓴 라인의 완료 시각, 아니면 0
+    uint32_t* pf_filter;            // [PF_FILTER_ENTRIES] 프리페치가 밀어낸 블록 번호 + 1
+    ShadowCache* shadow;            // 3C 분류용 완전 연관 LRU 섀도
+    VictimCache* victim;            // --l1d-victim/--l1i-victim, 없으면 NULL
+    struct CacheLevel* next;        // NULL이면 메인 메모리
+    struct CacheLevel* upper[2];    // 바로 위 레벨 (back-invalidation용)
+    int num_upper;
+    uint32_t rand_state;
+    int psel;                       // DRRIP: 클수록 SRRIP 리더 세트가 더 많이 미스
+    CacheStats stats;
+} CacheLevel;
+
+const CacheConfig default_cache_config[CACHE_NUM_LEVELS] = {
+    {CACHE_SET_SIZE, CACHE_ASSOC, CACHE_LINE_SIZE, REPL_LRU, INCL_NINE, PF_NONE, 0, CACHE_DEFAULT_LATENCY},   // L1 I
+    {CACHE_SET_SIZE, CACHE_ASSOC, CACHE_LINE_SIZE, REPL_LRU, INCL_NINE, PF_NONE, 0, CACHE_DEFAULT_LATENCY},   // L1 D
+    {0, 8, 64, REPL_LRU, INCL_INCLUSIVE, PF_NONE, 0, CACHE_DEFAULT_LATENCY},                                  // L2 (기본 비활성)
+    {0, 16, 64, REPL_LRU, INCL_INCLUSIVE, PF_NONE, 0, CACHE_DEFAULT_LATENCY},                                 // L3 (기본 비활성)
+};
+
+static const char* level_names[CACHE_NUM_LEVELS] = {
+    "Instruction Cache", "Data Cache", "L2 Cache", "L3 Cache"
+};
+
+struct CacheHierarchy {
+    CacheLevel levels[CACHE_NUM_LEVELS];
+    uint64_t clock;                 // 프리페치 완료 시각의 기준. 명령어 페치 수, 파이프라인에선 사이클 수
+    uint32_t miss_latency;          // 마지막 L1 접근이 하위 레벨이나 늦은 프리페치를 기다린 사이클, 히트면 0
+};
+
+#define instruction_cache (sim->cache->levels[CACHE_L1I])
+#define data_cache (sim->cache->levels[CACHE_L1D])
+
+static inline size_t line_index(const CacheLevel* c, uint32_t set, int way) {
+    return (size_t)set * c->config.assoc + way;
+}
+
+static inline uint32_t* set_tags(const CacheLevel* c, uint32_t set) {
+    return &c->tags[(size_t)set * c->tag_stride];
+}
+
+static inline uint8_t* set_repl(const CacheLevel* c, uint32_t set) {
+    return &c->repl[(size_t)set * c->repl_stride];
+}
+
+static inline uint8_t* data_at(CacheLevel* c, uint32_t set, int way) {
+    return &c->data[((size_t)set * c->config.assoc + way) * c->config.line_size];
+}
+
+static inline uint32_t block_address(CacheLevel* c, uint32_t set, uint32_t tag) {
+    return (tag * (uint32_t)c->config.sets + set) * (uint32_t)c->config.line_size;
+}
+
+// MEMORY_SIZE 밖의 바이트는 읽으면 0, 쓰면 무시
+static int clip_to_memory(uint32_t address, int size) {
+    if (address >= MEMORY_SIZE) {
+        return 0;
+    }
+    return (MEMORY_SIZE - address < (uint32_t)size) ? (int)(MEMORY_SIZE - address) : size;
+}
+
+static void mem_read_block(uint32_t address, uint8_t* out, int size) {
+    int valid = clip_to_memory(address, size);
+    mem_read(&sim->memory, address, out, valid);
+    memset(out + valid, 0, size - valid);
+}
+
+static void mem_write_block(uint32_t address, const uint8_t* in, int size) {
+    mem_write(&sim->memory, address, in, clip_to_memory(address, size));
+}
+
+static bool level_enabled(int level) {
+    return sim->cache_config[level].sets > 0;
+}
+
+static void free_level(CacheLevel* c) {
+    free(c->tags);
+    free(c->repl);
+    free(c->dirty);
+    free(c->used);
+    free(c->data);
+    free(c->pf_ready);
+    free(c->pf_filter);
+    shadow_free(c->shadow);
+    if (c->victim != NULL) {
+        free(c->victim->blocks);
+        free(c->victim->dirty);
+        free(c->victim->stamp);
+        free(c->victim->data);
+        free(c->victim);
+    }
+}
+
+static void init_repl(CacheLevel* c, uint32_t set);
+
+static void init_level(CacheLevel* c, int level) {
+    free_level(c);
+    memset(c, 0, sizeof(*c));
+
+    c->name = level_names[level];
+    c->level = level;
+    c->config = sim->cache_config[level];
+    c->tag_stride = (c->config.assoc + TAG_LANES - 1) / TAG_LANES * TAG_LANES;
+    c->repl_stride = (c->config.assoc + REPL_LANES - 1) / REPL_LANES * REPL_LANES;
+    c->offset_bits = __builtin_ctz((unsigned)c->config.line_size);
+    c->set_bits = (c->config.sets & (c->config.sets - 1)) ? -1 : __builtin_ctz((unsigned)c->config.sets);
+
+    size_t lines = (size_t)c->config.sets * c->config.assoc;
+    size_t tag_slots = (size_t)c->config.sets * c->tag_stride;
+    c->tags = malloc(tag_slots * sizeof(uint32_t));
+    c->repl = malloc((size_t)c->config.sets * c->repl_stride);
+    c->dirty = calloc(lines, 1);
+    c->used = calloc(lines, sizeof(uint64_t));
+    c->data = calloc(lines * c->config.line_size, 1);
+    c->shadow = shadow_create((int)lines, c->config.line_size);
+    if (!c->tags || !c->repl || !c->dirty || !c->used || !c->data || !c->shadow) {
+        fprintf(stderr, "%s: out of memory\n", c->name);
+        exit(1);
+    }
+    if (c->config.prefetcher != PF_NONE) {
+        c->pf_ready = calloc(lines, sizeof(uint64_t));
+        c->pf_filter = calloc(PF_FILTER_ENTRIES, sizeof(uint32_t));
+        if (!c->pf_ready || !c->pf_filter) {
+            fprintf(stderr, "%s: out of memory\n", c->name);
+            exit(1);
+        }
+    }
+    if (c->config.victim_entries > 0) {
+        int n = c->config.victim_entries;
+        VictimCache* v = calloc(1, sizeof(VictimCache));
+        if (v != NULL) {
+            v->entries = n;
+            v->blocks = malloc(sizeof(uint32_t) * n);
+            v->dirty = calloc(n, 1);
+            v->stamp = calloc(n, sizeof(uint64_t));
+            v->data = calloc((size_t)n, c->config.line_size);
+        }
+        c->victim = v;
+        if (!v || !v->blocks || !v->dirty || !v->stamp || !v->data) {
+            fprintf(stderr, "%s: out of memory\n", c->name);
+            exit(1);
+        }
+        for (int i = 0; i < n; i++) {
+            v->blocks[i] = CACHE_INVALID_TAG;
+        }
+    }
+    for (size_t i = 0; i < tag_slots; i++) {
+        c->tags[i] = CACHE_INVALID_TAG;
+    }
+    c->rand_state = sim->cache_seed + (uint32_t)level;
+    if (c->rand_state == 0) {
+        c->rand_state = 1;          // xorshift는 0에서 멈춘다
+    }
+    c->psel = (PSEL_MAX + 1) / 2;
+
+    memset(c->repl, 0xFF, (size_t)c->config.sets * c->repl_stride);
+    for (int i = 0; i < c->config.sets; i++) {
+        init_repl(c, i);
+    }
+}
 
-Cache instruction_cache;
-Cache data_cache;
+int validate_cache_config(void) {
+    const CacheConfig* config = sim->cache_config;
+
+    for (int level = 0; level < CACHE_NUM_LEVELS; level++) {
+        const CacheConfig* cfg = &config[level];
+        if (!level_enabled(level)) {
+            if (level <= CACHE_L1D) {
+                fprintf(stderr, "%s must be enabled\n", level_names[level]);
+                return -1;
+            }
+            continue;
+        }
+        if (cfg->assoc <= 0 || cfg->assoc > CACHE_MAX_ASSOC) {
+            fprintf(stderr, "%s: associativity must be 1..%d\n", level_names[level], CACHE_MAX_ASSOC);
+            return -1;
+        }
+        if (cfg->line_size < 4 || cfg->line_size > CACHE_MAX_LINE_SIZE ||
+            (cfg->line_size & (cfg->line_size - 1))) {
+            fprintf(stderr, "%s: line size must be a power of two in 4..%d\n",
+                    level_names[level], CACHE_MAX_LINE_SIZE);
+            return -1;
+        }
+        if ((level == CACHE_L1I && cfg->prefetcher != PF_NONE && cfg->prefetcher != PF_NEXT_LINE &&
+             cfg->prefetcher != PF_TARGET) ||
+            (level == CACHE_L1D && cfg->prefetcher == PF_TARGET)) {
+            fprintf(stderr, "%s: prefetcher '%s' is not available here\n",
+                    level_names[level], prefetcher_name(cfg->prefetcher));
+            return -1;
+        }
+        if (cfg->replacement == REPL_PLRU && (cfg->assoc & (cfg->assoc - 1))) {
+            fprintf(stderr, "%s: tree PLRU needs a power-of-two associativity\n", level_names[level]);
+            return -1;
+        }
+    }
 
-double inst_cache_hit = 0;
-double inst_cache_access = 0;
-int inst_cold_miss = 0;
-int inst_conflict_miss = 0;
+    if (level_enabled(CACHE_L3) && !level_enabled(CACHE_L2)) {
+        fprintf(stderr, "L3 requires L2\n");
+        return -1;
+    }
 
-double data_cache_hit = 0;
-double data_cache_access = 0;
-int data_cold_miss = 0;
-int data_conflict_miss = 0;
+    // 하위 레벨의 라인은 상위 레벨 라인보다 작을 수 없다 (exclusive는 같아야 함)
+    for (int level = CACHE_L2; level < CACHE_NUM_LEVELS; level++) {
+        if (!level_enabled(level)) {
+            continue;
+        }
+        int upper_max = (level == CACHE_L2)
+            ? (config[CACHE_L1I].line_size > config[CACHE_L1D].line_size
+               ? config[CACHE_L1I].line_size : config[CACHE_L1D].line_size)
+            : config[CACHE_L2].line_size;
+        int upper_min = (level == CACHE_L2)
+            ? (config[CACHE_L1I].line_size < config[CACHE_L1D].line_size
+               ? config[CACHE_L1I].line_size : config[CACHE_L1D].line_size)
+            : config[CACHE_L2].line_size;
 
-int time_stamp = 0;
+        if (config[level].line_size < upper_max) {
+            fprintf(stderr, "%s: line size must be >= the levels above it\n", level_names[level]);
+            return -1;
+        }
+        if (config[level].inclusion == INCL_EXCLUSIVE &&
+            (config[level].line_size != upper_max || upper_min != upper_max)) {
+            fprintf(stderr, "%s: exclusive policy requires equal line sizes\n", level_names[level]);
+            return -1;
+        }
+    }
+    return 0;
+}
 
 void init_cache() {
-    for (int i = 0; i < CACHE_SET_SIZE; i++) {
-        for (int j = 0; j < CACHE_ASSOC; j++) {
-            instruction_cache.sets[i].lines[j].tag = 0;
-            instruction_cache.sets[i].lines[j].valid = 0;
-            instruction_cache.sets[i].lines[j].dirty = 0;
-            instruction_cache.sets[i].lines[j].lru = 0;
-            instruction_cache.sets[i].lines[j].accessed = 0;
+    if (sim->cache == NULL) {
+        sim->cache = calloc(1, sizeof(struct CacheHierarchy));
+        if (sim->cache == NULL) {
+            fprintf(stderr, "cache: out of memory\n");
+            exit(1);
         }
     }
-    
-    // 데이터 캐시 초기화
-    for (int i = 0; i < CACHE_SET_SIZE; i++) {
-        for (int j = 0; j < CACHE_ASSOC; j++) {
-            data_cache.sets[i].lines[j].tag = 0;
-            data_cache.sets[i].lines[j].valid = 0;
-            data_cache.sets[i].lines[j].dirty = 0;
-            data_cache.sets[i].lines[j].lru = 0;
-            data_cache.sets[i].lines[j].accessed = 0;
+
+    for (int level = 0; level < CACHE_NUM_LEVELS; level++) {
+        if (level_enabled(level)) {
+            init_level(&sim->cache->levels[level], level);
         }
     }
-    
-    // 통계 초기화
-    inst_cache_hit = 0;
-    inst_cache_access = 0;
-    inst_cold_miss = 0;
-    inst_conflict_miss = 0;
-    
-    data_cache_hit = 0;
-    data_cache_access = 0;
-    data_cold_miss = 0;
-    data_conflict_miss = 0;
-    
-    time_stamp = 0;
-    
-    printf("Cache initialized: %d sets, %d-way associative, %d bytes per line\n", 
-           CACHE_SET_SIZE, CACHE_ASSOC, CACHE_LINE_SIZE);
+
+    // 계층 연결: L1 I/D -> L2 -> L3 -> memory
+    CacheLevel* below_l1 = level_enabled(CACHE_L2) ? &sim->cache->levels[CACHE_L2] : NULL;
+    instruction_cache.next = below_l1;
+    data_cache.next = below_l1;
+
+    if (level_enabled(CACHE_L2)) {
+        sim->cache->levels[CACHE_L2].upper[0] = &instruction_cache;
+        sim->cache->levels[CACHE_L2].upper[1] = &data_cache;
+        sim->cache->levels[CACHE_L2].num_upper = 2;
+        sim->cache->levels[CACHE_L2].next = level_enabled(CACHE_L3) ? &sim->cache->levels[CACHE_L3] : NULL;
+    }
+    if (level_enabled(CACHE_L3)) {
+        sim->cache->levels[CACHE_L3].upper[0] = &sim->cache->levels[CACHE_L2];
+        sim->cache->levels[CACHE_L3].num_upper = 1;
+    }
+
+    sim->cache->clock = 0;
+    init_prefetchers();
+    reset_cache_statistics();
+
+    TRACE_INFO("Cache initialized: %d sets, %d-way associative, %d bytes per line\n",
+           data_cache.config.sets, data_cache.config.assoc, data_cache.config.line_size);
+}
+
+void free_cache(void) {
+    free_prefetchers();
+    if (sim->cache == NULL) {
+        return;
+    }
+    for (int level = 0; level < CACHE_NUM_LEVELS; level++) {
+        free_level(&sim->cache->levels[level]);
+    }
+    free(sim->cache);
+    sim->cache = NULL;
+}
+
+// 스윕 보고서용 레벨별 access/hit
+void get_cache_level_summary(int level, CacheLevelSummary* out) {
+    out->access = sim->cache->levels[level].stats.access;
+    out->hit = sim->cache->levels[level].stats.hit;
+}
+
+// 통계만 초기화 (캐시 내용은 유지)
+void reset_cache_statistics(void) {
+    for (int level = 0; level < CACHE_NUM_LEVELS; level++) {
+        memset(&sim->cache->levels[level].stats, 0, sizeof(sim->cache->levels[level].stats));
+    }
 }
 
-// LRU 업데이트 함수
-void update_lru(CacheSet* set, int accessed_index) {
-    int old_lru = set->lines[accessed_index].lru;
+// 세트의 태그 슬롯 group[0..TAG_LANES)에서 tag와 같은 것의 비트마스크
+static inline unsigned tag_match_mask(const uint32_t* group, uint32_t tag) {
+#if TAG_LANES == 8
+    __m256i eq = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)group), _mm256_set1_epi32((int)tag));
+    return (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(eq));
+#elif TAG_LANES == 4
+    __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)group), _mm_set1_epi32((int)tag));
+    return (unsigned)_mm_movemask_ps(_mm_castsi128_ps(eq));
+#else
+    return group[0] == tag;
+#endif
+}
+
+// 세트에서 tag를 가진 첫 way, 없으면 -1. CACHE_INVALID_TAG로 찾으면 첫 빈 way.
+// 64 way씩 모든 묶음의 비교 결과를 한 마스크로 모은 뒤 한 번만 분기한다
+// (히트 위치에 따른 분기 예측 실패가 없음). 패딩 슬롯은 마스크에서 뺀다.
+static inline int find_way(const CacheLevel* c, uint32_t set, uint32_t tag) {
+    const uint32_t* tags = set_tags(c, set);
+    int assoc = c->config.assoc;
 
-    for (int i = 0; i < CACHE_ASSOC; i++) {
-        if (set->lines[i].lru < old_lru) {
-            set->lines[i].lru++;
+    for (int base = 0; base < assoc; base += 64) {
+        int ways = (assoc - base < 64) ? assoc - base : 64;
+        uint64_t mask = 0;
+        for (int i = 0; i < ways; i += TAG_LANES) {
+            mask |= (uint64_t)tag_match_mask(tags + base + i, tag) << i;
+        }
+        if (ways < 64) {
+            mask &= (1ull << ways) - 1;
+        }
+        if (mask != 0) {
+            return base + __builtin_ctzll(mask);
         }
     }
-    set->lines[accessed_index].lru = 0;
+    return -1;
+}
+
+static inline bool line_valid(const CacheLevel* c, uint32_t set, int way) {
+    return set_tags(c, set)[way] != CACHE_INVALID_TAG;
 }
 
-// LRU victim 찾기 함수 
-int find_lru_index(CacheSet* set) {
-    int max_lru = -1;
-    int lru_index = 0;
+// ---------------------------------------------------------------------------
+// 교체 정책. 세트마다 repl_stride 바이트 하나씩을 정책에 따라 다르게 쓴다.
+//   LRU, FIFO   way별 순서, 항상 0..assoc-1의 순열 (0 = 최신).
+//               LRU는 접근할 때마다, FIFO는 채울 때만 갱신
+//   PLRU        트리 PLRU. 노드 n(1..assoc-1)의 비트가 덜 최근인 쪽 자식을 가리킨다
+//               (왼쪽 2n, 오른쪽 2n+1, 잎 assoc+way). assoc는 2의 거듭제곱
+//   BIT_PLRU    way별 MRU 비트. 모두 1이 되면 방금 쓴 way만 남기고 지운다
+//   *RRIP       way별 RRPV. 히트면 0, 교체는 RRPV_MAX인 way
+//   RANDOM      쓰지 않음
+// 패딩 슬롯은 0xFF라서 어떤 정책의 검색에도 걸리지 않는다.
+// ---------------------------------------------------------------------------
 
-    for (int i = 0; i < CACHE_ASSOC; i++) {
-        if (set->lines[i].lru > max_lru) {
-            max_lru = set->lines[i].lru;
-            lru_index = i;
+static void init_repl(CacheLevel* c, uint32_t set) {
+    uint8_t* r = set_repl(c, set);
+    for (int j = 0; j < c->config.assoc; j++) {
+        switch (c->config.replacement) {
+            case REPL_LRU:
+            case REPL_FIFO:
+                r[j] = (uint8_t)j;
+                break;
+            case REPL_SRRIP:
+            case REPL_BRRIP:
+            case REPL_DRRIP:
+                r[j] = RRPV_MAX;
+                break;
+            default:
+                r[j] = 0;
+                break;
         }
     }
-    return lru_index;
 }
 
-// 캐시 히트 체크 함수 
-int cache_check_hit(Cache* cache, uint32_t address, uint32_t* set_index, uint32_t* tag, double* hit_count, double* access_count) {
-    (*access_count)++;
-    *tag = address / (CACHE_SET_SIZE * CACHE_LINE_SIZE);
-    *set_index = (address / CACHE_LINE_SIZE) % CACHE_SET_SIZE;
+static uint32_t next_random(CacheLevel* c) {
+    c->rand_state ^= c->rand_state << 13;
+    c->rand_state ^= c->rand_state >> 17;
+    c->rand_state ^= c->rand_state << 5;
+    return c->rand_state;
+}
 
-    CacheSet* set = &cache->sets[*set_index];
-    int found_invalid_line = 0;
+// 값이 value인 첫 way, 없으면 -1
+static int find_repl_value(const CacheLevel* c, uint32_t set, uint8_t value) {
+    const uint8_t* r = set_repl(c, set);
 
-    for (int i = 0; i < CACHE_ASSOC; i++) {
-        if (set->lines[i].valid && set->lines[i].tag == *tag) {
-            (*hit_count)++;
-            return i; // hit, 반환값은 히트된 라인의 인덱스
+#if REPL_LANES == 16
+    __m128i target = _mm_set1_epi8((char)value);
+    for (int i = 0; i < c->config.assoc; i += REPL_LANES) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(r + i));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(a, target));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
         }
-        if (!set->lines[i].valid) {
-            found_invalid_line = 1;
+    }
+#else
+    for (int i = 0; i < c->config.assoc; i++) {
+        if (r[i] == value) {
+            return i;
         }
     }
+#endif
+    return -1;
+}
 
-    // miss인 경우 - cold miss 체크
-    if (found_invalid_line) {
-        for (int i = 0; i < CACHE_ASSOC; i++) {
-            if (!set->lines[i].accessed) {
-                set->lines[i].accessed = 1;
-                return -1; // cold miss
-            }
+// way를 가장 최근으로 옮긴다 (더 최근이던 라인들은 한 칸씩 밀림)
+static void promote(CacheLevel* c, uint32_t set, int way) {
+    uint8_t* r = set_repl(c, set);
+    uint8_t old = r[way];
+
+#if REPL_LANES == 16
+    __m128i o = _mm_set1_epi8((char)old);
+    for (int i = 0; i < c->config.assoc; i += REPL_LANES) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(r + i));
+        // 부호 없는 a < old: min(a, old) == a 이고 a != old
+        __m128i le = _mm_cmpeq_epi8(_mm_min_epu8(a, o), a);
+        __m128i lt = _mm_andnot_si128(_mm_cmpeq_epi8(a, o), le);
+        _mm_storeu_si128((__m128i*)(r + i), _mm_sub_epi8(a, lt));
+    }
+#else
+    for (int i = 0; i < c->config.assoc; i++) {
+        r[i] += (r[i] < old);
+    }
+#endif
+    r[way] = 0;
+}
+
+// 루트에서 way까지 내려가며 각 노드가 반대쪽 자식을 가리키게 한다
+static void plru_touch(CacheLevel* c, uint32_t set, int way) {
+    uint8_t* r = set_repl(c, set);
+    int node = 1;
+    for (int bit = __builtin_ctz((unsigned)c->config.assoc); bit-- > 0; ) {
+        int right = (way >> bit) & 1;
+        r[node] = (uint8_t)!right;
+        node = node * 2 + right;
+    }
+}
+
+static int plru_victim(const CacheLevel* c, uint32_t set) {
+    const uint8_t* r = set_repl(c, set);
+    int node = 1;
+    while (node < c->config.assoc) {
+        node = node * 2 + r[node];
+    }
+    return node - c->config.assoc;
+}
+
+static void bit_plru_touch(CacheLevel* c, uint32_t set, int way) {
+    uint8_t* r = set_repl(c, set);
+    r[way] = 1;
+    if (find_repl_value(c, set, 0) < 0) {
+        for (int i = 0; i < c->config.assoc; i++) {
+            r[i] = (i == way);
+        }
+    }
+}
+
+// RRPV_MAX인 way가 나올 때까지 세트 전체를 늙힌다 (패딩 0xFF는 포화 덧셈으로 그대로)
+static int rrip_victim(CacheLevel* c, uint32_t set) {
+    uint8_t* r = set_repl(c, set);
+    int way;
+    while ((way = find_repl_value(c, set, RRPV_MAX)) < 0) {
+#if REPL_LANES == 16
+        for (int i = 0; i < c->config.assoc; i += REPL_LANES) {
+            __m128i a = _mm_loadu_si128((const __m128i*)(r + i));
+            _mm_storeu_si128((__m128i*)(r + i), _mm_adds_epu8(a, _mm_set1_epi8(1)));
         }
+#else
+        for (int i = 0; i < c->config.assoc; i++) {
+            r[i]++;
+        }
+#endif
+    }
+    return way;
+}
+
+// DRRIP에서 세트의 역할: REPL_SRRIP/REPL_BRRIP 리더, 나머지는 REPL_DRRIP(팔로워)
+static ReplacementPolicy duel_role(const CacheLevel* c, uint32_t set) {
+    int period = (c->config.sets < DUEL_PERIOD) ? c->config.sets : DUEL_PERIOD;
+    if (period < 2) {
+        return REPL_DRRIP;
+    }
+    uint32_t k = set % (uint32_t)period;
+    if (k == 0) return REPL_SRRIP;
+    if (k == (uint32_t)period - 1) return REPL_BRRIP;
+    return REPL_DRRIP;
+}
+
+// 리더 세트의 미스로 PSEL을 움직인다
+static void duel_train(CacheLevel* c, uint32_t set) {
+    ReplacementPolicy role = duel_role(c, set);
+    if (role == REPL_SRRIP && c->psel < PSEL_MAX) {
+        c->psel++;
+    } else if (role == REPL_BRRIP && c->psel > 0) {
+        c->psel--;
     }
+}
 
-    return -1; // conflict miss
+static uint8_t rrip_insert_value(CacheLevel* c, uint32_t set) {
+    ReplacementPolicy p = c->config.replacement;
+    if (p == REPL_DRRIP) {
+        p = duel_role(c, set);
+        if (p == REPL_DRRIP) {
+            p = (c->psel > (PSEL_MAX + 1) / 2) ? REPL_BRRIP : REPL_SRRIP;
+        }
+    }
+    if (p == REPL_BRRIP && next_random(c) % BRRIP_LONG_ODDS != 0) {
+        return RRPV_MAX;
+    }
+    return RRPV_MAX - 1;
 }
 
-// 캐시 미스 처리 함수 
-int cache_handle_miss(Cache* cache, uint32_t address, uint32_t set_index, uint32_t tag, int* cold_miss, int* conflict_miss) {
-    uint32_t block_offset = address % CACHE_LINE_SIZE;
-    CacheSet* set = &cache->sets[set_index];
+// 히트했을 때
+static void touch_line(CacheLevel* c, uint32_t set, int way) {
+    switch (c->config.replacement) {
+        case REPL_LRU:
+            promote(c, set, way);
+            break;
+        case REPL_PLRU:
+            plru_touch(c, set, way);
+            break;
+        case REPL_BIT_PLRU:
+            bit_plru_touch(c, set, way);
+            break;
+        case REPL_SRRIP:
+        case REPL_BRRIP:
+        case REPL_DRRIP:
+            set_repl(c, set)[way] = 0;
+            break;
+        default:
+            break;
+    }
+}
 
-    // cold miss인지 확인
-    bool is_cold_miss = false;
-    for (int i = 0; i < CACHE_ASSOC; i++) {
-        if (!set->lines[i].valid) {
-            is_cold_miss = true;
+// 새 라인을 채웠을 때
+static void fill_update(CacheLevel* c, uint32_t set, int way) {
+    switch (c->config.replacement) {
+        case REPL_LRU:
+        case REPL_FIFO:
+            promote(c, set, way);
+            break;
+        case REPL_SRRIP:
+        case REPL_BRRIP:
+        case REPL_DRRIP:
+            set_repl(c, set)[way] = rrip_insert_value(c, set);
             break;
+        default:
+            touch_line(c, set, way);
+            break;
+    }
+}
+
+// 교체할 라인 선택: 빈 라인이 있으면 먼저 사용
+static int choose_victim(CacheLevel* c, uint32_t set) {
+    int empty = find_way(c, set, CACHE_INVALID_TAG);
+    if (empty >= 0) {
+        return empty;
+    }
+
+    switch (c->config.replacement) {
+        case REPL_RANDOM:
+            return (int)(next_random(c) % (uint32_t)c->config.assoc);
+        case REPL_PLRU:
+            return plru_victim(c, set);
+        case REPL_BIT_PLRU:
+            return find_repl_value(c, set, 0);
+        case REPL_SRRIP:
+        case REPL_BRRIP:
+        case REPL_DRRIP:
+            return rrip_victim(c, set);
+        case REPL_FIFO:
+        case REPL_LRU:
+        default:
+            // 순열이므로 값이 assoc-1인 way가 가장 오래된 라인
+            return find_repl_value(c, set, (uint8_t)(c->config.assoc - 1));
+    }
+}
+
+// 라인 크기는 항상 2의 거듭제곱, 세트 수도 그러면 나눗셈 없이 자른다
+static inline void split_address(const CacheLevel* c, uint32_t address, uint32_t* set, uint32_t* tag) {
+    uint32_t block = address >> c->offset_bits;
+    if (c->set_bits >= 0) {
+        *set = block & ((1u << c->set_bits) - 1);
+        *tag = block >> c->set_bits;
+    } else {
+        *set = block % (uint32_t)c->config.sets;
+        *tag = block / (uint32_t)c->config.sets;
+    }
+}
+
+static inline uint32_t line_offset(const CacheLevel* c, uint32_t address) {
+    return address & (uint32_t)(c->config.line_size - 1);
+}
+
+// cls는 이 접근을 섀도에 넣을 때 받은 분류
+static void count_miss(CacheLevel* c, uint32_t set, MissClass cls) {
+    switch (cls) {
+        case MISS_COMPULSORY: c->stats.compulsory_miss++; break;
+        case MISS_CAPACITY: c->stats.capacity_miss++; break;
+        case MISS_CONFLICT: c->stats.conflict_miss++; break;
+    }
+    if (c->config.replacement == REPL_DRRIP) {
+        duel_train(c, set);
+    }
+}
+
+// 라인 안 [offset, offset+size) 바이트가 걸친 워드들을 사용했다고 표시
+static void mark_used(CacheLevel* c, uint32_t set, int way, uint32_t offset, int size) {
+    int first = (int)(offset / 4);
+    int count = (int)((offset + size + 3) / 4) - first;
+    if (first + count > c->config.line_size / 4) {
+        count = c->config.line_size / 4 - first;      // 라인 끝을 넘는 비정렬 접근
+    }
+    uint64_t bits = (count >= 64) ? ~0ull : ((1ull << count) - 1);
+    c->used[line_index(c, set, way)] |= bits << first;
+}
+
+static int line_use_bucket(int used, int words) {
+    if (used == 0) return 0;
+    if (used == words) return LINE_USE_BUCKETS - 1;
+    if (used * 4 <= words) return 1;
+    if (used * 2 <= words) return 2;
+    if (used * 4 <= words * 3) return 3;
+    return 4;
+}
+
+// 라인을 비운다. 떠나는 라인의 워드 사용량은 공간 지역성 통계에 반영.
+static void invalidate_line(CacheLevel* c, uint32_t set, int way) {
+    size_t idx = line_index(c, set, way);
+    int used = __builtin_popcountll(c->used[idx]);
+
+    c->stats.retired_lines++;
+    c->stats.retired_words_used += (uint64_t)used;
+    c->stats.line_use_hist[line_use_bucket(used, c->config.line_size / 4)]++;
+
+    if (c->pf_ready != NULL && c->pf_ready[idx] != 0) {
+        c->stats.pf_unused++;
+        c->pf_ready[idx] = 0;
+    }
+
+    set_tags(c, set)[way] = CACHE_INVALID_TAG;
+    c->dirty[idx] = 0;
+    c->used[idx] = 0;
+}
+
+// 빈 way에 새 라인을 기록한다
+static void install_line(CacheLevel* c, uint32_t set, int way, uint32_t tag, int dirty) {
+    size_t idx = line_index(c, set, way);
+    set_tags(c, set)[way] = tag;
+    c->dirty[idx] = (uint8_t)dirty;
+    c->used[idx] = 0;
+    fill_update(c, set, way);
+}
+
+static void fetch_block(CacheLevel* c, uint32_t address, uint8_t* out, int size, int* dirty_out);
+static void writeback_block(CacheLevel* c, uint32_t address, const uint8_t* in, int size, int dirty);
+
+static inline uint8_t* victim_line(const CacheLevel* c, int slot) {
+    return &c->victim->data[(size_t)slot * c->config.line_size];
+}
+
+// block이 든 victim cache 칸, 없으면 -1
+static int victim_find(const CacheLevel* c, uint32_t block) {
+    const VictimCache* v = c->victim;
+    for (int i = 0; i < v->entries; i++) {
+        if (v->blocks[i] == block) {
+            return i;
         }
     }
+    return -1;
+}
 
-    if (is_cold_miss) {
-        (*cold_miss)++;
+// L1에 없더라도 victim cache에 있으면 그 레벨에 있는 것으로 본다
+static bool level_holds(const CacheLevel* c, uint32_t set, uint32_t tag, uint32_t block) {
+    return find_way(c, set, tag) >= 0 || (c->victim != NULL && victim_find(c, block) >= 0);
+}
+
+// inclusive 하위 레벨에서 블록이 빠질 때 상위 캐시의 사본을 지운다.
+// 상위의 dirty 데이터는 더 최신이므로 victim 데이터에 덮어쓴다 (아래 레벨부터).
+static void back_invalidate(CacheLevel* lower, CacheLevel* u, uint32_t base, int size,
+                            uint8_t* victim_data, int* victim_dirty) {
+    for (uint32_t a = base; a < base + (uint32_t)size; a += (uint32_t)u->config.line_size) {
+        uint32_t set, tag;
+        split_address(u, a, &set, &tag);
+        int way = find_way(u, set, tag);
+        if (way >= 0) {
+            if (u->dirty[line_index(u, set, way)]) {
+                memcpy(victim_data + (a - base), data_at(u, set, way), u->config.line_size);
+                *victim_dirty = 1;
+            }
+            invalidate_line(u, set, way);
+            lower->stats.back_invalidations++;
+        } else if (u->victim != NULL && (way = victim_find(u, a)) >= 0) {
+            if (u->victim->dirty[way]) {
+                memcpy(victim_data + (a - base), victim_line(u, way), u->config.line_size);
+                *victim_dirty = 1;
+            }
+            u->victim->blocks[way] = CACHE_INVALID_TAG;
+            u->victim->dirty[way] = 0;
+            lower->stats.back_invalidations++;
+        }
+    }
+    for (int i = 0; i < u->num_upper; i++) {
+        back_invalidate(lower, u->upper[i], base, size, victim_data, victim_dirty);
+    }
+}
+
+// 빠지는 블록을 하위로 보낸다: dirty면 write-back, 하위가 exclusive면 clean victim도 내려보냄
+static void release_block(CacheLevel* c, uint32_t base, const uint8_t* d, int dirty) {
+    if (dirty) {
+        c->stats.writebacks++;
+        writeback_block(c->next, base, d, c->config.line_size, 1);
+    } else if (c->next != NULL && c->next->config.inclusion == INCL_EXCLUSIVE) {
+        writeback_block(c->next, base, d, c->config.line_size, 0);
+    }
+}
+
+// L1에서 빠진 블록을 victim cache에 넣는다. 가득 찼으면 가장 오래된 칸을 하위로 내보낸다.
+static void victim_insert(CacheLevel* c, uint32_t base, const uint8_t* d, int dirty) {
+    VictimCache* v = c->victim;
+    int slot = 0;
+    for (int i = 0; i < v->entries; i++) {
+        if (v->blocks[i] == CACHE_INVALID_TAG) {
+            slot = i;
+            break;
+        }
+        if (v->stamp[i] < v->stamp[slot]) {
+            slot = i;
+        }
+    }
+    if (v->blocks[slot] != CACHE_INVALID_TAG) {
+        release_block(c, v->blocks[slot], victim_line(c, slot), v->dirty[slot]);
+    }
+    v->blocks[slot] = base;
+    v->dirty[slot] = (uint8_t)dirty;
+    v->stamp[slot] = ++v->clock;
+    memcpy(victim_line(c, slot), d, c->config.line_size);
+}
+
+// 라인을 비운다 (back-invalidation으로 받은 상위의 dirty 데이터까지 포함해 내려보냄)
+static void evict_line(CacheLevel* c, uint32_t set, int way) {
+    if (!line_valid(c, set, way)) {
+        return;
+    }
+
+    uint32_t base = block_address(c, set, set_tags(c, set)[way]);
+    uint8_t* d = data_at(c, set, way);
+    int dirty = c->dirty[line_index(c, set, way)];
+
+    if (c->config.inclusion == INCL_INCLUSIVE) {
+        for (int i = 0; i < c->num_upper; i++) {
+            back_invalidate(c, c->upper[i], base, c->config.line_size, d, &dirty);
+        }
+    }
+
+    if (c->victim != NULL) {
+        victim_insert(c, base, d, dirty);
     } else {
-        (*conflict_miss)++;
+        release_block(c, base, d, dirty);
+    }
+    invalidate_line(c, set, way);
+}
+
+// way를 비우고 하위 레벨에서 라인 전체를 채운다
+static void fill_line(CacheLevel* c, uint32_t set, int way, uint32_t tag, uint32_t address) {
+    evict_line(c, set, way);
+
+    uint32_t base = address - line_offset(c, address);
+    int dirty = 0;
+    fetch_block(c->next, base, data_at(c, set, way), c->config.line_size, &dirty);
+
+    install_line(c, set, way, tag, dirty);
+}
+
+static int allocate_line(CacheLevel* c, uint32_t set, uint32_t tag, uint32_t address) {
+    int way = choose_victim(c, set);
+    fill_line(c, set, way, tag, address);
+    return way;
+}
+
+// 미스 난 블록이 victim cache에 있으면 L1의 victim 라인과 맞바꾼다. 들어간 way, 없으면 -1.
+static int victim_swap(CacheLevel* c, uint32_t set, uint32_t tag, uint32_t address) {
+    VictimCache* v = c->victim;
+    uint32_t base = address - line_offset(c, address);
+    int slot = victim_find(c, base);
+    if (slot < 0) {
+        return -1;
+    }
+
+    uint8_t line[CACHE_MAX_LINE_SIZE];
+    int dirty = v->dirty[slot];
+    memcpy(line, victim_line(c, slot), c->config.line_size);
+    v->blocks[slot] = CACHE_INVALID_TAG;
+    v->dirty[slot] = 0;
+
+    // 비운 칸이 있으니 L1 victim은 하위로 내려가지 않고 그 칸에 들어간다
+    int way = choose_victim(c, set);
+    evict_line(c, set, way);
+    memcpy(data_at(c, set, way), line, c->config.line_size);
+    install_line(c, set, way, tag, dirty);
+    return way;
+}
+
+// 하위 레벨(L2/L3/메모리)에서 상위 라인 크기만큼 읽는다
+static void fetch_block(CacheLevel* c, uint32_t address, uint8_t* out, int size, int* dirty_out) {
+    if (c == NULL) {
+        mem_read_block(address, out, size);
+        return;
     }
 
-    // LRU 알고리즘을 사용하여 교체할 라인을 선택
-    int lru_index = find_lru_index(set);
+    uint32_t set, tag;
+    split_address(c, address, &set, &tag);
+    uint32_t offset = line_offset(c, address);
+
+    c->stats.access++;
+    MissClass cls = shadow_access(c->shadow, address);
+    int way = find_way(c, set, tag);
 
-    // 선택된 캐시 라인이 더티 상태인 경우, 데이터를 메모리에 씀
-    if (set->lines[lru_index].dirty) {
-        uint32_t write_back_address = (set->lines[lru_index].tag * (CACHE_SET_SIZE * CACHE_LINE_SIZE)) + (set_index * CACHE_LINE_SIZE);
-        for (int i = 0; i < CACHE_LINE_SIZE; i++) {
-            memory[write_back_address + i] = set->lines[lru_index].data[i];
+    if (way >= 0) {
+        c->stats.hit++;
+        memcpy(out, data_at(c, set, way) + offset, size);
+        mark_used(c, set, way, offset, size);
+        if (c->config.inclusion == INCL_EXCLUSIVE) {
+            // 상위로 옮기고 여기서는 제거 (dirty 상태도 함께 이동)
+            if (c->dirty[line_index(c, set, way)]) {
+                *dirty_out = 1;
+            }
+            invalidate_line(c, set, way);
+        } else {
+            touch_line(c, set, way);
         }
+        return;
     }
 
-    // 메모리에서 데이터를 읽어와 캐시에 저장
-    uint32_t new_address = address - block_offset;
-    for (int i = 0; i < CACHE_LINE_SIZE; i++) {
-        set->lines[lru_index].data[i] = memory[new_address + i];
+    count_miss(c, set, cls);
+
+    if (c->config.inclusion == INCL_EXCLUSIVE) {
+        // exclusive 레벨은 miss 시 채우지 않고 상위 victim만 받는다
+        fetch_block(c->next, address, out, size, dirty_out);
+        return;
     }
-    set->lines[lru_index].tag = tag;
-    set->lines[lru_index].valid = 1;
-    set->lines[lru_index].dirty = 0;
 
-    // LRU 업데이트
-    update_lru(set, lru_index);
-    return lru_index;
+    way = allocate_line(c, set, tag, address);
+    memcpy(out, data_at(c, set, way) + offset, size);
+    mark_used(c, set, way, offset, size);
 }
 
-// 명령어 페치 함수
-uint32_t cache_read_instruction(uint32_t address) {
-    uint32_t temp = 0;
-    uint32_t set_index, tag;
+// 상위 레벨에서 내려온 라인을 받는다
+static void writeback_block(CacheLevel* c, uint32_t address, const uint8_t* in, int size, int dirty) {
+    if (c == NULL) {
+        if (dirty) {
+            mem_write_block(address, in, size);
+        }
+        return;
+    }
 
-    // 캐시 히트 여부 확인
-    int hit_index = cache_check_hit(&instruction_cache, address, &set_index, &tag, &inst_cache_hit, &inst_cache_access);
+    uint32_t set, tag;
+    split_address(c, address, &set, &tag);
+    uint32_t offset = line_offset(c, address);
+    int way = find_way(c, set, tag);
 
-    if (hit_index != -1) { // 캐시 히트
-        CacheSet* set = &instruction_cache.sets[set_index];
-        CacheLine* line = &set->lines[hit_index];
+    if (way >= 0) {
+        memcpy(data_at(c, set, way) + offset, in, size);
+        mark_used(c, set, way, offset, size);
+        if (dirty) {
+            c->dirty[line_index(c, set, way)] = 1;
+        }
+        touch_line(c, set, way);
+        return;
+    }
+
+    if (c->config.inclusion == INCL_EXCLUSIVE) {
+        // victim 삽입 (라인 크기가 같으므로 채울 필요 없음)
+        way = choose_victim(c, set);
+        evict_line(c, set, way);
+        memcpy(data_at(c, set, way), in, size);
+        install_line(c, set, way, tag, dirty);
+        return;
+    }
+
+    if (!dirty) {
+        return;
+    }
+
+    // write-allocate
+    way = allocate_line(c, set, tag, address);
+    memcpy(data_at(c, set, way) + offset, in, size);
+    mark_used(c, set, way, offset, size);
+    c->dirty[line_index(c, set, way)] = 1;
+}
+
+// ---------------------------------------------------------------------------
+// 프리페치 (L1). 프리페치는 demand 접근 통계(access/hit/miss)에 넣지 않는다.
+// ---------------------------------------------------------------------------
+
+static inline uint32_t filter_slot(const CacheLevel* c, uint32_t block) {
+    return (block >> c->offset_bits) & (PF_FILTER_ENTRIES - 1);
+}
 
-        // 캐시에서 명령어를 읽어옴 (리틀엔디안)
-        for (int i = 0; i < 4; i++) {
-            temp = temp << 8;
-            temp |= line->data[3 - i];
+// demand 미스가 프리페치에 밀려난 블록이면 오염으로 센다
+static void check_pollution(CacheLevel* c, uint32_t address) {
+    uint32_t block = address - line_offset(c, address);
+    uint32_t slot = filter_slot(c, block);
+    if (c->pf_filter[slot] == (block >> c->offset_bits) + 1) {
+        c->stats.pf_polluting++;
+        c->pf_filter[slot] = 0;
+    }
+}
+
+// 프리페치한 블록을 처음 쓸 때. 완료 시각 전이면 늦은 프리페치이고 남은 시간만큼 기다린다.
+static void prefetch_used(CacheLevel* c, uint64_t ready) {
+    c->stats.pf_useful++;
+    if (sim->cache->clock < ready) {
+        c->stats.pf_late++;
+        sim->cache->miss_latency = (uint32_t)(ready - sim->cache->clock);
+    }
+}
+
+// 하위 레벨에서 address의 블록을 가져오는 데 걸리는 시간 (찾는 것만, 상태는 그대로)
+// --mem-latency 0(기본값)이면 미스 지연 모델 전체를 끈다: L2/L3 히트 지연도 더하지 않는다
+static uint64_t fill_latency(const CacheLevel* c, uint32_t address) {
+    uint64_t latency = 0;
+    if (sim->memory_latency == 0) {
+        return 0;
+    }
+    for (const CacheLevel* n = c->next; n != NULL; n = n->next) {
+        uint32_t set, tag;
+        latency += (uint64_t)n->config.latency;
+        split_address(n, address, &set, &tag);
+        if (find_way(n, set, tag) >= 0) {
+            return latency;
         }
+    }
+    return latency + (uint64_t)sim->memory_latency;
+}
+
+// address의 블록을 level 캐시에 채운다 (이미 있으면 아무것도 안 함)
+void cache_prefetch(int level, uint32_t address) {
+    CacheLevel* c = &sim->cache->levels[level];
+    uint32_t set, tag;
+
+    if (address >= MEMORY_SIZE) {
+        return;
+    }
+    split_address(c, address, &set, &tag);
+    if (level_holds(c, set, tag, address - line_offset(c, address))) {
+        return;
+    }
 
-        update_lru(set, hit_index);
-        printf("[I-CACHE] Hit: PC=0x%08x, Set=%d, Tag=0x%x, Line=%d\n", 
-               address, set_index, tag, hit_index);
+    uint64_t ready = sim->cache->clock + fill_latency(c, address);
+    int way = choose_victim(c, set);
+    if (line_valid(c, set, way)) {
+        uint32_t victim = block_address(c, set, set_tags(c, set)[way]);
+        c->pf_filter[filter_slot(c, victim)] = (victim >> c->offset_bits) + 1;
     }
-    else { // 캐시 미스
-        int lru_index = cache_handle_miss(&instruction_cache, address, set_index, tag, &inst_cold_miss, &inst_conflict_miss);
-        CacheSet* set = &instruction_cache.sets[set_index];
-        CacheLine* line = &set->lines[lru_index];
+    fill_line(c, set, way, tag, address);
+
+    c->pf_ready[line_index(c, set, way)] = ready;
+    c->stats.pf_issued++;
+    TRACE((level == CACHE_L1I) ? TRACE_ICACHE : TRACE_DCACHE,
+          "[%s] Prefetch: Addr=0x%08x, Set=%d, Line=%d\n",
+          (level == CACHE_L1I) ? "I-CACHE" : "D-CACHE", address, set, way);
+}
+
+// 프리페처 버퍼(스트림 버퍼)로 블록을 읽어 온다. 이미 L1에 있으면 false.
+// exclusive 하위 레벨에서 dirty 라인을 받으면 바로 메모리에 써서 버퍼는 항상 clean.
+bool cache_prefetch_to_buffer(int level, uint32_t block, uint8_t* out, uint64_t* ready) {
+    CacheLevel* c = &sim->cache->levels[level];
+    uint32_t set, tag;
 
-        // 캐시에서 명령어 읽기
-        for (int i = 0; i < 4; i++) {
-            temp = temp << 8;
-            temp |= line->data[3 - i];
+    split_address(c, block, &set, &tag);
+    if (level_holds(c, set, tag, block)) {
+        return false;
+    }
+
+    *ready = sim->cache->clock + fill_latency(c, block);
+    int dirty = 0;
+    fetch_block(c->next, block, out, c->config.line_size, &dirty);
+    if (dirty) {
+        c->stats.writebacks++;
+        mem_write_block(block, out, c->config.line_size);
+    }
+    c->stats.pf_issued++;
+    return true;
+}
+
+// 쓰이지 않은 버퍼 블록을 버린다
+void cache_release_buffer(int level, uint32_t block, const uint8_t* data) {
+    CacheLevel* c = &sim->cache->levels[level];
+    c->stats.pf_unused++;
+    release_block(c, block, data, 0);
+}
+
+// 미스 난 블록이 프리페처 버퍼에 있으면 L1로 옮긴다. 옮긴 way, 없으면 -1.
+static int take_from_buffer(CacheLevel* c, uint32_t set, uint32_t tag, uint32_t address) {
+    uint8_t line[CACHE_MAX_LINE_SIZE];
+    uint64_t ready;
+    uint32_t block = address - line_offset(c, address);
+
+    if (!prefetch_take(c->level, block, line, &ready)) {
+        return -1;
+    }
+    int way = choose_victim(c, set);
+    evict_line(c, set, way);
+    memcpy(data_at(c, set, way), line, c->config.line_size);
+    install_line(c, set, way, tag, 0);
+    prefetch_used(c, ready);
+    return way;
+}
+
+// L1 접근: 히트면 라인 인덱스, 미스면 채운 뒤 라인 인덱스. *hit에 결과.
+// 프리페치한 블록을 처음 쓴 접근이면 *prefetched (스트림 버퍼에서 받은 것은 히트로 센다).
+static int l1_access(CacheLevel* c, uint32_t address, uint32_t* set_index, uint32_t* tag,
+                     bool* hit, bool* prefetched) {
+    split_address(c, address, set_index, tag);
+    c->stats.access++;
+    *prefetched = false;
+    sim->cache->miss_latency = 0;
+    MissClass cls = shadow_access(c->shadow, address);
+
+    int way = find_way(c, *set_index, *tag);
+    if (way >= 0) {
+        c->stats.hit++;
+        touch_line(c, *set_index, way);
+        *hit = true;
+        if (c->pf_ready != NULL) {
+            size_t idx = line_index(c, *set_index, way);
+            if (c->pf_ready[idx] != 0) {
+                prefetch_used(c, c->pf_ready[idx]);
+                c->pf_ready[idx] = 0;
+                *prefetched = true;
+            }
+        }
+    } else if (c->victim != NULL && (way = victim_swap(c, *set_index, *tag, address)) >= 0) {
+        count_miss(c, *set_index, cls);
+        c->stats.victim_hits++;
+        if (cls == MISS_CONFLICT) {
+            c->stats.victim_conflict_hits++;
         }
+        *hit = false;
+    } else if (c->pf_ready != NULL && (way = take_from_buffer(c, *set_index, *tag, address)) >= 0) {
+        c->stats.hit++;
+        *hit = true;
+        *prefetched = true;
+    } else {
+        count_miss(c, *set_index, cls);
+        if (c->pf_filter != NULL) {
+            check_pollution(c, address);
+        }
+        *hit = false;
+        sim->cache->miss_latency = (uint32_t)fill_latency(c, address);
+        way = allocate_line(c, *set_index, *tag, address);
+    }
+    mark_used(c, *set_index, way, line_offset(c, address), 4);
+    return way;
+}
+
+// 상태를 바꾸지 않고 address의 블록이 level에 있는지만 본다
+bool cache_contains(int level, uint32_t address) {
+    CacheLevel* c = &sim->cache->levels[level];
+    uint32_t set, tag;
+    if (c->tags == NULL) {
+        return false;
+    }
+    split_address(c, address, &set, &tag);
+    return level_holds(c, set, tag, address - line_offset(c, address));
+}
+
+uint32_t cache_miss_latency(void) {
+    return sim->cache->miss_latency;
+}
+
+int cache_hit_latency(int level) {
+    return sim->cache_config[level].latency;
+}
+
+// 파이프라인은 페치 수 대신 지금까지 지난 사이클 수를 프리페치 시각으로 쓴다
+void cache_set_clock(uint64_t cycles) {
+    sim->cache->clock = cycles;
+}
 
-        printf("[I-CACHE] Miss: PC=0x%08x, Set=%d, Tag=0x%x, Line=%d\n", 
-               address, set_index, tag, lru_index);
+const char* cache_tag_match_name(void) {
+#if TAG_LANES == 8
+    return "AVX2, 8 ways per compare";
+#elif TAG_LANES == 4
+    return "SSE2, 4 ways per compare";
+#else
+    return "scalar";
+#endif
+}
+
+// 명령어 페치 함수
+uint32_t cache_read_instruction(uint32_t address) {
+    uint32_t set_index, tag;
+    bool hit, prefetched;
+
+    sim->cache->clock++;
+
+    if (sim->cache_sweep_enabled) {
+        cache_sweep_access(SWEEP_STREAM_INST, address);
+    }
+
+    int way = l1_access(&instruction_cache, address, &set_index, &tag, &hit, &prefetched);
+    const uint8_t* d = data_at(&instruction_cache, set_index, way) +
+                       line_offset(&instruction_cache, address);
+
+    // 캐시에서 명령어를 읽어옴 (리틀엔디안)
+    uint32_t temp = 0;
+    for (int i = 0; i < 4; i++) {
+        temp = temp << 8;
+        temp |= d[3 - i];
     }
 
+    TRACE(TRACE_ICACHE, "[I-CACHE] %s: PC=0x%08x, Set=%d, Tag=0x%x, Line=%d\n",
+           hit ? "Hit" : "Miss", address, set_index, tag, way);
+
+    if (instruction_cache.pf_ready != NULL) {
+        prefetch_observe(CACHE_L1I, address, address, temp, hit, prefetched);
+    }
     return temp;
 }
 
-// 데이터 메모리 읽기 함수 
-uint32_t cache_read_data(uint32_t address) {
+// 데이터 메모리 읽기 함수
+uint32_t cache_read_data(uint32_t address, uint32_t pc) {
     uint32_t set_index, tag;
-    int hit_index = cache_check_hit(&data_cache, address, &set_index, &tag, &data_cache_hit, &data_cache_access);
+    bool hit, prefetched;
 
-    if (hit_index != -1) { // 캐시 히트
-        CacheSet* set = &data_cache.sets[set_index];
-        CacheLine* line = &set->lines[hit_index];
+    if (sim->cache_sweep_enabled) {
+        cache_sweep_access(SWEEP_STREAM_DATA, address);
+    }
 
-        // 캐시에서 데이터를 읽어옴
-        uint32_t data = 0;
-        for (int i = 0; i < 4; i++) {
-            data |= line->data[i] << (8 * (3 - i));
-        }
+    int way = l1_access(&data_cache, address, &set_index, &tag, &hit, &prefetched);
+    const uint8_t* d = data_at(&data_cache, set_index, way) +
+                       line_offset(&data_cache, address);
 
-        // LRU 업데이트
-        update_lru(set, hit_index);
-        printf("[D-CACHE] Read Hit: Addr=0x%08x, Set=%d, Tag=0x%x, Line=%d\n", 
-               address, set_index, tag, hit_index);
-        
-        return data;
+    // 캐시에서 데이터를 읽어옴 (빅엔디안)
+    uint32_t data = 0;
+    for (int i = 0; i < 4; i++) {
+        data |= (uint32_t)d[i] << (8 * (3 - i));
     }
-    else { // 캐시 미스
-        int lru_index = cache_handle_miss(&data_cache, address, set_index, tag, &data_cold_miss, &data_conflict_miss);
-        CacheSet* set = &data_cache.sets[set_index];
-        CacheLine* line = &set->lines[lru_index];
 
-        uint32_t data = 0;
-        for (int i = 0; i < 4; i++) {
-            data |= memory[address + i] << (8 * (3 - i));
-            line->data[i] = memory[address + i];
-        }
-        
-        printf("[D-CACHE] Read Miss: Addr=0x%08x, Set=%d, Tag=0x%x, Line=%d\n", 
-               address, set_index, tag, lru_index);
-               
-        return data;
+    TRACE(TRACE_DCACHE, "[D-CACHE] Read %s: Addr=0x%08x, Set=%d, Tag=0x%x, Line=%d\n",
+           hit ? "Hit" : "Miss", address, set_index, tag, way);
+
+    if (data_cache.pf_ready != NULL) {
+        prefetch_observe(CACHE_L1D, pc, address, 0, hit, prefetched);
     }
+    return data;
 }
 
-// 데이터 메모리 쓰기 함수 
-void cache_write_data(uint32_t address, uint32_t data) {
+// 데이터 메모리 쓰기 함수 (write-back, write-allocate)
+void cache_write_data(uint32_t address, uint32_t data, uint32_t pc) {
     uint32_t set_index, tag;
-    int hit_index = cache_check_hit(&data_cache, address, &set_index, &tag, &data_cache_hit, &data_cache_access);
+    bool hit, prefetched;
 
-    if (hit_index != -1) { // 캐시 히트
-        CacheSet* set = &data_cache.sets[set_index];
-        CacheLine* line = &set->lines[hit_index];
+    if (sim->cache_sweep_enabled) {
+        cache_sweep_access(SWEEP_STREAM_DATA, address);
+    }
 
-        // 데이터 저장
-        for (int i = 0; i < 4; i++) {
-            line->data[i] = (data >> (8 * (3 - i))) & 0xFF;
-        }
+    int way = l1_access(&data_cache, address, &set_index, &tag, &hit, &prefetched);
+    uint8_t* d = data_at(&data_cache, set_index, way) +
+                 line_offset(&data_cache, address);
+
+    for (int i = 0; i < 4; i++) {
+        d[i] = (data >> (8 * (3 - i))) & 0xFF;
+    }
+
+    // 해당 캐시 라인을 더티 상태로 표시
+    data_cache.dirty[line_index(&data_cache, set_index, way)] = 1;
 
-        // 해당 캐시 라인을 더티 상태로 표시
-        line->dirty = 1;
+    TRACE(TRACE_DCACHE, "[D-CACHE] Write %s: Addr=0x%08x, Set=%d, Tag=0x%x, Line=%d\n",
+           hit ? "Hit" : "Miss", address, set_index, tag, way);
 
-        // LRU 업데이트
-        update_lru(set, hit_index);
-        printf("[D-CACHE] Write Hit: Addr=0x%08x, Set=%d, Tag=0x%x, Line=%d\n", 
-               address, set_index, tag, hit_index);
+    if (data_cache.pf_ready != NULL) {
+        prefetch_observe(CACHE_L1D, pc, address, 0, hit, prefetched);
     }
-    else { // 캐시 미스
-        int lru_index = cache_handle_miss(&data_cache, address, set_index, tag, &data_cold_miss, &data_conflict_miss);
-        CacheSet* set = &data_cache.sets[set_index];
-        CacheLine* line = &set->lines[lru_index];
+}
 
-        // 새 데이터 저장
-        for (int i = 0; i < 4; i++) {
-            line->data[i] = (data >> (8 * (3 - i))) & 0xFF;
+// 아래 레벨부터 dirty 라인을 메모리에 write-back (상위 레벨이 더 최신).
+// clean이 false면 dirty 표시는 그대로 둔다 (메모리만 최신으로 맞춤)
+static void write_back_all(bool clean) {
+    for (int level = CACHE_NUM_LEVELS - 1; level >= 0; level--) {
+        if (!level_enabled(level)) {
+            continue;
+        }
+        CacheLevel* c = &sim->cache->levels[level];
+        for (int i = 0; i < c->config.sets; i++) {
+            for (int j = 0; j < c->config.assoc; j++) {
+                size_t idx = line_index(c, i, j);
+                if (c->dirty[idx] && line_valid(c, i, j)) {
+                    mem_write_block(block_address(c, i, set_tags(c, i)[j]), data_at(c, i, j), c->config.line_size);
+                    c->dirty[idx] = !clean;
+                }
+            }
+        }
+        VictimCache* v = c->victim;
+        for (int i = 0; v != NULL && i < v->entries; i++) {
+            if (v->dirty[i] && v->blocks[i] != CACHE_INVALID_TAG) {
+                mem_write_block(v->blocks[i], victim_line(c, i), c->config.line_size);
+                v->dirty[i] = !clean;
+            }
         }
-        line->dirty = 1;
-
-        printf("[D-CACHE] Write Miss: Addr=0x%08x, Set=%d, Tag=0x%x, Line=%d\n", 
-               address, set_index, tag, lru_index);
     }
 }
 
 // 캐시 플러시 함수
 void cache_flush(void) {
-    // 데이터 캐시의 모든 더티 라인을 메모리에 write-back
-    for (int i = 0; i < CACHE_SET_SIZE; i++) {
-        for (int j = 0; j < CACHE_ASSOC; j++) {
-            CacheLine* line = &data_cache.sets[i].lines[j];
-            if (line->dirty && line->valid) {
-                uint32_t line_address = (line->tag * CACHE_SET_SIZE + i) * CACHE_LINE_SIZE;
-                for (int k = 0; k < CACHE_LINE_SIZE; k++) {
-                    if (line_address + k < MEMORY_SIZE) {
-                        memory[line_address + k] = line->data[k];
-                    }
-                }
+    write_back_all(true);
+    TRACE_INFO("[CACHE] Flushed all dirty lines to memory\n");
+}
+
+// 체크포인트 저장 전: 게스트 메모리만으로 프로그램 상태가 완전하도록 dirty 데이터를 복사해 둔다.
+// 복원하는 쪽의 캐시 구성이 달라 캐시 내용을 버려도 결과가 맞는다.
+void cache_sync_memory(void) {
+    write_back_all(false);
+}
+
+// 체크포인트: 현재 구성으로 init_cache한 계층에 태그, 교체 정보, 데이터, 통계를 채운다
+void cache_checkpoint(Checkpoint* ck) {
+    ckpt_region(ck, &sim->cache->clock, sizeof(sim->cache->clock));
+    for (int level = 0; level < CACHE_NUM_LEVELS; level++) {
+        if (!level_enabled(level)) {
+            continue;
+        }
+        CacheLevel* c = &sim->cache->levels[level];
+        size_t lines = (size_t)c->config.sets * c->config.assoc;
+
+        ckpt_region(ck, c->tags, (size_t)c->config.sets * c->tag_stride * sizeof(uint32_t));
+        ckpt_region(ck, c->repl, (size_t)c->config.sets * c->repl_stride);
+        ckpt_region(ck, c->dirty, lines);
+        ckpt_region(ck, c->used, lines * sizeof(uint64_t));
+        ckpt_region(ck, c->data, lines * c->config.line_size);
+        if (c->pf_ready != NULL) {
+            ckpt_region(ck, c->pf_ready, lines * sizeof(uint64_t));
+            ckpt_region(ck, c->pf_filter, PF_FILTER_ENTRIES * sizeof(uint32_t));
+        }
+        VictimCache* v = c->victim;
+        if (v != NULL) {
+            ckpt_region(ck, v->blocks, sizeof(uint32_t) * v->entries);
+            ckpt_region(ck, v->dirty, v->entries);
+            ckpt_region(ck, v->stamp, sizeof(uint64_t) * v->entries);
+            ckpt_region(ck, v->data, (size_t)v->entries * c->config.line_size);
+            ckpt_region(ck, &v->clock, sizeof(v->clock));
+        }
+        shadow_checkpoint(c->shadow, ck);
+        ckpt_region(ck, &c->rand_state, sizeof(c->rand_state));
+        ckpt_region(ck, &c->psel, sizeof(c->psel));
+        ckpt_region(ck, &c->stats, sizeof(c->stats));
+    }
+}
+
+// 라인을 채운 뒤 실제로 접근한 워드 비율 (빠진 라인과 아직 남은 라인을 따로)
+static void print_line_use(CacheLevel* c) {
+    int words = c->config.line_size / 4;
+    uint64_t resident = 0;
+    uint64_t resident_used = 0;
+
+    for (int i = 0; i < c->config.sets; i++) {
+        for (int j = 0; j < c->config.assoc; j++) {
+            if (line_valid(c, i, j)) {
+                resident++;
+                resident_used += (uint64_t)__builtin_popcountll(c->used[line_index(c, i, j)]);
             }
         }
     }
-    printf("[CACHE] Flushed all dirty lines to memory\n");
+
+    const CacheStats* s = &c->stats;
+    if (s->retired_lines > 0) {
+        double avg = (double)s->retired_words_used / s->retired_lines;
+        printf("  %-37s: %.2f of %d (%.1f %%, %llu lines)\n", "words used per evicted line",
+               avg, words, 100.0 * avg / words, (unsigned long long)s->retired_lines);
+        printf("  %-37s: %llu / %llu / %llu / %llu / %llu / %llu\n", "  none/<=25%/<=50%/<=75%/<100%/all",
+               (unsigned long long)s->line_use_hist[0], (unsigned long long)s->line_use_hist[1],
+               (unsigned long long)s->line_use_hist[2], (unsigned long long)s->line_use_hist[3],
+               (unsigned long long)s->line_use_hist[4], (unsigned long long)s->line_use_hist[5]);
+    }
+    if (resident > 0) {
+        double avg = (double)resident_used / resident;
+        printf("  %-37s: %.2f of %d (%.1f %%, %llu lines)\n", "words used per resident line",
+               avg, words, 100.0 * avg / words, (unsigned long long)resident);
+    }
+}
+
+// 정확도 = 유용 / 발행, 커버리지 = 유용 / (유용 + 남은 미스)
+static void print_prefetch_statistics(CacheLevel* c) {
+    const CacheStats* s = &c->stats;
+    uint64_t misses = s->compulsory_miss + s->capacity_miss + s->conflict_miss;
+
+    printf("  prefetches issued                    : %llu\n", (unsigned long long)s->pf_issued);
+    printf("  useful prefetches                    : %llu", (unsigned long long)s->pf_useful);
+    if (s->pf_issued > 0) {
+        printf(" (accuracy %.1f %%, coverage %.1f %%)", 100.0 * s->pf_useful / s->pf_issued,
+               100.0 * s->pf_useful / (s->pf_useful + misses));
+    }
+    printf("\n");
+    printf("  late prefetches                      : %llu\n", (unsigned long long)s->pf_late);
+    printf("  unused prefetches evicted            : %llu\n", (unsigned long long)s->pf_unused);
+    printf("  polluting prefetches                 : %llu\n", (unsigned long long)s->pf_polluting);
+}
+
+static void print_level_statistics(CacheLevel* c) {
+    printf("  cache access                         : %llu\n", (unsigned long long)c->stats.access);
+    printf("  hit count                            : %llu\n", (unsigned long long)c->stats.hit);
+    printf("  compulsory miss                      : %llu\n", (unsigned long long)c->stats.compulsory_miss);
+    printf("  capacity miss                        : %llu\n", (unsigned long long)c->stats.capacity_miss);
+    printf("  conflict miss                        : %llu\n", (unsigned long long)c->stats.conflict_miss);
+    if (c->stats.access > 0) {
+        printf("  hit rate                             : %.3f %%\n", 100.0 * c->stats.hit / c->stats.access);
+    }
+    if (c->victim != NULL) {
+        uint64_t misses = c->stats.access - c->stats.hit;
+        printf("  victim cache hits                    : %llu", (unsigned long long)c->stats.victim_hits);
+        if (misses > 0) {
+            printf(" (%.1f %% of misses)", 100.0 * c->stats.victim_hits / misses);
+        }
+        printf("\n");
+        printf("  conflict misses absorbed             : %llu", (unsigned long long)c->stats.victim_conflict_hits);
+        if (c->stats.conflict_miss > 0) {
+            printf(" of %llu (%.1f %%)", (unsigned long long)c->stats.conflict_miss,
+                   100.0 * c->stats.victim_conflict_hits / c->stats.conflict_miss);
+        }
+        printf("\n");
+    }
+    printf("  writebacks                           : %llu\n", (unsigned long long)c->stats.writebacks);
+    if (c->config.inclusion == INCL_INCLUSIVE && c->num_upper > 0) {
+        printf("  back-invalidations                   : %llu\n", (unsigned long long)c->stats.back_invalidations);
+    }
+    // 한 워드짜리 라인은 항상 전부 쓰므로 생략
+    if (c->config.line_size > 4) {
+        print_line_use(c);
+    }
+    if (c->config.prefetcher != PF_NONE) {
+        print_prefetch_statistics(c);
+    }
 }
 
 void print_cache_statistics(void) {
     printf("================================================================================\n");
     printf("Cache Statistics:\n");
     printf("================================================================================\n");
-    
-    printf("Instruction Cache:\n");
-    printf("  cache access                         : %.0f\n", inst_cache_access);
-    printf("  hit count                            : %.0f\n", inst_cache_hit);
-    printf("  cold miss                            : %d\n", inst_cold_miss);
-    printf("  conflict miss                        : %d\n", inst_conflict_miss);
-    if (inst_cache_access > 0) {
-        printf("  hit rate                             : %.3f %%\n", 100 * (inst_cache_hit / inst_cache_access));
-    }
-    
-    printf("\nData Cache:\n");
-    printf("  cache access                         : %.0f\n", data_cache_access);
-    printf("  hit count                            : %.0f\n", data_cache_hit);
-    printf("  cold miss                            : %d\n", data_cold_miss);
-    printf("  conflict miss                        : %d\n", data_conflict_miss);
-    if (data_cache_access > 0) {
-        printf("  hit rate                             : %.3f %%\n", 100 * (data_cache_hit / data_cache_access));
-    }
-    
-    double total_access = inst_cache_access + data_cache_access;
-    double total_hit = inst_cache_hit + data_cache_hit;
-    
+
+    for (int level = 0; level < CACHE_NUM_LEVELS; level++) {
+        if (!level_enabled(level)) {
+            continue;
+        }
+        printf("%s%s:\n", (level == 0) ? "" : "\n", sim->cache->levels[level].name);
+        print_level_statistics(&sim->cache->levels[level]);
+    }
+
+    double total_access = (double)(instruction_cache.stats.access + data_cache.stats.access);
+    double total_hit = (double)(instruction_cache.stats.hit + data_cache.stats.hit);
+
     printf("\nOverall Cache Performance:\n");
     printf("  total cache access                   : %.0f\n", total_access);
     printf("  total hit count                      : %.0f\n", total_hit);
     if (total_access > 0) {
         printf("  overall hit rate                     : %.3f %%\n", 100 * (total_hit / total_access));
-        
+
+    }
+}
+
+static const char* replacement_name(ReplacementPolicy p) {
+    switch (p) {
+        case REPL_FIFO: return "FIFO";
+        case REPL_RANDOM: return "Random";
+        case REPL_PLRU: return "tree PLRU";
+        case REPL_BIT_PLRU: return "bit PLRU";
+        case REPL_SRRIP: return "SRRIP";
+        case REPL_BRRIP: return "BRRIP";
+        case REPL_DRRIP: return "DRRIP (set dueling)";
+        case REPL_LRU:
+        default: return "LRU";
+    }
+}
+
+static const char* inclusion_name(InclusionPolicy p) {
+    switch (p) {
+        case INCL_INCLUSIVE: return "inclusive";
+        case INCL_EXCLUSIVE: return "exclusive";
+        case INCL_NINE:
+        default: return "non-inclusive non-exclusive";
     }
 }
 
 void print_cache_configuration(void) {
     printf("Cache Configuration:\n");
-    printf("  Cache sets: %d\n", CACHE_SET_SIZE);
-    printf("  Associativity: %d-way\n", CACHE_ASSOC);
-    printf("  Cache line size: %d bytes\n", CACHE_LINE_SIZE);
-    printf("  Total cache size: %d bytes\n", CACHE_SET_SIZE * CACHE_ASSOC * CACHE_LINE_SIZE);
-    printf("  Replacement policy: LRU\n");
+    for (int level = 0; level < CACHE_NUM_LEVELS; level++) {
+        if (!level_enabled(level)) {
+            continue;
+        }
+        CacheConfig* cfg = &sim->cache_config[level];
+        printf("  %s:\n", level_names[level]);
+        printf("    Cache sets: %d\n", cfg->sets);
+        printf("    Associativity: %d-way\n", cfg->assoc);
+        printf("    Cache line size: %d bytes\n", cfg->line_size);
+        printf("    Total cache size: %d bytes\n", cfg->sets * cfg->assoc * cfg->line_size);
+        printf("    Replacement policy: %s\n", replacement_name(cfg->replacement));
+        printf("    Hit latency: %d cycle%s\n", cfg->latency, cfg->latency == 1 ? "" : "s");
+        if (level >= CACHE_L2) {
+            printf("    Inclusion policy: %s\n", inclusion_name(cfg->inclusion));
+        }
+        if (cfg->victim_entries > 0) {
+            printf("    Victim cache: %d lines (fully associative, LRU)\n", cfg->victim_entries);
+        }
+        if (cfg->prefetcher != PF_NONE) {
+            printf("    Prefetcher: %s (degree %d)\n", prefetcher_name(cfg->prefetcher), sim->prefetch_degree);
+        }
+    }
+    printf("  Tag match: %s\n", cache_tag_match_name());
     printf("  Write policy: Write-back, Write-allocate\n");
-    printf("  Cache access latency: 1 cycle\n");
-    printf("  Memory access latency: 1000 cycles\n");
-}
\ No newline at end of file
+    printf("  Memory access latency: %d cycles\n", sim->memory_latency);
+}
+
+// "SETSxWAYSxLINE" (예: 512x4x16)
+int parse_cache_geometry(const char* spec, CacheConfig* config) {
+    int sets, assoc, line;
+    if (sscanf(spec, "%dx%dx%d", &sets, &assoc, &line) != 3 || sets <= 0 || assoc <= 0 || line <= 0) {
+        fprintf(stderr, "Invalid cache geometry '%s' (expected SETSxWAYSxLINE)\n", spec);
+        return -1;
+    }
+    config->sets = sets;
+    config->assoc = assoc;
+    config->line_size = line;
+    return 0;
+}
+
+int parse_replacement_policy(const char* name, ReplacementPolicy* policy) {
+    static const struct {
+        const char* name;
+        ReplacementPolicy policy;
+    } policies[] = {
+        {"lru", REPL_LRU}, {"fifo", REPL_FIFO}, {"random", REPL_RANDOM},
+        {"plru", REPL_PLRU}, {"bitplru", REPL_BIT_PLRU},
+        {"srrip", REPL_SRRIP}, {"brrip", REPL_BRRIP}, {"drrip", REPL_DRRIP},
+    };
+    for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); i++) {
+        if (strcmp(name, policies[i].name) == 0) {
+            *policy = policies[i].policy;
+            return 0;
+        }
+    }
+    fprintf(stderr, "Unknown replacement policy: %s\n", name);
+    return -1;
+}
+
+int parse_inclusion_policy(const char* name, InclusionPolicy* policy) {
+    if (strcmp(name, "inclusive") == 0) {
+        *policy = INCL_INCLUSIVE;
+    } else if (strcmp(name, "exclusive") == 0) {
+        *policy = INCL_EXCLUSIVE;
+    } else if (strcmp(name, "nine") == 0) {
+        *policy = INCL_NINE;
+    } else {
+        fprintf(stderr, "Unknown inclusion policy: %s\n", name);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,187 @@
+#include "structure.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// 3C 미스 분류 (Hill)
+// 캐시 레벨마다 한 번이라도 본 블록의 비트맵과, 같은 라인 수의 완전 연관 LRU
+// 섀도 캐시를 둔다. 모든 demand 접근을 섀도에 똑같이 넣고, 실제 캐시가 미스하면
+//   처음 보는 블록            -> compulsory
+//   섀도에서도 미스            -> capacity (같은 크기로는 완전 연관이어도 미스)
+//   섀도에서는 히트            -> conflict (연관도/교체 정책 때문에 생긴 미스)
+// 로 나눈다. 섀도는 해시 체인 + 이중 연결 리스트로 접근마다 O(1).
+// 비트맵은 게스트 메모리처럼 청크 단위로 처음 닿을 때 할당해서, 스냅샷마다
+// 실제로 본 구간만 저장한다.
+
+#define SEEN_CHUNK_SHIFT 12                             // 청크 하나가 덮는 블록 수 (log2)
+#define SEEN_CHUNK_WORDS ((1u << SEEN_CHUNK_SHIFT) / 64)
+
+struct ShadowCache {
+    int capacity;               // 라인 수 (sets * assoc)
+    int offset_bits;
+    uint32_t blocks;            // seen이 덮는 블록 수 (MEMORY_SIZE 범위)
+    uint32_t chunks;
+    uint64_t** seen;            // [chunks] 블록 번호 비트맵 청크, 아직 안 본 구간은 NULL
+    uint64_t* seen_map;         // 할당된 청크의 비트맵 (체크포인트가 이것부터 저장)
+    uint32_t* block;            // [capacity] 노드의 블록 번호
+    int32_t* prev;              // LRU 리스트 (head = MRU)
+    int32_t* next;
+    int32_t* chain;             // 같은 버킷의 다음 노드
+    int32_t* buckets;           // [num_buckets] 첫 노드, 없으면 -1
+    uint32_t bucket_mask;
+    int32_t head;
+    int32_t tail;
+    int count;
+};
+
+ShadowCache* shadow_create(int lines, int line_size) {
+    ShadowCache* s = calloc(1, sizeof(ShadowCache));
+    if (s == NULL) {
+        return NULL;
+    }
+    uint32_t buckets = 1;
+    while (buckets < (uint32_t)lines) {
+        buckets <<= 1;
+    }
+    uint32_t blocks = MEMORY_SIZE / (uint32_t)line_size;
+
+    s->capacity = lines;
+    s->offset_bits = __builtin_ctz((unsigned)line_size);
+    s->blocks = blocks;
+    s->chunks = (blocks + (1u << SEEN_CHUNK_SHIFT) - 1) >> SEEN_CHUNK_SHIFT;
+    s->seen = calloc(s->chunks, sizeof(uint64_t*));
+    s->seen_map = calloc((s->chunks + 63) / 64, sizeof(uint64_t));
+    s->block = malloc(sizeof(uint32_t) * lines);
+    s->prev = malloc(sizeof(int32_t) * lines);
+    s->next = malloc(sizeof(int32_t) * lines);
+    s->chain = malloc(sizeof(int32_t) * lines);
+    s->buckets = malloc(sizeof(int32_t) * buckets);
+    if (!s->seen || !s->seen_map || !s->block || !s->prev || !s->next || !s->chain || !s->buckets) {
+        shadow_free(s);
+        return NULL;
+    }
+    s->bucket_mask = buckets - 1;
+    for (uint32_t i = 0; i < buckets; i++) {
+        s->buckets[i] = -1;
+    }
+    s->head = s->tail = -1;
+    return s;
+}
+
+void shadow_free(ShadowCache* s) {
+    if (s == NULL) {
+        return;
+    }
+    if (s->seen != NULL) {
+        for (uint32_t c = 0; c < s->chunks; c++) {
+            free(s->seen[c]);
+        }
+    }
+    free(s->seen);
+    free(s->seen_map);
+    free(s->block);
+    free(s->prev);
+    free(s->next);
+    free(s->chain);
+    free(s->buckets);
+    free(s);
+}
+
+static uint64_t* seen_chunk(ShadowCache* s, uint32_t c) {
+    uint64_t* chunk = calloc(SEEN_CHUNK_WORDS, sizeof(uint64_t));
+    if (chunk == NULL) {
+        fprintf(stderr, "3C classifier: out of memory\n");
+        exit(1);
+    }
+    s->seen[c] = chunk;
+    s->seen_map[c >> 6] |= 1ull << (c & 63);
+    return chunk;
+}
+
+static inline uint32_t bucket_of(const ShadowCache* s, uint32_t block) {
+    return (block * 2654435761u) & s->bucket_mask;
+}
+
+static void list_unlink(ShadowCache* s, int32_t n) {
+    if (s->prev[n] >= 0) s->next[s->prev[n]] = s->next[n]; else s->head = s->next[n];
+    if (s->next[n] >= 0) s->prev[s->next[n]] = s->prev[n]; else s->tail = s->prev[n];
+}
+
+static void list_push_front(ShadowCache* s, int32_t n) {
+    s->prev[n] = -1;
+    s->next[n] = s->head;
+    if (s->head >= 0) s->prev[s->head] = n; else s->tail = n;
+    s->head = n;
+}
+
+static void chain_remove(ShadowCache* s, int32_t n) {
+    int32_t* link = &s->buckets[bucket_of(s, s->block[n])];
+    while (*link != n) {
+        link = &s->chain[*link];
+    }
+    *link = s->chain[n];
+}
+
+// 접근 하나를 섀도에 반영하고, 실제 캐시가 이 접근에서 미스했다면 그 종류를 돌려준다
+MissClass shadow_access(ShadowCache* s, uint32_t address) {
+    uint32_t block = address >> s->offset_bits;
+    bool first = false;
+    if (block < s->blocks) {
+        uint64_t* chunk = s->seen[block >> SEEN_CHUNK_SHIFT];
+        if (chunk == NULL) {
+            chunk = seen_chunk(s, block >> SEEN_CHUNK_SHIFT);
+        }
+        uint64_t* word = &chunk[(block >> 6) & (SEEN_CHUNK_WORDS - 1)];
+        uint64_t bit = 1ull << (block & 63);
+        first = (*word & bit) == 0;
+        *word |= bit;
+    }
+
+    uint32_t b = bucket_of(s, block);
+    for (int32_t n = s->buckets[b]; n >= 0; n = s->chain[n]) {
+        if (s->block[n] == block) {
+            if (s->head != n) {
+                list_unlink(s, n);
+                list_push_front(s, n);
+            }
+            return MISS_CONFLICT;
+        }
+    }
+
+    int32_t n;
+    if (s->count < s->capacity) {
+        n = s->count++;
+    } else {
+        n = s->tail;
+        list_unlink(s, n);
+        chain_remove(s, n);
+    }
+    s->block[n] = block;
+    s->chain[n] = s->buckets[b];
+    s->buckets[b] = n;
+    list_push_front(s, n);
+    return first ? MISS_COMPULSORY : MISS_CAPACITY;
+}
+
+void shadow_checkpoint(ShadowCache* s, Checkpoint* ck) {
+    // 청크 비트맵 다음에 할당된 청크만. 복원할 때는 읽은 비트맵에 맞춰 청크를 만들거나 버린다
+    ckpt_region(ck, s->seen_map, sizeof(uint64_t) * ((s->chunks + 63) / 64));
+    for (uint32_t c = 0; c < s->chunks; c++) {
+        if (s->seen_map[c >> 6] & (1ull << (c & 63))) {
+            if (s->seen[c] == NULL) {
+                seen_chunk(s, c);
+            }
+            ckpt_region(ck, s->seen[c], sizeof(uint64_t) * SEEN_CHUNK_WORDS);
+        } else if (s->seen[c] != NULL) {
+            free(s->seen[c]);
+            s->seen[c] = NULL;
+        }
+    }
+    ckpt_region(ck, s->block, sizeof(uint32_t) * s->capacity);
+    ckpt_region(ck, s->prev, sizeof(int32_t) * s->capacity);
+    ckpt_region(ck, s->next, sizeof(int32_t) * s->capacity);
+    ckpt_region(ck, s->chain, sizeof(int32_t) * s->capacity);
+    ckpt_region(ck, s->buckets, sizeof(int32_t) * ((size_t)s->bucket_mask + 1));
+    ckpt_region(ck, &s->head, sizeof(s->head));
+    ckpt_region(ck, &s->tail, sizeof(s->tail));
+    ckpt_region(ck, &s->count, sizeof(s->count));
+}
@@ -0,0 +1,111 @@
+#define _POSIX_C_SOURCE 200809L
+#include "structure.h"
+#include <stdlib.h>
+#include <time.h>
+
+// 캐시 태그 조회 처리량 벤치마크 (make bench)
+// 용량(32KB, 16바이트 라인)은 고정하고 연관도만 4, 8, 16으로 바꿔 가며
+//   lookup : cache_contains로 태그 비교만 (약 절반이 히트하도록 용량의 2배 범위)
+//   access : cache_read_data로 LRU 갱신과 채우기까지 (용량의 90% 범위, 대부분 히트)
+// 를 측정한다. 같은 소스를 SIMD=none / 기본(SSE2) / -mavx2로 빌드해 비교한다.
+
+#define BENCH_CAPACITY  32768
+#define BENCH_LINE      16
+#define BENCH_ADDRS     (1 << 20)
+#define BENCH_ROUNDS    16
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// 워드 정렬된 무작위 주소 (xorshift, 실행마다 같은 순서)
+static void fill_addresses(uint32_t* addrs, uint32_t range) {
+    uint32_t x = 0x9E3779B9u;
+    for (int i = 0; i < BENCH_ADDRS; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        addrs[i] = (x % range) & ~3u;
+    }
+}
+
+static SimContext* bench_context(int ways) {
+    SimContext* ctx = sim_create();
+    if (ctx == NULL) {
+        fprintf(stderr, "Failed to allocate simulator context\n");
+        exit(1);
+    }
+    ctx->cache_config[CACHE_L1D].sets = BENCH_CAPACITY / (BENCH_LINE * ways);
+    ctx->cache_config[CACHE_L1D].assoc = ways;
+    ctx->cache_config[CACHE_L1D].line_size = BENCH_LINE;
+    sim = ctx;
+    init_cache();
+    return ctx;
+}
+
+int main(void) {
+    static const int ways_list[] = {4, 8, 16};
+    uint32_t* lookup_addrs = malloc(sizeof(uint32_t) * BENCH_ADDRS);
+    uint32_t* access_addrs = malloc(sizeof(uint32_t) * BENCH_ADDRS);
+
+#ifdef __AVX2__
+    if (!__builtin_cpu_supports("avx2")) {
+        printf("%s: CPU does not support AVX2, skipped\n", cache_tag_match_name());
+        return 0;
+    }
+#endif
+    if (lookup_addrs == NULL || access_addrs == NULL) {
+        fprintf(stderr, "bench: out of memory\n");
+        return 1;
+    }
+
+    trace_level = TRACE_LEVEL_QUIET;
+    trace_mask = 0;
+    fill_addresses(lookup_addrs, BENCH_CAPACITY * 2);
+    fill_addresses(access_addrs, BENCH_CAPACITY * 9 / 10);
+
+    printf("Tag match: %s\n", cache_tag_match_name());
+    printf("  %4s  %16s  %8s  %16s  %8s\n", "ways", "lookups/s", "hit", "accesses/s", "hit");
+
+    for (size_t w = 0; w < sizeof(ways_list) / sizeof(ways_list[0]); w++) {
+        SimContext* ctx = bench_context(ways_list[w]);
+
+        // 조회 범위를 한 번 읽어 캐시를 채워 둔다
+        for (int i = 0; i < BENCH_ADDRS; i++) {
+            cache_read_data(lookup_addrs[i], 0);
+        }
+
+        uint64_t found = 0;
+        double start = now_seconds();
+        for (int r = 0; r < BENCH_ROUNDS; r++) {
+            for (int i = 0; i < BENCH_ADDRS; i++) {
+                found += cache_contains(CACHE_L1D, lookup_addrs[i]);
+            }
+        }
+        double lookup_time = now_seconds() - start;
+
+        reset_cache_statistics();
+        start = now_seconds();
+        for (int r = 0; r < BENCH_ROUNDS; r++) {
+            for (int i = 0; i < BENCH_ADDRS; i++) {
+                cache_read_data(access_addrs[i], 0);
+            }
+        }
+        double access_time = now_seconds() - start;
+
+        CacheLevelSummary s;
+        get_cache_level_summary(CACHE_L1D, &s);
+        double n = (double)BENCH_ADDRS * BENCH_ROUNDS;
+        printf("  %4d  %16.0f  %7.2f%%  %16.0f  %7.2f%%\n", ways_list[w],
+               n / lookup_time, 100.0 * found / n, n / access_time, 100.0 * s.hit / s.access);
+
+        sim_destroy(ctx);
+        sim = NULL;
+    }
+
+    free(lookup_addrs);
+    free(access_addrs);
+    return 0;
+}
@@ -0,0 +1,201 @@
+#include "structure.h"
+#include <stdlib.h>
+
+// 스택 거리(stack distance) 기반 다중 구성 캐시 시뮬레이션
+// 라인 크기와 세트 수 조합마다 세트별 LRU 스택을 유지한다. 접근한 블록의
+// 스택 위치가 d이면 연관도가 d보다 큰 모든 LRU 캐시에서 히트이므로,
+// 한 번의 실행으로 모든 연관도(1..SWEEP_MAX_ASSOC)의 결과를 얻는다.
+
+#define SWEEP_NUM_LINES     6       // 4 .. 128 bytes
+#define SWEEP_NUM_SETS      13      // 1 .. 4096 sets
+#define SWEEP_MAX_ASSOC     16
+
+static const int sweep_line_sizes[SWEEP_NUM_LINES] = {4, 8, 16, 32, 64, 128};
+
+typedef struct {
+    int sets;
+    uint32_t* stack;            // [sets][SWEEP_MAX_ASSOC], 0번이 MRU
+    uint8_t* depth;             // 세트별 유효 엔트리 수
+    uint64_t hist[SWEEP_MAX_ASSOC + 1];   // 스택 거리 히스토그램 (마지막은 미스)
+} SweepConfig;
+
+typedef struct {
+    SweepConfig configs[SWEEP_NUM_LINES][SWEEP_NUM_SETS];
+    uint32_t last_block[SWEEP_NUM_LINES];    // 직전 접근 블록 (연속 접근 단축 경로)
+    bool has_last[SWEEP_NUM_LINES];
+    uint64_t repeat_hits[SWEEP_NUM_LINES];   // 모든 구성에서 거리 0인 접근
+    uint64_t accesses;
+} SweepStream;
+
+struct SweepState {
+    SweepStream streams[2];     // 0: instruction, 1: data
+};
+
+void init_cache_sweep(void) {
+    sim->sweep = calloc(1, sizeof(struct SweepState));
+    if (sim->sweep == NULL) {
+        fprintf(stderr, "cache sweep: out of memory\n");
+        exit(1);
+    }
+
+    for (int s = 0; s < 2; s++) {
+        SweepStream* stream = &sim->sweep->streams[s];
+        for (int l = 0; l < SWEEP_NUM_LINES; l++) {
+            for (int k = 0; k < SWEEP_NUM_SETS; k++) {
+                SweepConfig* cfg = &stream->configs[l][k];
+                cfg->sets = 1 << k;
+                cfg->stack = calloc((size_t)cfg->sets * SWEEP_MAX_ASSOC, sizeof(uint32_t));
+                cfg->depth = calloc((size_t)cfg->sets, sizeof(uint8_t));
+                if (!cfg->stack || !cfg->depth) {
+                    fprintf(stderr, "cache sweep: out of memory\n");
+                    exit(1);
+                }
+            }
+        }
+    }
+    sim->cache_sweep_enabled = true;
+}
+
+void cache_sweep_checkpoint(Checkpoint* ck) {
+    if (sim->sweep == NULL) {
+        return;
+    }
+    for (int s = 0; s < 2; s++) {
+        SweepStream* stream = &sim->sweep->streams[s];
+        for (int l = 0; l < SWEEP_NUM_LINES; l++) {
+            for (int k = 0; k < SWEEP_NUM_SETS; k++) {
+                SweepConfig* cfg = &stream->configs[l][k];
+                ckpt_region(ck, cfg->stack, sizeof(uint32_t) * cfg->sets * SWEEP_MAX_ASSOC);
+                ckpt_region(ck, cfg->depth, cfg->sets);
+                ckpt_region(ck, cfg->hist, sizeof(cfg->hist));
+            }
+        }
+        ckpt_region(ck, stream->last_block, sizeof(stream->last_block));
+        ckpt_region(ck, stream->has_last, sizeof(stream->has_last));
+        ckpt_region(ck, stream->repeat_hits, sizeof(stream->repeat_hits));
+        ckpt_region(ck, &stream->accesses, sizeof(stream->accesses));
+    }
+}
+
+void free_cache_sweep(void) {
+    if (sim->sweep == NULL) {
+        return;
+    }
+    for (int s = 0; s < 2; s++) {
+        for (int l = 0; l < SWEEP_NUM_LINES; l++) {
+            for (int k = 0; k < SWEEP_NUM_SETS; k++) {
+                free(sim->sweep->streams[s].configs[l][k].stack);
+                free(sim->sweep->streams[s].configs[l][k].depth);
+            }
+        }
+    }
+    free(sim->sweep);
+    sim->sweep = NULL;
+    sim->cache_sweep_enabled = false;
+}
+
+// 스택 상태는 두고 히스토그램만 비운다 (fast-forward 워밍 후)
+void reset_cache_sweep_statistics(void) {
+    for (int s = 0; s < 2; s++) {
+        SweepStream* stream = &sim->sweep->streams[s];
+        stream->accesses = 0;
+        memset(stream->repeat_hits, 0, sizeof(stream->repeat_hits));
+        for (int l = 0; l < SWEEP_NUM_LINES; l++) {
+            for (int k = 0; k < SWEEP_NUM_SETS; k++) {
+                memset(stream->configs[l][k].hist, 0, sizeof(stream->configs[l][k].hist));
+            }
+        }
+    }
+}
+
+static void sweep_access_config(SweepConfig* cfg, uint32_t block) {
+    uint32_t set = block & (uint32_t)(cfg->sets - 1);
+    uint32_t* stack = &cfg->stack[(size_t)set * SWEEP_MAX_ASSOC];
+    int depth = cfg->depth[set];
+    int pos = 0;
+
+    while (pos < depth && stack[pos] != block) {
+        pos++;
+    }
+
+    if (pos < depth) {
+        cfg->hist[pos]++;
+    } else {
+        cfg->hist[SWEEP_MAX_ASSOC]++;
+        if (depth < SWEEP_MAX_ASSOC) {
+            cfg->depth[set] = (uint8_t)(depth + 1);
+            pos = depth;
+        } else {
+            pos = SWEEP_MAX_ASSOC - 1;      // 가장 오래된 블록은 밀려남
+        }
+    }
+
+    // move-to-front
+    memmove(&stack[1], &stack[0], (size_t)pos * sizeof(uint32_t));
+    stack[0] = block;
+}
+
+void cache_sweep_access(int stream_id, uint32_t address) {
+    SweepStream* stream = &sim->sweep->streams[stream_id];
+    stream->accesses++;
+
+    for (int l = 0; l < SWEEP_NUM_LINES; l++) {
+        uint32_t block = address / (uint32_t)sweep_line_sizes[l];
+
+        // 같은 블록 연속 접근은 모든 세트 수에서 MRU 히트
+        if (stream->has_last[l] && stream->last_block[l] == block) {
+            stream->repeat_hits[l]++;
+            continue;
+        }
+        stream->last_block[l] = block;
+        stream->has_last[l] = true;
+
+        for (int k = 0; k < SWEEP_NUM_SETS; k++) {
+            sweep_access_config(&stream->configs[l][k], block);
+        }
+    }
+}
+
+void print_cache_sweep(void) {
+    static const char* names[2] = {"Instruction", "Data"};
+    static const int assocs[] = {1, 2, 4, 8, 16};
+    const int num_assocs = sizeof(assocs) / sizeof(assocs[0]);
+
+    printf("================================================================================\n");
+    printf("Cache Sweep (LRU, miss rate %% by sets x associativity):\n");
+    printf("================================================================================\n");
+
+    for (int s = 0; s < 2; s++) {
+        SweepStream* stream = &sim->sweep->streams[s];
+        if (stream->accesses == 0) {
+            continue;
+        }
+
+        for (int l = 0; l < SWEEP_NUM_LINES; l++) {
+            printf("%s cache, %d-byte lines, %llu accesses\n", names[s], sweep_line_sizes[l],
+                   (unsigned long long)stream->accesses);
+            printf("  %6s", "sets");
+            for (int a = 0; a < num_assocs; a++) {
+                printf("  %7d-way", assocs[a]);
+            }
+            printf("\n");
+
+            for (int k = 0; k < SWEEP_NUM_SETS; k++) {
+                SweepConfig* cfg = &stream->configs[l][k];
+                printf("  %6d", cfg->sets);
+
+                uint64_t hits = stream->repeat_hits[l];
+                int d = 0;
+                for (int a = 0; a < num_assocs; a++) {
+                    while (d < assocs[a]) {
+                        hits += cfg->hist[d++];
+                    }
+                    double miss_rate = 100.0 * (double)(stream->accesses - hits) / (double)stream->accesses;
+                    printf("  %10.3f%%", miss_rate);
+                }
+                printf("\n");
+            }
+            printf("\n");
+        }
+    }
+}
@@ -0,0 +1,400 @@
+#define _POSIX_C_SOURCE 200809L
+#include "structure.h"
+#include <stdlib.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// 시뮬레이터 상태 체크포인트 (--checkpoint-at N, --restore FILE)
+// 파일 구성:
+//   헤더 | 페이지 번호 목록 | 컨텍스트 값 | 모듈 섹션들 | (4KB 정렬) 게스트 페이지들
+// 복원은 파일을 MAP_PRIVATE로 매핑해서 게스트 페이지 테이블이 매핑 안의 페이지를
+// 가리키게 하는 것으로 끝난다 (쓰는 페이지만 커널이 복사). 캐시, 예측기 같은 모듈
+// 상태는 현재 구성으로 init_*한 구조체에 *_checkpoint가 영역별로 값을 복사해 넣으므로
+// 포인터는 파일에 들어가지 않는다.
+// 모듈 섹션에는 그 상태의 모양을 정하는 구성(키)을 함께 적는다. 복원하는 실행의
+// 구성이 다르면 그 모듈만 처음 상태로 시작하므로, 워밍한 체크포인트 하나를 캐시나
+// 예측기 구성을 바꾸는 스윕 전체가 함께 쓸 수 있다. 레지스터, 래치, 통계, 메모리는
+// 항상 복원한다 (저장 전에 dirty 캐시 라인을 메모리에 복사해 둔다).
+
+#define CKPT_MAGIC      "MIPSCKPT"
+#define CKPT_VERSION    1
+#define CKPT_MAX_KEY    256
+
+// SimContext에서 registers부터 구성 필드 앞까지 (포인터 없는 값)
+#define CONTEXT_VALUES_OFFSET   offsetof(SimContext, registers)
+#define CONTEXT_VALUES_SIZE     (offsetof(SimContext, cache_config) - offsetof(SimContext, registers))
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t context_size;      // CONTEXT_VALUES_SIZE (다른 빌드의 파일 거르기)
+    uint64_t cycles;
+    uint32_t num_pages;
+    uint32_t num_sections;
+    uint64_t pages_offset;      // MEM_PAGE_SIZE 배수
+} CheckpointHeader;
+
+typedef struct {
+    uint32_t id;
+    uint32_t key_size;
+    uint64_t data_size;         // 키 뒤의 영역 데이터 크기
+} SectionHeader;
+
+struct Checkpoint {
+    FILE* fp;                   // 저장 중이면 쓰는 파일, 복원 중이면 NULL
+    const uint8_t* pos;         // 복원: 매핑 안의 읽을 위치
+    const uint8_t* end;
+    bool failed;
+};
+
+// 영역마다 크기를 앞에 붙여서, 복원하는 쪽의 크기가 다르면 (다른 빌드, 손상) 멈춘다
+void ckpt_region(Checkpoint* ck, void* data, size_t size) {
+    uint64_t bytes = size;
+
+    if (ck->failed) {
+        return;
+    }
+    if (ck->fp != NULL) {
+        if (fwrite(&bytes, sizeof(bytes), 1, ck->fp) != 1 ||
+            (size > 0 && fwrite(data, size, 1, ck->fp) != 1)) {
+            ck->failed = true;
+        }
+        return;
+    }
+
+    uint64_t stored;
+    if ((size_t)(ck->end - ck->pos) < sizeof(stored)) {
+        ck->failed = true;
+        return;
+    }
+    memcpy(&stored, ck->pos, sizeof(stored));
+    if (stored != bytes || (size_t)(ck->end - ck->pos) - sizeof(stored) < size) {
+        ck->failed = true;
+        return;
+    }
+    if (size > 0) {
+        memcpy(data, ck->pos + sizeof(stored), size);
+    }
+    ck->pos += sizeof(stored) + size;
+}
+
+// ---------------------------------------------------------------------------
+// 모듈 섹션과 그 키
+// ---------------------------------------------------------------------------
+
+// 캐시 구성 (히트 지연은 상태 모양과 무관하므로 빼서 지연 스윕도 같은 체크포인트를 쓴다)
+static size_t cache_key(uint8_t* key) {
+    CacheConfig config[CACHE_NUM_LEVELS];
+    memcpy(config, sim->cache_config, sizeof(config));
+    for (int level = 0; level < CACHE_NUM_LEVELS; level++) {
+        config[level].latency = 0;
+    }
+    memcpy(key, config, sizeof(config));
+    memcpy(key + sizeof(config), &sim->cache_seed, sizeof(sim->cache_seed));
+    return sizeof(config) + sizeof(sim->cache_seed);
+}
+
+// 스트림 버퍼는 캐시와 배타적으로 블록을 가지므로 캐시와 함께만 복원한다
+static size_t prefetch_key(uint8_t* key) {
+    size_t n = cache_key(key);
+    memcpy(key + n, &sim->prefetch_degree, sizeof(sim->prefetch_degree));
+    return n + sizeof(sim->prefetch_degree);
+}
+
+static size_t predictor_key(uint8_t* key) {
+    memcpy(key, &sim->bp_kind, sizeof(sim->bp_kind));
+    memcpy(key + sizeof(sim->bp_kind), &sim->bp_budget, sizeof(sim->bp_budget));
+    return sizeof(sim->bp_kind) + sizeof(sim->bp_budget);
+}
+
+static size_t target_key(uint8_t* key) {
+    memcpy(key, &sim->btb_entries, sizeof(sim->btb_entries));
+    memcpy(key + sizeof(sim->btb_entries), &sim->ras_depth, sizeof(sim->ras_depth));
+    return sizeof(sim->btb_entries) + sizeof(sim->ras_depth);
+}
+
+static size_t mshr_key(uint8_t* key) {
+    memcpy(key, &sim->mshr_entries, sizeof(sim->mshr_entries));
+    memcpy(key + sizeof(sim->mshr_entries), &sim->cache_config[CACHE_L1D].line_size, sizeof(int));
+    return sizeof(sim->mshr_entries) + sizeof(int);
+}
+
+static size_t no_key(uint8_t* key) {
+    (void)key;
+    return 0;
+}
+
+static size_t sweep_key(uint8_t* key) {
+    key[0] = sim->cache_sweep_enabled;
+    return 1;
+}
+
+typedef struct {
+    const char* name;
+    size_t (*key)(uint8_t* key);
+    void (*state)(Checkpoint* ck);
+} SectionOps;
+
+// 섹션 번호 = 이 표의 인덱스
+static const SectionOps sections[] = {
+    {"caches", cache_key, cache_checkpoint},
+    {"prefetchers", prefetch_key, prefetch_checkpoint},
+    {"branch predictor", predictor_key, branch_predictor_checkpoint},
+    {"BTB/RAS", target_key, target_predictor_checkpoint},
+    {"MSHRs", mshr_key, mshr_checkpoint},
+    {"decode table", no_key, decode_cache_checkpoint},
+    {"cache sweep", sweep_key, cache_sweep_checkpoint},
+};
+
+#define NUM_SECTIONS ((uint32_t)(sizeof(sections) / sizeof(sections[0])))
+
+static uint8_t* context_values(SimContext* ctx) {
+    return (uint8_t*)ctx + CONTEXT_VALUES_OFFSET;
+}
+
+// ---------------------------------------------------------------------------
+// 저장
+// ---------------------------------------------------------------------------
+
+static int write_section(Checkpoint* ck, uint32_t id) {
+    uint8_t key[CKPT_MAX_KEY];
+    SectionHeader h = {id, (uint32_t)sections[id].key(key), 0};
+    long start = ftell(ck->fp);
+
+    if (fwrite(&h, sizeof(h), 1, ck->fp) != 1 || (h.key_size > 0 && fwrite(key, h.key_size, 1, ck->fp) != 1)) {
+        return -1;
+    }
+    long data_start = ftell(ck->fp);
+    sections[id].state(ck);
+    long end = ftell(ck->fp);
+    if (ck->failed || start < 0 || end < 0) {
+        return -1;
+    }
+
+    // 데이터 크기를 채워 넣는다 (복원할 때 구성이 다른 섹션을 건너뛰는 데 씀)
+    h.data_size = (uint64_t)(end - data_start);
+    if (fseek(ck->fp, start, SEEK_SET) != 0 || fwrite(&h, sizeof(h), 1, ck->fp) != 1 ||
+        fseek(ck->fp, end, SEEK_SET) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// 컨텍스트 값과 모든 모듈 섹션
+static int write_state(Checkpoint* ck) {
+    ckpt_region(ck, context_values(sim), CONTEXT_VALUES_SIZE);
+    if (ck->failed) {
+        return -1;
+    }
+    for (uint32_t id = 0; id < NUM_SECTIONS; id++) {
+        if (write_section(ck, id) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int write_checkpoint(FILE* fp) {
+    GuestMemory* m = &sim->memory;
+    Checkpoint ck = {fp, NULL, NULL, false};
+    CheckpointHeader h;
+
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, CKPT_MAGIC, sizeof(h.magic));
+    h.version = CKPT_VERSION;
+    h.context_size = (uint32_t)CONTEXT_VALUES_SIZE;
+    h.cycles = sim->inst_count;
+    h.num_sections = NUM_SECTIONS;
+
+    // 할당된 (한 번이라도 쓴) 페이지만 저장한다
+    uint32_t* pages = malloc(sizeof(uint32_t) * (m->touched_pages ? m->touched_pages : 1));
+    if (pages == NULL) {
+        return -1;
+    }
+    for (uint32_t d = 0; d < MEM_DIR_SIZE; d++) {
+        for (uint32_t t = 0; m->dir[d] != NULL && t < MEM_TABLE_SIZE; t++) {
+            if (m->dir[d][t] != NULL) {
+                pages[h.num_pages++] = (d << (MEM_DIR_SHIFT - MEM_PAGE_SHIFT)) | t;
+            }
+        }
+    }
+
+    int status = -1;
+    if (fwrite(&h, sizeof(h), 1, fp) != 1 ||
+        (h.num_pages > 0 && fwrite(pages, sizeof(uint32_t), h.num_pages, fp) != h.num_pages)) {
+        goto out;
+    }
+    if (write_state(&ck) != 0) {
+        goto out;
+    }
+
+    long end = ftell(fp);
+    if (end < 0) {
+        goto out;
+    }
+    h.pages_offset = ((uint64_t)end + MEM_PAGE_SIZE - 1) & ~(uint64_t)MEM_PAGE_MASK;
+    if (fseek(fp, (long)h.pages_offset, SEEK_SET) != 0) {
+        goto out;
+    }
+    for (uint32_t i = 0; i < h.num_pages; i++) {
+        const uint8_t* data = mem_page_slow(m, pages[i], 0);
+        if (fwrite(data, MEM_PAGE_SIZE, 1, fp) != 1) {
+            goto out;
+        }
+    }
+    if (fseek(fp, 0, SEEK_SET) != 0 || fwrite(&h, sizeof(h), 1, fp) != 1) {
+        goto out;
+    }
+    status = 0;
+
+out:
+    free(pages);
+    return status;
+}
+
+int checkpoint_save(const char* path) {
+    FILE* fp = fopen(path, "wb");
+    if (fp == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    cache_sync_memory();
+    int status = write_checkpoint(fp);
+    if (fclose(fp) != 0) {
+        status = -1;
+    }
+    if (status != 0) {
+        fprintf(stderr, "%s: failed to write checkpoint\n", path);
+        return -1;
+    }
+    TRACE_INFO("Checkpoint written to %s at cycle %llu (%llu pages)\n", path,
+               (unsigned long long)sim->inst_count, (unsigned long long)sim->memory.touched_pages);
+    return 0;
+}
+
+// 게스트 메모리를 뺀 상태만 쓴다. 시간 여행 스냅샷(timetravel.c)이 메모리 스트림에
+// 쓰고, 메모리는 페이지 공유로 따로 잡는다. 캐시 내용을 메모리에 내리지 않으므로
+// 실행에는 영향이 없다.
+int checkpoint_write_state(FILE* fp) {
+    Checkpoint ck = {fp, NULL, NULL, false};
+    return write_state(&ck);
+}
+
+// ---------------------------------------------------------------------------
+// 복원
+// ---------------------------------------------------------------------------
+
+static int restore_sections(Checkpoint* ck, uint32_t num_sections) {
+    for (uint32_t i = 0; i < num_sections; i++) {
+        SectionHeader h;
+        if ((size_t)(ck->end - ck->pos) < sizeof(h)) {
+            return -1;
+        }
+        memcpy(&h, ck->pos, sizeof(h));
+        ck->pos += sizeof(h);
+        if (h.id >= NUM_SECTIONS || h.key_size > CKPT_MAX_KEY ||
+            (uint64_t)(ck->end - ck->pos) < h.key_size + h.data_size) {
+            return -1;
+        }
+
+        uint8_t key[CKPT_MAX_KEY];
+        size_t key_size = sections[h.id].key(key);
+        const uint8_t* data = ck->pos + h.key_size;
+        const uint8_t* next = data + h.data_size;
+
+        if (key_size == h.key_size && memcmp(key, ck->pos, key_size) == 0) {
+            ck->pos = data;
+            sections[h.id].state(ck);
+            if (ck->failed || ck->pos != next) {
+                return -1;
+            }
+        } else {
+            TRACE_INFO("Checkpoint: %s configuration differs, starting cold\n", sections[h.id].name);
+        }
+        ck->pos = next;
+    }
+    return 0;
+}
+
+static int read_state(Checkpoint* ck, uint32_t num_sections) {
+    ckpt_region(ck, context_values(sim), CONTEXT_VALUES_SIZE);
+    if (ck->failed) {
+        return -1;
+    }
+    return restore_sections(ck, num_sections);
+}
+
+// checkpoint_write_state가 쓴 상태를 같은 구성의 sim에 되돌린다
+int checkpoint_read_state(const uint8_t* data, size_t size) {
+    Checkpoint ck = {NULL, data, data + size, false};
+    if (read_state(&ck, NUM_SECTIONS) != 0 || ck.pos != ck.end) {
+        return -1;
+    }
+    return 0;
+}
+
+// 현재 구성으로 초기화된 컨텍스트(sim)에 체크포인트를 덮어쓴다
+int checkpoint_restore(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CheckpointHeader)) {
+        close(fd);
+        fprintf(stderr, "%s: not a checkpoint file\n", path);
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    uint8_t* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror(path);
+        return -1;
+    }
+
+    CheckpointHeader h;
+    memcpy(&h, base, sizeof(h));
+    if (memcmp(h.magic, CKPT_MAGIC, sizeof(h.magic)) != 0 || h.version != CKPT_VERSION) {
+        munmap(base, size);
+        fprintf(stderr, "%s: not a checkpoint file\n", path);
+        return -1;
+    }
+    size_t index_end = sizeof(h) + (size_t)h.num_pages * sizeof(uint32_t);
+    if (h.context_size != CONTEXT_VALUES_SIZE || (h.pages_offset & MEM_PAGE_MASK) != 0 ||
+        h.pages_offset < index_end || h.pages_offset > size ||
+        (size - h.pages_offset) / MEM_PAGE_SIZE < h.num_pages) {
+        munmap(base, size);
+        fprintf(stderr, "%s: checkpoint was written by a different build or is corrupt\n", path);
+        return -1;
+    }
+
+    // 게스트 메모리: 페이지 테이블만 매핑 안으로 연결
+    GuestMemory* m = &sim->memory;
+    mem_free(m);
+    mem_attach_mapping(m, base, size);
+    for (uint32_t i = 0; i < h.num_pages; i++) {
+        uint32_t page;
+        memcpy(&page, base + sizeof(h) + (size_t)i * sizeof(uint32_t), sizeof(page));
+        if (page >= MEM_DIR_SIZE * MEM_TABLE_SIZE) {
+            fprintf(stderr, "%s: corrupt checkpoint\n", path);
+            return -1;
+        }
+        mem_map_page(m, page, base + h.pages_offset + (size_t)i * MEM_PAGE_SIZE);
+    }
+
+    Checkpoint ck = {NULL, base + index_end, base + h.pages_offset, false};
+    if (read_state(&ck, h.num_sections) != 0) {
+        fprintf(stderr, "%s: checkpoint was written by a different build or is corrupt\n", path);
+        return -1;
+    }
+
+    TRACE_INFO("Restored checkpoint %s at cycle %llu (%u pages)\n", path,
+               (unsigned long long)h.cycles, h.num_pages);
+    return 0;
+}
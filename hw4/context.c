@@ -0,0 +1,315 @@
+#define _POSIX_C_SOURCE 200809L
+#include "structure.h"
+#include <stdlib.h>
+
+// 시뮬레이터 컨텍스트 생성/해제와 구성 옵션 처리
+// mips_pipeline과 mips_replay가 공유한다.
+
+#define CONFIG_MAX_ARGS 64
+
+// 현재 스레드가 시뮬레이션 중인 컨텍스트
+_Thread_local SimContext* sim = NULL;
+
+int trace_level = TRACE_LEVEL_CYCLE;
+unsigned int trace_mask = TRACE_ALL;
+
+SimContext* sim_create(void) {
+    SimContext* ctx = calloc(1, sizeof(SimContext));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    mem_init(&ctx->memory);
+    for (int i = 0; i < 4; i++) {
+        ctx->ctrl_flow[i] = -1;
+    }
+    memcpy(ctx->cache_config, default_cache_config, sizeof(ctx->cache_config));
+    ctx->cache_seed = CACHE_DEFAULT_SEED;
+    ctx->prefetch_degree = PF_DEFAULT_DEGREE;
+    ctx->memory_latency = MEMORY_DEFAULT_LATENCY;
+    ctx->bp_budget = BP_DEFAULT_BUDGET;
+    ctx->btb_entries = BTB_DEFAULT_ENTRIES;
+    ctx->ras_depth = RAS_DEFAULT_DEPTH;
+    ctx->mispredict_penalty = MISPREDICT_DEFAULT_PENALTY;
+    ctx->snapshot_interval = SNAPSHOT_DEFAULT_INTERVAL;
+    ctx->snapshot_limit = (uint64_t)SNAPSHOT_DEFAULT_MEM_MB << 20;
+    return ctx;
+}
+
+void sim_destroy(SimContext* ctx) {
+    if (ctx == NULL) {
+        return;
+    }
+    SimContext* saved = sim;
+    sim = ctx;
+    free_cache();
+    free_cache_sweep();
+    free_bintrace();
+    free_branch_predictor();
+    free_target_predictor();
+    free_decode_cache();
+    free_mshr();
+    sim = saved;
+    mem_free(&ctx->memory);
+    free(ctx);
+}
+
+int parse_trace_categories(const char* list, unsigned int* mask) {
+    static const struct { const char* name; unsigned int bit; } categories[] = {
+        {"pipeline", TRACE_PIPELINE},
+        {"hazard",   TRACE_HAZARD},
+        {"icache",   TRACE_ICACHE},
+        {"dcache",   TRACE_DCACHE},
+        {"branch",   TRACE_BRANCH},
+        {"all",      TRACE_ALL},
+    };
+    unsigned int result = 0;
+    const char* p = list;
+
+    while (*p) {
+        size_t len = strcspn(p, ",");
+        bool found = false;
+        for (size_t i = 0; i < sizeof(categories) / sizeof(categories[0]); i++) {
+            if (strlen(categories[i].name) == len && strncmp(p, categories[i].name, len) == 0) {
+                result |= categories[i].bit;
+                found = true;
+                break;
+            }
+        }
+        if (!found && len > 0) {
+            fprintf(stderr, "Unknown trace category: %.*s\n", (int)len, p);
+            return -1;
+        }
+        p += len;
+        if (*p == ',') p++;
+    }
+
+    *mask = result;
+    return 0;
+}
+
+// "--l1i", "--l2-repl" 같은 캐시 옵션이면 레벨 번호, 아니면 -1
+static int cache_level_option(const char* arg, const char* suffix) {
+    static const char* names[CACHE_NUM_LEVELS] = {"--l1i", "--l1d", "--l2", "--l3"};
+    for (int level = 0; level < CACHE_NUM_LEVELS; level++) {
+        size_t len = strlen(names[level]);
+        if (strncmp(arg, names[level], len) == 0 && strcmp(arg + len, suffix) == 0) {
+            return level;
+        }
+    }
+    return -1;
+}
+
+// 컨텍스트 구성 옵션 하나를 적용한다 (명령행과 스윕 구성 파일이 공유).
+// 사용한 인자 수를 반환: 0이면 구성 옵션이 아님, -1이면 오류.
+int sim_apply_option(SimContext* ctx, int argc, char** argv, int i) {
+    const char* arg = argv[i];
+    const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+    int level;
+
+    if (strcmp(arg, "--ff-warm") == 0) {
+        ctx->ff_warm = true;
+        return 1;
+    }
+
+    if (strcmp(arg, "--fast-forward") == 0 && value) {
+        ctx->ff_insts = strtoull(value, NULL, 0);
+    } else if (strcmp(arg, "--ff-until-pc") == 0 && value) {
+        ctx->ff_stop_pc = strtoul(value, NULL, 16);
+        ctx->ff_use_pc = true;
+    } else if (strcmp(arg, "--bp") == 0 && value) {
+        if (parse_branch_predictor(value, &ctx->bp_kind) != 0) return -1;
+    } else if (strcmp(arg, "--bp-budget") == 0 && value) {
+        unsigned long budget = strtoul(value, NULL, 0);
+        if (budget == 0 || budget > (1ul << 24)) {
+            fprintf(stderr, "Invalid branch predictor budget: %s\n", value);
+            return -1;
+        }
+        ctx->bp_budget = (uint32_t)budget;
+    } else if (strcmp(arg, "--btb-entries") == 0 && value) {
+        unsigned long entries = strtoul(value, NULL, 0);
+        if (entries > (1ul << 20) || (entries & (entries - 1)) != 0) {
+            fprintf(stderr, "BTB entries must be 0 or a power of two: %s\n", value);
+            return -1;
+        }
+        ctx->btb_entries = (uint32_t)entries;
+    } else if (strcmp(arg, "--ras-depth") == 0 && value) {
+        int depth = atoi(value);
+        if (depth < 0 || depth > 1024) {
+            fprintf(stderr, "Invalid RAS depth: %s\n", value);
+            return -1;
+        }
+        ctx->ras_depth = depth;
+    } else if (strcmp(arg, "--mispredict-penalty") == 0 && value) {
+        int penalty = atoi(value);
+        if (penalty < 1 || penalty > 64) {
+            fprintf(stderr, "Misprediction penalty must be 1..64 cycles: %s\n", value);
+            return -1;
+        }
+        ctx->mispredict_penalty = penalty;
+    } else if (strcmp(arg, "--mshrs") == 0 && value) {
+        int entries = atoi(value);
+        if (entries < 0 || entries > MSHR_MAX_ENTRIES) {
+            fprintf(stderr, "MSHR count must be 0..%d: %s\n", MSHR_MAX_ENTRIES, value);
+            return -1;
+        }
+        ctx->mshr_entries = entries;
+    } else if (strcmp(arg, "--cache-seed") == 0 && value) {
+        ctx->cache_seed = (uint32_t)strtoul(value, NULL, 0);
+    } else if (strcmp(arg, "--pf-degree") == 0 && value) {
+        int degree = atoi(value);
+        if (degree < 1 || degree > 64) {
+            fprintf(stderr, "Prefetch degree must be 1..64: %s\n", value);
+            return -1;
+        }
+        ctx->prefetch_degree = degree;
+    } else if ((level = cache_level_option(arg, "")) >= 0 && value) {
+        if (parse_cache_geometry(value, &ctx->cache_config[level]) != 0) return -1;
+    } else if ((level = cache_level_option(arg, "-repl")) >= 0 && value) {
+        if (parse_replacement_policy(value, &ctx->cache_config[level].replacement) != 0) return -1;
+    } else if ((level = cache_level_option(arg, "-pf")) >= 0 && level <= CACHE_L1D && value) {
+        if (parse_prefetcher(value, &ctx->cache_config[level].prefetcher) != 0) return -1;
+    } else if (strcmp(arg, "--mem-latency") == 0 && value) {
+        int latency = atoi(value);
+        if (latency < 0 || latency > MEMORY_MAX_LATENCY) {
+            fprintf(stderr, "Memory latency must be 0..%d cycles: %s\n", MEMORY_MAX_LATENCY, value);
+            return -1;
+        }
+        ctx->memory_latency = latency;
+    } else if ((level = cache_level_option(arg, "-latency")) >= 0 && value) {
+        int latency = atoi(value);
+        if (latency < 1 || latency > CACHE_MAX_LATENCY) {
+            fprintf(stderr, "Cache hit latency must be 1..%d cycles: %s\n", CACHE_MAX_LATENCY, value);
+            return -1;
+        }
+        ctx->cache_config[level].latency = latency;
+    } else if ((level = cache_level_option(arg, "-victim")) >= 0 && level <= CACHE_L1D && value) {
+        int entries = atoi(value);
+        if (entries < 0 || entries > VICTIM_MAX_ENTRIES) {
+            fprintf(stderr, "Victim cache entries must be 0..%d: %s\n", VICTIM_MAX_ENTRIES, value);
+            return -1;
+        }
+        ctx->cache_config[level].victim_entries = entries;
+    } else if ((level = cache_level_option(arg, "-incl")) >= CACHE_L2 && value) {
+        if (parse_inclusion_policy(value, &ctx->cache_config[level].inclusion) != 0) return -1;
+    } else {
+        return 0;
+    }
+    return 2;
+}
+
+
+// 한 줄을 공백으로 나눠 base 구성 위에 적용한 새 컨텍스트를 만든다
+SimContext* sim_create_from_line(const SimContext* base, const char* config, int line_no) {
+    SimContext* ctx = sim_create();
+    if (ctx == NULL) {
+        fprintf(stderr, "Failed to allocate simulator context\n");
+        return NULL;
+    }
+
+    memcpy(ctx->cache_config, base->cache_config, sizeof(ctx->cache_config));
+    ctx->cache_seed = base->cache_seed;
+    ctx->prefetch_degree = base->prefetch_degree;
+    ctx->memory_latency = base->memory_latency;
+    ctx->ff_insts = base->ff_insts;
+    ctx->ff_use_pc = base->ff_use_pc;
+    ctx->ff_stop_pc = base->ff_stop_pc;
+    ctx->ff_warm = base->ff_warm;
+    ctx->bp_kind = base->bp_kind;
+    ctx->bp_budget = base->bp_budget;
+    ctx->btb_entries = base->btb_entries;
+    ctx->ras_depth = base->ras_depth;
+    ctx->mispredict_penalty = base->mispredict_penalty;
+    ctx->mshr_entries = base->mshr_entries;
+    ctx->restore_path = base->restore_path;
+
+    char* copy = strdup(config);
+    char* args[CONFIG_MAX_ARGS];
+    int argc = 0;
+    char* save = NULL;
+
+    for (char* tok = strtok_r(copy, " \t", &save); tok != NULL && argc < CONFIG_MAX_ARGS;
+         tok = strtok_r(NULL, " \t", &save)) {
+        args[argc++] = tok;
+    }
+
+    for (int i = 0; i < argc; ) {
+        int used = sim_apply_option(ctx, argc, args, i);
+        if (used <= 0) {
+            if (used == 0) {
+                fprintf(stderr, "line %d: unknown option '%s'\n", line_no, args[i]);
+            }
+            free(copy);
+            sim_destroy(ctx);
+            return NULL;
+        }
+        i += used;
+    }
+
+    free(copy);
+
+    // 잘못된 구성은 실행 전에 줄 번호와 함께 알린다
+    SimContext* saved = sim;
+    sim = ctx;
+    int status = validate_cache_config();
+    sim = saved;
+    if (status != 0) {
+        fprintf(stderr, "line %d: invalid cache configuration\n", line_no);
+        sim_destroy(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+// 구성 파일의 각 줄(빈 줄과 # 주석은 건너뜀)로 컨텍스트를 하나씩 만든다.
+// 만든 개수를 반환하고, 오류가 있으면 이미 만든 것까지 모두 해제하고 -1.
+int sim_read_config_file(const char* path, const SimContext* base,
+                         SimContext*** ctxs_out, char*** lines_out) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        perror("fopen");
+        return -1;
+    }
+
+    SimContext** ctxs = NULL;
+    char** lines = NULL;
+    int count = 0;
+    int capacity = 0;
+    char line[1024];
+    int line_no = 0;
+
+    while (fgets(line, sizeof(line), fp)) {
+        line_no++;
+        line[strcspn(line, "\r\n#")] = '\0';
+
+        const char* p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0') {
+            continue;
+        }
+
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            ctxs = realloc(ctxs, sizeof(SimContext*) * capacity);
+            lines = realloc(lines, sizeof(char*) * capacity);
+        }
+
+        ctxs[count] = sim_create_from_line(base, p, line_no);
+        if (ctxs[count] == NULL) {
+            fclose(fp);
+            for (int i = 0; i < count; i++) {
+                sim_destroy(ctxs[i]);
+                free(lines[i]);
+            }
+            free(ctxs);
+            free(lines);
+            return -1;
+        }
+        lines[count] = strdup(p);
+        count++;
+    }
+
+    fclose(fp);
+    *ctxs_out = ctxs;
+    *lines_out = lines;
+    return count;
+}
@@ -0,0 +1,227 @@
+#include "structure.h"
+#include <stdlib.h>
+
+// PC로 인덱싱되는 direct-mapped 디코드 테이블
+#define DECODE_CACHE_SIZE 4096
+#define DECODE_CACHE_MASK (DECODE_CACHE_SIZE - 1)
+
+struct DecodeTable {
+    DecodedInst entries[DECODE_CACHE_SIZE];
+
+    // 텍스트 영역 (이 범위에 대한 SW만 테이블을 무효화)
+    uint32_t text_start;
+    uint32_t text_end;
+
+    uint64_t hits;
+    uint64_t misses;
+};
+
+void init_decode_cache(uint32_t start, uint32_t end) {
+    if (sim->decode == NULL) {
+        sim->decode = malloc(sizeof(struct DecodeTable));
+        if (sim->decode == NULL) {
+            fprintf(stderr, "decode table: out of memory\n");
+            exit(1);
+        }
+    }
+    memset(sim->decode, 0, sizeof(*sim->decode));
+    sim->decode->text_start = start;
+    sim->decode->text_end = end;
+}
+
+// 디코드된 엔트리는 이름 문자열 포인터를 담고 있고 다시 채우면 되므로 저장하지 않는다
+void decode_cache_checkpoint(Checkpoint* ck) {
+    if (sim->decode == NULL) {
+        init_decode_cache(0, 0);
+    }
+    ckpt_region(ck, &sim->decode->text_start, sizeof(sim->decode->text_start));
+    ckpt_region(ck, &sim->decode->text_end, sizeof(sim->decode->text_end));
+    ckpt_region(ck, &sim->decode->hits, sizeof(sim->decode->hits));
+    ckpt_region(ck, &sim->decode->misses, sizeof(sim->decode->misses));
+}
+
+// 시간 여행으로 메모리를 되돌린 뒤에는 텍스트가 달랐을 수 있으므로 엔트리를 모두 버린다
+void decode_cache_clear(void) {
+    memset(sim->decode->entries, 0, sizeof(sim->decode->entries));
+}
+
+void free_decode_cache(void) {
+    free(sim->decode);
+    sim->decode = NULL;
+}
+
+static inline uint32_t get_decode_index(uint32_t pc) {
+    return (pc >> 2) & DECODE_CACHE_MASK;
+}
+
+// stage_ID가 하던 필드 추출, 제어 신호 설정, 즉시값 확장을 한 번에 수행
+static void decode_fill(DecodedInst* entry, uint32_t pc, uint32_t instruction) {
+    memset(entry, 0, sizeof(*entry));
+
+    Instruction* inst = &entry->inst;
+    Control_Signals* ctrl = &entry->ctrl;
+
+    inst->opcode = instruction >> 26;
+    inst->rs = (instruction >> 21) & 0x1f;
+    inst->rt = (instruction >> 16) & 0x1f;
+    inst->funct = instruction & 0x3f;
+
+    // R-type
+    if (inst->opcode == 0) {
+        inst->rd = (instruction >> 11) & 0x1f;
+        inst->shamt = (instruction >> 6) & 0x1f;
+    }
+
+    // J-type
+    if (inst->opcode == 2 || inst->opcode == 3) {
+        inst->jump_target = instruction & 0x3ffffff;
+    }
+
+    setup_control_signals(inst, ctrl);
+
+    if (ctrl->reg_dst == 1) {
+        entry->write_reg = inst->rd;
+    }
+
+    if (ctrl->get_imm != 0) {
+        uint32_t imm = instruction & 0xffff;
+        entry->write_reg = inst->rt;
+
+        if (ctrl->get_imm == 1) {           // 부호 확장
+            imm = (imm >> 15) ? (imm | 0xffff0000) : imm;
+        } else if (ctrl->get_imm == 3) {    // lui
+            imm = imm << 16;
+        }
+        inst->immediate = imm;
+    }
+
+    // 분기 오프셋 (PC+4 기준, 워드 단위 -> 바이트 단위)
+    uint32_t off = instruction & 0xffff;
+    entry->branch_offset = (off >> 15) ? ((off << 2) | 0xfffc0000) : ((off << 2) & 0x3ffc);
+
+    if (ctrl->ex_skip == 1) {
+        if (inst->opcode == 0x4 || inst->opcode == 0x5) {
+            entry->kind = DECODE_BRANCH;
+        } else if (inst->opcode == 0x2) {
+            entry->kind = DECODE_J;
+        } else if (inst->opcode == 0x3) {
+            entry->kind = DECODE_JAL;
+        } else {
+            entry->kind = DECODE_JR;
+        }
+    } else {
+        entry->kind = DECODE_ALU;
+    }
+
+    entry->name = get_instruction_name(inst->opcode, inst->funct);
+    entry->pc = pc;
+    entry->instruction = instruction;
+    entry->valid = true;
+}
+
+const DecodedInst* decode_lookup(uint32_t pc, uint32_t instruction) {
+    DecodedInst* entry = &sim->decode->entries[get_decode_index(pc)];
+
+    if (entry->valid && entry->pc == pc && entry->instruction == instruction) {
+        sim->decode->hits++;
+        return entry;
+    }
+
+    sim->decode->misses++;
+    decode_fill(entry, pc, instruction);
+    return entry;
+}
+
+void decode_cache_invalidate(uint32_t address) {
+    if (address + 4 <= sim->decode->text_start || address >= sim->decode->text_end) {
+        return;
+    }
+
+    // 정렬되지 않은 SW가 두 워드에 걸칠 수 있으므로 양쪽 모두 무효화
+    uint32_t first = address & ~0x3u;
+    for (uint32_t pc = first; pc < address + 4; pc += 4) {
+        DecodedInst* entry = &sim->decode->entries[get_decode_index(pc)];
+        if (entry->valid && entry->pc == pc) {
+            entry->valid = false;
+        }
+    }
+}
+
+const char* get_instruction_name(uint32_t opcode, uint32_t funct) {
+    switch (opcode) {
+        case 0:
+            switch (funct) {
+                case 0x20: return "add";
+                case 0x21: return "addu";
+                case 0x22: return "sub";
+                case 0x23: return "subu";
+                case 0x24: return "and";
+                case 0x25: return "or";
+                case 0x27: return "nor";
+                case 0x2a: return "slt";
+                case 0x2b: return "sltu";
+                case 0x00: return "sll";
+                case 0x02: return "srl";
+                case 0x08: return "jr";
+                case 0x09: return "jalr";
+                default: return "unknown_r";
+            }
+        case 2: return "j";
+        case 3: return "jal";
+        case 4: return "beq";
+        case 5: return "bne";
+        case 8: return "addi";
+        case 9: return "addiu";
+        case 10: return "slti";
+        case 11: return "sltiu";
+        case 12: return "andi";
+        case 13: return "ori";
+        case 15: return "lui";
+        case 35: return "lw";
+        case 43: return "sw";
+        default: return "unknown";
+    }
+}
+
+void print_instruction_details(uint32_t pc, uint32_t instruction) {
+    uint32_t opcode = instruction >> 26;
+    uint32_t rs = (instruction >> 21) & 0x1f;
+    uint32_t rt = (instruction >> 16) & 0x1f;
+    uint32_t rd = (instruction >> 11) & 0x1f;
+    uint32_t shamt = (instruction >> 6) & 0x1f;
+    uint32_t funct = instruction & 0x3f;
+    uint32_t immediate = instruction & 0xffff;
+    uint32_t jump_target = instruction & 0x3ffffff;
+    
+    const char* inst_name = get_instruction_name(opcode, funct);
+    
+    printf("PC=0x%08x, Inst=0x%08x, %s ", pc, instruction, inst_name);
+    
+    // 명령어 타입별 상세 출력
+    if (opcode == 0) { // R-type
+        if (funct == 0x08) { // jr
+            printf("$%d", rs);
+        } else if (funct == 0x00 || funct == 0x02) { // sll, srl
+            printf("$%d, $%d, %d", rd, rt, shamt);
+        } else {
+            printf("$%d, $%d, $%d", rd, rs, rt);
+        }
+    } else if (opcode == 2 || opcode == 3) { // j, jal
+        printf("0x%x", jump_target << 2);
+    } else if (opcode == 4 || opcode == 5) { // beq, bne
+        int16_t signed_imm = (int16_t)immediate;
+        printf("$%d, $%d, %d", rs, rt, signed_imm);
+    } else if (opcode == 35 || opcode == 43) { // lw, sw
+        int16_t signed_imm = (int16_t)immediate;
+        printf("$%d, %d($%d)", rt, signed_imm, rs);
+    } else if (opcode == 15) { // lui
+        printf("$%d, 0x%x", rt, immediate);
+    } else { // I-type
+        if (opcode == 12 || opcode == 13) { // andi, ori (zero-extended)
+            printf("$%d, $%d, 0x%x", rt, rs, immediate);
+        } else { // sign-extended
+            int16_t signed_imm = (int16_t)immediate;
+            printf("$%d, $%d, %d", rt, rs, signed_imm);
+        }
+    }
+}
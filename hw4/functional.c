@@ -0,0 +1,193 @@
+#include "structure.h"
+
+// 빠른 기능 시뮬레이션 (fast-forward)
+// 파이프라인 타이밍 없이 명령어를 하나씩 아키텍처 수준에서 실행한다.
+// 의미는 5단 파이프라인과 동일하게 맞춘다 (jal은 PC+8을 R31에 저장,
+// 분기 지연 슬롯 없음, 데이터 워드는 빅엔디안으로 메모리에 저장).
+
+
+static uint32_t ff_fetch(uint32_t pc, bool warm) {
+    if (warm) {
+        return cache_read_instruction(pc);
+    }
+    // I-캐시와 같은 바이트 순서 (리틀엔디안)
+    const uint8_t* p = mem_read_page(&sim->memory, pc) + (pc & MEM_PAGE_MASK);
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t ff_load(uint32_t pc, uint32_t address, bool warm) {
+    if (address + 4 > MEMORY_SIZE) {
+        return 0;
+    }
+    if (warm) {
+        return cache_read_data(address, pc);
+    }
+    // D-캐시와 같은 바이트 순서 (빅엔디안)
+    uint8_t b[4];
+    mem_read(&sim->memory, address, b, 4);
+    return ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | (uint32_t)b[3];
+}
+
+static void ff_store(uint32_t pc, uint32_t address, uint32_t data, bool warm) {
+    if (address + 4 > MEMORY_SIZE) {
+        return;
+    }
+    if (warm) {
+        cache_write_data(address, data, pc);
+    } else {
+        uint8_t b[4] = {data >> 24, (data >> 16) & 0xFF, (data >> 8) & 0xFF, data & 0xFF};
+        mem_write(&sim->memory, address, b, 4);
+    }
+    decode_cache_invalidate(address);
+}
+
+// 워밍: IF의 BTB 조회와 ID의 결과 반영을 한 번에
+static void warm_target_predictor(uint32_t pc, ControlFlowKind kind, uint32_t target, bool taken) {
+    bool hit;
+    predict_fetch_target(pc, taken, &hit);
+    resolve_control_flow(pc, kind, target, taken, hit);
+}
+
+// 명령어 하나를 실행한다. 프로그램이 끝났으면 false.
+bool functional_step(bool warm) {
+    uint32_t pc = sim->registers.pc;
+
+    if (pc == 0xFFFFFFFF || (pc & 0x3) || pc + 3 >= MEMORY_SIZE) {
+        return false;
+    }
+
+    uint32_t instruction = ff_fetch(pc, warm);
+    const DecodedInst* dec = decode_lookup(pc, instruction);
+    const Control_Signals* ctrl = &dec->ctrl;
+    const Instruction* inst = &dec->inst;
+
+    sim->ff_inst_count++;
+    sim->registers.pc = pc + 4;
+
+    if (BINTRACE_ON() && (dec->kind == DECODE_J || dec->kind == DECODE_JAL || dec->kind == DECODE_JR)) {
+        bintrace_record(pc, instruction, BT_JUMP | BT_TAKEN, 0);
+    }
+
+    switch (dec->kind) {
+        case DECODE_BRANCH: {
+            bool equal = (sim->registers.regs[inst->rs] == sim->registers.regs[inst->rt]);
+            bool taken = (inst->opcode == 0x4) ? equal : !equal;
+            if (warm) {
+                bool predicted = predict_branch(pc);
+                update_branch_predictor(pc, taken, predicted);
+                warm_target_predictor(pc, CF_BRANCH, pc + 4 + dec->branch_offset, taken);
+            }
+            if (taken) {
+                sim->registers.pc = pc + 4 + dec->branch_offset;
+            }
+            if (BINTRACE_ON()) {
+                bintrace_record(pc, instruction, BT_BRANCH | (taken ? BT_TAKEN : 0), 0);
+            }
+            return true;
+        }
+        case DECODE_J:
+            sim->registers.pc = inst->jump_target << 2;
+            if (warm) {
+                warm_target_predictor(pc, CF_JUMP, sim->registers.pc, true);
+            }
+            return true;
+        case DECODE_JAL:
+            sim->registers.regs[31] = pc + 8;
+            sim->registers.pc = inst->jump_target << 2;
+            if (warm) {
+                warm_target_predictor(pc, CF_CALL, sim->registers.pc, true);
+            }
+            return true;
+        case DECODE_JR:
+            sim->registers.pc = sim->registers.regs[inst->rs];
+            if (warm) {
+                warm_target_predictor(pc, (inst->rs == 31) ? CF_RETURN : CF_INDIRECT, sim->registers.pc, true);
+            }
+            return true;
+        case DECODE_ALU:
+            break;
+    }
+
+    uint32_t rs_value = sim->registers.regs[inst->rs];
+    uint32_t rt_value = sim->registers.regs[inst->rt];
+
+    // lui: EX/MEM을 그대로 통과
+    if (ctrl->get_imm == 3) {
+        if (BINTRACE_ON()) {
+            bintrace_record(pc, instruction, 0, 0);
+        }
+        if (dec->write_reg != 0) {
+            sim->registers.regs[dec->write_reg] = inst->immediate;
+        }
+        return true;
+    }
+
+    // stage_EX와 같은 피연산자 선택
+    uint32_t alu_result;
+    Instruction tmp = *inst;
+    if (ctrl->reg_dst == 1) {
+        if (ctrl->alu_ctrl >= 0b1110) {
+            alu_result = alu_operate(rt_value, inst->shamt, ctrl->alu_ctrl, &tmp);
+        } else {
+            alu_result = alu_operate(rs_value, rt_value, ctrl->alu_ctrl, &tmp);
+        }
+    } else {
+        alu_result = alu_operate(rs_value, inst->immediate, ctrl->alu_ctrl, &tmp);
+    }
+
+    if (BINTRACE_ON()) {
+        uint8_t flags = (ctrl->mem_read ? BT_LOAD : 0) | (ctrl->mem_write ? BT_STORE : 0);
+        bintrace_record(pc, instruction, flags, alu_result);
+    }
+
+    uint32_t mem_data = 0;
+    if (ctrl->mem_read) {
+        mem_data = ff_load(pc, alu_result, warm);
+    }
+    if (ctrl->mem_write) {
+        ff_store(pc, alu_result, rt_value, warm);
+    }
+
+    // stage_WB와 동일하게 write_reg를 그대로 사용
+    if (ctrl->reg_wb == 1) {
+        sim->registers.regs[dec->write_reg] = ctrl->mem_read ? mem_data : alu_result;
+    }
+    return true;
+}
+
+// max_insts 개를 실행하거나 PC가 stop_pc에 도달하면 멈춘다.
+// 캐시/예측기를 워밍했으면 통계는 비우고 상태만 남긴다.
+uint64_t fast_forward(uint64_t max_insts, bool use_stop_pc, uint32_t stop_pc, bool warm) {
+    unsigned int saved_mask = trace_mask;
+    uint64_t start = sim->ff_inst_count;
+
+    // 워밍 중 캐시 트레이스 출력 억제 (이미 0이면 전역 변수에 쓰지 않음:
+    // 병렬 스윕에서는 여러 스레드가 동시에 fast-forward한다)
+    if (saved_mask != 0) {
+        trace_mask = 0;
+    }
+
+    while (sim->ff_inst_count - start < max_insts) {
+        if (use_stop_pc && sim->registers.pc == stop_pc) {
+            break;
+        }
+        if (!functional_step(warm)) {
+            break;
+        }
+    }
+
+    if (saved_mask != 0) {
+        trace_mask = saved_mask;
+    }
+
+    if (warm) {
+        reset_cache_statistics();
+        if (sim->cache_sweep_enabled) {
+            reset_cache_sweep_statistics();
+        }
+        reset_branch_predictor();
+        reset_target_predictor();
+    }
+
+    return sim->ff_inst_count - start;
+}
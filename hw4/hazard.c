@@ -1,60 +1,58 @@
 #include "structure.h"
 
-static uint64_t stall_count = 0;
-
 ForwardingUnit detect_forwarding(void) {
     ForwardingUnit unit = {0, 0};
     
-    if (!id_ex_latch.valid) {
+    if (!sim->id_ex_latch.valid) {
         return unit;
     }
 
     // EX 단계 포워딩 검출
-    if (id_ex_latch.control_signals.rs_ch == 1 && id_ex_latch.control_signals.ex_skip == 0) {
+    if (sim->id_ex_latch.control_signals.rs_ch == 1 && sim->id_ex_latch.control_signals.ex_skip == 0) {
         int temp1 = 0;
         
         // EX/MEM에서 포워딩
-        if (ex_mem_latch.valid && ex_mem_latch.control_signals.reg_wb == 1 && 
-            ex_mem_latch.write_reg != 0 && id_ex_latch.instruction.rs == ex_mem_latch.write_reg) {
-            id_ex_latch.forward_a = 0b10;
-            if (ex_mem_latch.control_signals.mem_read != 1) {
-                id_ex_latch.forward_a_val = ex_mem_latch.alu_result;
+        if (sim->ex_mem_latch.valid && sim->ex_mem_latch.control_signals.reg_wb == 1 && 
+            sim->ex_mem_latch.write_reg != 0 && sim->id_ex_latch.instruction.rs == sim->ex_mem_latch.write_reg) {
+            sim->id_ex_latch.forward_a = 0b10;
+            if (sim->ex_mem_latch.control_signals.mem_read != 1) {
+                sim->id_ex_latch.forward_a_val = sim->ex_mem_latch.alu_result;
             }
             temp1 = 1;
-            printf("[HAZARD] EX forwarding: R%d from EX/MEM\n", id_ex_latch.instruction.rs);
+            TRACE(TRACE_HAZARD, "[HAZARD] EX forwarding: R%d from EX/MEM\n", sim->id_ex_latch.instruction.rs);
         }
         
         // MEM/WB에서 포워딩 (EX/MEM에서 포워딩이 없을 때만)
-        if ((temp1 == 0) && mem_wb_latch.valid && mem_wb_latch.control_signals.reg_wb == 1 && 
-            id_ex_latch.instruction.rs == mem_wb_latch.write_reg) {
-            id_ex_latch.forward_a = 0b01;
-            id_ex_latch.forward_a_val = (mem_wb_latch.control_signals.mem_read == 1) ? 
-                                        mem_wb_latch.rt_value : mem_wb_latch.alu_result;
-            printf("[HAZARD] MEM forwarding: R%d from MEM/WB\n", id_ex_latch.instruction.rs);
+        if ((temp1 == 0) && sim->mem_wb_latch.valid && sim->mem_wb_latch.control_signals.reg_wb == 1 && 
+            sim->id_ex_latch.instruction.rs == sim->mem_wb_latch.write_reg) {
+            sim->id_ex_latch.forward_a = 0b01;
+            sim->id_ex_latch.forward_a_val = (sim->mem_wb_latch.control_signals.mem_read == 1) ? 
+                                        sim->mem_wb_latch.rt_value : sim->mem_wb_latch.alu_result;
+            TRACE(TRACE_HAZARD, "[HAZARD] MEM forwarding: R%d from MEM/WB\n", sim->id_ex_latch.instruction.rs);
         }
     }
 
-    if (id_ex_latch.control_signals.rt_ch == 1 && id_ex_latch.control_signals.ex_skip == 0) {
+    if (sim->id_ex_latch.control_signals.rt_ch == 1 && sim->id_ex_latch.control_signals.ex_skip == 0) {
         int temp2 = 0;
         
         // EX/MEM에서 포워딩
-        if (ex_mem_latch.valid && ex_mem_latch.control_signals.reg_wb == 1 && 
-            ex_mem_latch.write_reg != 0 && id_ex_latch.instruction.rt == ex_mem_latch.write_reg) {
-            id_ex_latch.forward_b = 0b10;
-            if (ex_mem_latch.control_signals.mem_read != 1) {
-                id_ex_latch.forward_b_val = ex_mem_latch.alu_result;
+        if (sim->ex_mem_latch.valid && sim->ex_mem_latch.control_signals.reg_wb == 1 && 
+            sim->ex_mem_latch.write_reg != 0 && sim->id_ex_latch.instruction.rt == sim->ex_mem_latch.write_reg) {
+            sim->id_ex_latch.forward_b = 0b10;
+            if (sim->ex_mem_latch.control_signals.mem_read != 1) {
+                sim->id_ex_latch.forward_b_val = sim->ex_mem_latch.alu_result;
             }
             temp2 = 1;
-            printf("[HAZARD] EX forwarding: R%d from EX/MEM\n", id_ex_latch.instruction.rt);
+            TRACE(TRACE_HAZARD, "[HAZARD] EX forwarding: R%d from EX/MEM\n", sim->id_ex_latch.instruction.rt);
         }
         
         // MEM/WB에서 포워딩
-        if ((temp2 == 0) && mem_wb_latch.valid && mem_wb_latch.control_signals.reg_wb == 1 && 
-            id_ex_latch.instruction.rt == mem_wb_latch.write_reg) {
-            id_ex_latch.forward_b = 0b01;
-            id_ex_latch.forward_b_val = (mem_wb_latch.control_signals.mem_read == 1) ? 
-                                        mem_wb_latch.rt_value : mem_wb_latch.alu_result;
-            printf("[HAZARD] MEM forwarding: R%d from MEM/WB\n", id_ex_latch.instruction.rt);
+        if ((temp2 == 0) && sim->mem_wb_latch.valid && sim->mem_wb_latch.control_signals.reg_wb == 1 && 
+            sim->id_ex_latch.instruction.rt == sim->mem_wb_latch.write_reg) {
+            sim->id_ex_latch.forward_b = 0b01;
+            sim->id_ex_latch.forward_b_val = (sim->mem_wb_latch.control_signals.mem_read == 1) ? 
+                                        sim->mem_wb_latch.rt_value : sim->mem_wb_latch.alu_result;
+            TRACE(TRACE_HAZARD, "[HAZARD] MEM forwarding: R%d from MEM/WB\n", sim->id_ex_latch.instruction.rt);
         }
     }
 
@@ -64,12 +62,12 @@ ForwardingUnit detect_forwarding(void) {
 ForwardingUnit detect_branch_forwarding(void) {
     ForwardingUnit unit = {0, 0};
     
-    if (!if_id_latch.valid) {
+    if (!sim->if_id_latch.valid) {
         return unit;
     }
 
-    uint32_t opcode = if_id_latch.opcode;
-    uint32_t funct = if_id_latch.funct;
+    uint32_t opcode = sim->if_id_latch.opcode;
+    uint32_t funct = sim->if_id_latch.funct;
     
     // 브랜치 또는 JR 명령어가 아니면 리턴
     if (!((opcode == 0x4 || opcode == 0x5) || (opcode == 0x0 && funct == 0x08))) {
@@ -77,30 +75,30 @@ ForwardingUnit detect_branch_forwarding(void) {
     }
 
     // EX/MEM 단계에서 포워딩
-    if (ex_mem_latch.valid && ex_mem_latch.control_signals.reg_wb && ex_mem_latch.write_reg != 0) {
+    if (sim->ex_mem_latch.valid && sim->ex_mem_latch.control_signals.reg_wb && sim->ex_mem_latch.write_reg != 0) {
         
-        if (ex_mem_latch.write_reg == if_id_latch.reg_src) {
-            if_id_latch.forward_a = 0b01;
-            printf("[HAZARD] Branch forwarding: R%d from EX/MEM\n", if_id_latch.reg_src);
+        if (sim->ex_mem_latch.write_reg == sim->if_id_latch.reg_src) {
+            sim->if_id_latch.forward_a = 0b01;
+            TRACE(TRACE_HAZARD, "[HAZARD] Branch forwarding: R%d from EX/MEM\n", sim->if_id_latch.reg_src);
         }
         
-        if ((opcode == 0x4 || opcode == 0x5) && ex_mem_latch.write_reg == if_id_latch.reg_tar) {
-            if_id_latch.forward_b = 0b01;
-            printf("[HAZARD] Branch forwarding: R%d from EX/MEM\n", if_id_latch.reg_tar);
+        if ((opcode == 0x4 || opcode == 0x5) && sim->ex_mem_latch.write_reg == sim->if_id_latch.reg_tar) {
+            sim->if_id_latch.forward_b = 0b01;
+            TRACE(TRACE_HAZARD, "[HAZARD] Branch forwarding: R%d from EX/MEM\n", sim->if_id_latch.reg_tar);
         }
     }
 
     // ID/EX 단계에서 포워딩
-    if (id_ex_latch.valid && id_ex_latch.control_signals.reg_wb && id_ex_latch.write_reg != 0) {
+    if (sim->id_ex_latch.valid && sim->id_ex_latch.control_signals.reg_wb && sim->id_ex_latch.write_reg != 0) {
         
-        if (id_ex_latch.write_reg == if_id_latch.reg_src) {
-            if_id_latch.forward_a = 0b10;
-            printf("[HAZARD] Branch forwarding: R%d from ID/EX\n", if_id_latch.reg_src);
+        if (sim->id_ex_latch.write_reg == sim->if_id_latch.reg_src) {
+            sim->if_id_latch.forward_a = 0b10;
+            TRACE(TRACE_HAZARD, "[HAZARD] Branch forwarding: R%d from ID/EX\n", sim->if_id_latch.reg_src);
         }
         
-        if ((opcode == 0x4 || opcode == 0x5) && id_ex_latch.write_reg == if_id_latch.reg_tar) {
-            if_id_latch.forward_b = 0b10;
-            printf("[HAZARD] Branch forwarding: R%d from ID/EX\n", if_id_latch.reg_tar);
+        if ((opcode == 0x4 || opcode == 0x5) && sim->id_ex_latch.write_reg == sim->if_id_latch.reg_tar) {
+            sim->if_id_latch.forward_b = 0b10;
+            TRACE(TRACE_HAZARD, "[HAZARD] Branch forwarding: R%d from ID/EX\n", sim->if_id_latch.reg_tar);
         }
     }
 
@@ -111,20 +109,20 @@ HazardUnit detect_hazard(void) {
     HazardUnit unit = {false, false};
     
     // Load 명령어가 ID/EX에 없으면 해저드 없음
-    if (!id_ex_latch.valid || !id_ex_latch.control_signals.mem_read) {
+    if (!sim->id_ex_latch.valid || !sim->id_ex_latch.control_signals.mem_read) {
         return unit;
     }
     
     // 다음 명령어가 없으면 해저드 없음
-    if (!if_id_latch.valid) {
+    if (!sim->if_id_latch.valid) {
         return unit;
     }
     
-    uint32_t lw_dest = id_ex_latch.write_reg;
-    uint32_t next_rs = if_id_latch.reg_src;
-    uint32_t next_rt = if_id_latch.reg_tar;
-    uint32_t next_opcode = if_id_latch.opcode;
-    uint32_t next_funct = if_id_latch.funct;
+    uint32_t lw_dest = sim->id_ex_latch.write_reg;
+    uint32_t next_rs = sim->if_id_latch.reg_src;
+    uint32_t next_rt = sim->if_id_latch.reg_tar;
+    uint32_t next_opcode = sim->if_id_latch.opcode;
+    uint32_t next_funct = sim->if_id_latch.funct;
     
     if (lw_dest == 0) {
         return unit;
@@ -159,8 +157,8 @@ HazardUnit detect_hazard(void) {
     
     if (load_use_hazard) {
         unit.stall = true;
-        printf("[HAZARD] Load-use hazard detected! LW dest: R%d\n", lw_dest);
-        stall_count++;
+        TRACE(TRACE_HAZARD, "[HAZARD] Load-use hazard detected! LW dest: R%d\n", lw_dest);
+        sim->stall_count++;
     }
     
     return unit;
@@ -169,20 +167,20 @@ HazardUnit detect_hazard(void) {
 uint32_t get_forwarded_value(int forward_type, uint32_t original_value) {
     switch (forward_type) {
         case 1: // MEM/WB에서 포워딩
-            if (!mem_wb_latch.valid) {
+            if (!sim->mem_wb_latch.valid) {
                 return original_value;
             }
-            if (mem_wb_latch.control_signals.mem_read == 1) {
-                return mem_wb_latch.rt_value;
+            if (sim->mem_wb_latch.control_signals.mem_read == 1) {
+                return sim->mem_wb_latch.rt_value;
             } else {
-                return mem_wb_latch.alu_result;
+                return sim->mem_wb_latch.alu_result;
             }
             
         case 2: // EX/MEM에서 포워딩
-            if (!ex_mem_latch.valid) {
+            if (!sim->ex_mem_latch.valid) {
                 return original_value;
             }
-            return ex_mem_latch.alu_result;
+            return sim->ex_mem_latch.alu_result;
             
         default:
             return original_value;
@@ -191,13 +189,13 @@ uint32_t get_forwarded_value(int forward_type, uint32_t original_value) {
 
 void handle_stall(void) {
     // PC를 되돌려서 같은 명령어를 다시 페치
-    registers.pc -= 4;
-    printf("[HAZARD] Pipeline stall: PC rolled back to 0x%08x\n", registers.pc);
+    sim->registers.pc -= 4;
+    TRACE(TRACE_HAZARD, "[HAZARD] Pipeline stall: PC rolled back to 0x%08x\n", sim->registers.pc);
 }
 
 void handle_branch_flush(void) {
     // 브랜치 미스예측 시 파이프라인 플러시
-    if_id_latch.valid = false;
-    id_ex_latch.valid = false;
-    printf("[HAZARD] Pipeline flush due to branch misprediction\n");
+    sim->if_id_latch.valid = false;
+    sim->id_ex_latch.valid = false;
+    TRACE(TRACE_HAZARD, "[HAZARD] Pipeline flush due to branch misprediction\n");
 }
\ No newline at end of file
@@ -0,0 +1,423 @@
+#define _POSIX_C_SOURCE 200809L
+#include "structure.h"
+#include <stdlib.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 프로그램 로더
+// 입력 파일을 mmap해서 세그먼트 단위로 게스트 메모리에 복사한다.
+//  - raw .bin : 빅엔디안 명령어 워드의 나열, load_addr에 배치
+//  - ELF32 실행 파일 (BE/LE) : PT_LOAD 세그먼트를 p_vaddr에, 엔트리는 e_entry
+//  - ELF32 재배치 파일 (.o) : 할당 섹션을 load_addr부터 차례로 놓고
+//    o32 REL 재배치(R_MIPS_32/26/HI16/LO16)를 적용
+//
+// 게스트 메모리의 바이트 순서: 명령어는 리틀엔디안(I-캐시), 데이터 워드는
+// 빅엔디안(D-캐시). 그래서 BE 파일은 텍스트만, LE 파일은 데이터만 워드 단위로 뒤집는다.
+
+#define EI_CLASS        4
+#define EI_DATA         5
+#define ELFCLASS32      1
+#define ELFDATA2LSB     1
+#define ELFDATA2MSB     2
+#define ET_REL          1
+#define ET_EXEC         2
+#define EM_MIPS         8
+#define PT_LOAD         1
+#define PF_X            1
+#define SHT_SYMTAB      2
+#define SHT_NOBITS      8
+#define SHT_REL         9
+#define SHF_ALLOC       0x2
+#define SHF_EXECINSTR   0x4
+#define SHN_UNDEF       0
+#define SHN_ABS         0xfff1
+#define ELF_PHDR_SIZE   32
+#define ELF_SHDR_SIZE   40
+#define ELF_SYM_SIZE    16
+#define STB_LOCAL       0
+
+#define R_MIPS_NONE     0
+#define R_MIPS_32       2
+#define R_MIPS_26       4
+#define R_MIPS_HI16     5
+#define R_MIPS_LO16     6
+
+typedef struct {
+    uint8_t* data;              // MAP_PRIVATE: 재배치 패치는 파일에 반영되지 않음
+    size_t size;
+    bool big_endian;
+    uint32_t text_start;        // 디코드 테이블 무효화 범위
+    uint32_t text_end;
+} LoadImage;
+
+static uint32_t rd16(const LoadImage* img, size_t off) {
+    const uint8_t* p = img->data + off;
+    return img->big_endian ? (uint32_t)(p[0] << 8 | p[1]) : (uint32_t)(p[1] << 8 | p[0]);
+}
+
+static uint32_t rd32(const LoadImage* img, size_t off) {
+    const uint8_t* p = img->data + off;
+    if (img->big_endian) {
+        return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+    }
+    return (uint32_t)p[3] << 24 | (uint32_t)p[2] << 16 | (uint32_t)p[1] << 8 | p[0];
+}
+
+static void wr32(LoadImage* img, size_t off, uint32_t v) {
+    uint8_t* p = img->data + off;
+    for (int i = 0; i < 4; i++) {
+        int shift = img->big_endian ? 8 * (3 - i) : 8 * i;
+        p[i] = (v >> shift) & 0xFF;
+    }
+}
+
+// size 바이트를 게스트 주소 addr에 복사. swap이면 4바이트 워드마다 뒤집는다.
+// 워드가 안 되는 마지막 1~3바이트는 나머지를 0으로 채운 워드로 뒤집는다.
+static int copy_to_guest(uint32_t addr, const uint8_t* src, size_t size, bool swap) {
+    size_t span = swap ? (size + 3) & ~(size_t)3 : size;
+    if (addr >= MEMORY_SIZE || span > MEMORY_SIZE - addr) {
+        fprintf(stderr, "Program too big for memory.\n");
+        return -1;
+    }
+    if (!swap) {
+        mem_write(&sim->memory, addr, src, size);
+        return 0;
+    }
+
+    uint8_t buf[MEM_PAGE_SIZE];
+    while (size > 0) {
+        size_t chunk = size < sizeof(buf) ? size : sizeof(buf);
+        size_t padded = (chunk + 3) & ~(size_t)3;
+        for (size_t i = 0; i < padded; i += 4) {
+            for (size_t k = 0; k < 4; k++) {
+                buf[i + 3 - k] = (i + k < chunk) ? src[i + k] : 0;
+            }
+        }
+        mem_write(&sim->memory, addr, buf, padded);
+        addr += (uint32_t)chunk;
+        src += chunk;
+        size -= chunk;
+    }
+    return 0;
+}
+
+static void note_text(LoadImage* img, uint32_t start, uint32_t end) {
+    if (img->text_start == img->text_end) {
+        img->text_start = start;
+        img->text_end = end;
+        return;
+    }
+    if (start < img->text_start) img->text_start = start;
+    if (end > img->text_end) img->text_end = end;
+}
+
+static int load_section_bytes(LoadImage* img, uint32_t addr, size_t off, size_t size, bool exec) {
+    if (off > img->size || size > img->size - off) {
+        fprintf(stderr, "ELF: segment outside of file\n");
+        return -1;
+    }
+    // BE 파일: 텍스트를 리틀엔디안으로 / LE 파일: 데이터를 빅엔디안으로
+    bool swap = exec ? img->big_endian : !img->big_endian;
+    if (exec) {
+        note_text(img, addr, addr + (uint32_t)size);
+    }
+    return copy_to_guest(addr, img->data + off, size, swap);
+}
+
+static int load_elf_exec(LoadImage* img, uint32_t* entry_pc) {
+    uint32_t phoff = rd32(img, 28);
+    uint32_t phentsize = rd16(img, 42);
+    uint32_t phnum = rd16(img, 44);
+
+    if (phnum == 0 || phoff + (size_t)phnum * phentsize > img->size) {
+        fprintf(stderr, "ELF: no program headers\n");
+        return -1;
+    }
+    // 엔트리가 더 크면 뒤는 무시
+    if (phentsize < ELF_PHDR_SIZE) {
+        fprintf(stderr, "ELF: bad program header size %u\n", phentsize);
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < phnum; i++) {
+        size_t ph = phoff + (size_t)i * phentsize;
+        if (rd32(img, ph) != PT_LOAD) {
+            continue;
+        }
+        uint32_t offset = rd32(img, ph + 4);
+        uint32_t vaddr = rd32(img, ph + 8);
+        uint32_t filesz = rd32(img, ph + 16);
+        uint32_t memsz = rd32(img, ph + 20);
+        uint32_t flags = rd32(img, ph + 24);
+
+        if (offset > img->size || filesz > img->size - offset) {
+            fprintf(stderr, "ELF: segment outside of file\n");
+            return -1;
+        }
+        if (memsz > 0 && (vaddr >= MEMORY_SIZE || memsz > MEMORY_SIZE - vaddr)) {
+            fprintf(stderr, "Program too big for memory.\n");
+            return -1;
+        }
+        if (load_section_bytes(img, vaddr, offset, filesz, (flags & PF_X) != 0) != 0) {
+            return -1;
+        }
+        // filesz..memsz (.bss)는 새 컨텍스트의 메모리가 이미 0이므로 따로 쓰지 않는다
+        TRACE_INFO("  PT_LOAD 0x%08x: %u bytes (%u in file)%s\n",
+                   vaddr, memsz, filesz, (flags & PF_X) ? " [text]" : "");
+    }
+
+    *entry_pc = rd32(img, 24);
+    return 0;
+}
+
+// 재배치 파일: 할당 섹션을 base부터 정렬해서 배치하고 REL 재배치를 적용
+static int load_elf_rel(LoadImage* img, uint32_t base, uint32_t* entry_pc) {
+    uint32_t shoff = rd32(img, 32);
+    uint32_t shentsize = rd16(img, 46);
+    uint32_t shnum = rd16(img, 48);
+
+    if (shnum == 0 || shoff + (size_t)shnum * shentsize > img->size) {
+        fprintf(stderr, "ELF: no section headers\n");
+        return -1;
+    }
+    if (shentsize < ELF_SHDR_SIZE) {
+        fprintf(stderr, "ELF: bad section header size %u\n", shentsize);
+        return -1;
+    }
+
+    uint32_t* sec_addr = calloc(shnum, sizeof(uint32_t));
+    if (sec_addr == NULL) {
+        fprintf(stderr, "ELF: out of memory\n");
+        return -1;
+    }
+    bool entry_set = false;
+    uint32_t next = base;
+    int status = -1;
+
+    // 1. 주소 배정 (텍스트를 먼저, 그 다음 데이터)
+    for (int pass = 0; pass < 2; pass++) {
+        for (uint32_t i = 0; i < shnum; i++) {
+            size_t sh = shoff + (size_t)i * shentsize;
+            uint32_t flags = rd32(img, sh + 8);
+            uint32_t size = rd32(img, sh + 20);
+            uint32_t align = rd32(img, sh + 32);
+            bool exec = (flags & SHF_EXECINSTR) != 0;
+
+            if (!(flags & SHF_ALLOC) || exec != (pass == 0)) {
+                continue;
+            }
+            if (align > 1) {
+                next = (next + align - 1) & ~(align - 1);
+            }
+            sec_addr[i] = next;
+            if (exec && !entry_set) {
+                *entry_pc = next;
+                entry_set = true;
+            }
+            next += size;
+        }
+    }
+
+    // 2. 재배치 (MAP_PRIVATE 매핑 위에서 파일 바이트 순서로 패치)
+    for (uint32_t i = 0; i < shnum; i++) {
+        size_t sh = shoff + (size_t)i * shentsize;
+        if (rd32(img, sh + 4) != SHT_REL) {
+            continue;
+        }
+        uint32_t target = rd32(img, sh + 28);
+        if (target >= shnum || !(rd32(img, shoff + (size_t)target * shentsize + 8) & SHF_ALLOC)) {
+            continue;       // .rel.pdr 등 로드하지 않는 섹션
+        }
+        size_t target_off = rd32(img, shoff + (size_t)target * shentsize + 16);
+        uint32_t target_size = rd32(img, shoff + (size_t)target * shentsize + 20);
+        uint32_t link = rd32(img, sh + 24);
+        if (link >= shnum) {
+            fprintf(stderr, "ELF: relocation section without a symbol table\n");
+            goto out;
+        }
+        size_t symtab = shoff + (size_t)link * shentsize;
+        size_t sym_off = rd32(img, symtab + 16);
+        uint32_t sym_size = rd32(img, symtab + 20);
+        uint32_t rel_off = rd32(img, sh + 16);
+        uint32_t rel_size = rd32(img, sh + 20);
+        // 패치하는 섹션, 심볼 테이블, 재배치 항목이 모두 파일 안에 있어야 한다
+        if (target_off + target_size > img->size || sym_off + sym_size > img->size ||
+            (size_t)rel_off + rel_size > img->size) {
+            fprintf(stderr, "ELF: relocation data outside of file\n");
+            goto out;
+        }
+        uint32_t hi_offsets[16];    // 하나의 LO16을 공유하는 HI16들
+        int hi_pending = 0;
+
+        for (uint32_t r = 0; r + 8 <= rel_size; r += 8) {
+            uint32_t offset = rd32(img, rel_off + r);
+            uint32_t info = rd32(img, rel_off + r + 4);
+            uint32_t type = info & 0xff;
+            if ((size_t)(info >> 8) * ELF_SYM_SIZE + ELF_SYM_SIZE > sym_size) {
+                fprintf(stderr, "ELF: relocation refers to a missing symbol\n");
+                goto out;
+            }
+            size_t sym = sym_off + (size_t)(info >> 8) * ELF_SYM_SIZE;
+            uint32_t shndx = rd16(img, sym + 14);
+            uint32_t value = rd32(img, sym + 4);
+            bool local = (img->data[sym + 12] >> 4) == STB_LOCAL;
+
+            if (type == R_MIPS_NONE) {
+                continue;
+            }
+            if (offset + 4 > target_size) {
+                fprintf(stderr, "ELF: relocation outside of section\n");
+                goto out;
+            }
+            if (shndx == SHN_UNDEF) {
+                fprintf(stderr, "ELF: undefined symbol in relocatable object\n");
+                goto out;
+            }
+            // SHN_COMMON 등 다른 특수 섹션 번호는 지원하지 않음
+            if (shndx != SHN_ABS && shndx >= shnum) {
+                fprintf(stderr, "ELF: unsupported symbol section index 0x%x\n", shndx);
+                goto out;
+            }
+
+            uint32_t S = (shndx == SHN_ABS) ? value : sec_addr[shndx] + value;
+            uint32_t P = sec_addr[target] + offset;
+            size_t at = target_off + offset;
+            uint32_t word = rd32(img, at);
+
+            switch (type) {
+                case R_MIPS_32:
+                    wr32(img, at, word + S);
+                    break;
+                case R_MIPS_26: {
+                    uint32_t A = (word & 0x3ffffff) << 2;
+                    uint32_t dest = local ? ((A | (P & 0xf0000000)) + S) : (((int32_t)(A << 4) >> 4) + S);
+                    wr32(img, at, (word & 0xfc000000) | ((dest >> 2) & 0x3ffffff));
+                    break;
+                }
+                case R_MIPS_HI16:
+                    // 짝이 되는 LO16에서 함께 계산
+                    if (hi_pending == 16) {
+                        fprintf(stderr, "ELF: too many R_MIPS_HI16 without R_MIPS_LO16\n");
+                        goto out;
+                    }
+                    hi_offsets[hi_pending++] = (uint32_t)at;
+                    break;
+                case R_MIPS_LO16: {
+                    int32_t lo = (int16_t)(word & 0xffff);
+                    for (int h = 0; h < hi_pending; h++) {
+                        uint32_t hi_word = rd32(img, hi_offsets[h]);
+                        uint32_t v = (hi_word << 16) + lo + S;
+                        wr32(img, hi_offsets[h], (hi_word & 0xffff0000) | (((v + 0x8000) >> 16) & 0xffff));
+                    }
+                    hi_pending = 0;
+                    wr32(img, at, (word & 0xffff0000) | ((lo + S) & 0xffff));
+                    break;
+                }
+                default:
+                    fprintf(stderr, "ELF: unsupported relocation type %u\n", type);
+                    goto out;
+            }
+        }
+    }
+
+    // 3. 섹션 복사 (.bss는 0이므로 생략)
+    for (uint32_t i = 0; i < shnum; i++) {
+        size_t sh = shoff + (size_t)i * shentsize;
+        uint32_t type = rd32(img, sh + 4);
+        uint32_t flags = rd32(img, sh + 8);
+        if (!(flags & SHF_ALLOC) || type == SHT_NOBITS) {
+            continue;
+        }
+        if (load_section_bytes(img, sec_addr[i], rd32(img, sh + 16), rd32(img, sh + 20),
+                               (flags & SHF_EXECINSTR) != 0) != 0) {
+            goto out;
+        }
+    }
+
+    if (!entry_set) {
+        *entry_pc = base;
+    }
+    status = 0;
+out:
+    free(sec_addr);
+    return status;
+}
+
+static int load_elf(LoadImage* img, uint32_t load_addr, uint32_t* entry_pc) {
+    if (img->size < 52 || img->data[EI_CLASS] != ELFCLASS32 ||
+        (img->data[EI_DATA] != ELFDATA2LSB && img->data[EI_DATA] != ELFDATA2MSB)) {
+        fprintf(stderr, "ELF: only ELF32 little/big-endian files are supported\n");
+        return -1;
+    }
+    img->big_endian = (img->data[EI_DATA] == ELFDATA2MSB);
+
+    if (rd16(img, 18) != EM_MIPS) {
+        fprintf(stderr, "ELF: not a MIPS file\n");
+        return -1;
+    }
+
+    switch (rd16(img, 16)) {
+        case ET_EXEC:
+            return load_elf_exec(img, entry_pc);
+        case ET_REL:
+            return load_elf_rel(img, load_addr, entry_pc);
+        default:
+            fprintf(stderr, "ELF: unsupported file type\n");
+            return -1;
+    }
+}
+
+// 성공하면 0, *entry_pc에 시작 주소 (raw 파일은 load_addr)
+int load_program(const char* filename, uint32_t load_addr, uint32_t* entry_pc) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        perror("open");
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        perror("fstat");
+        close(fd);
+        return -1;
+    }
+
+    LoadImage img = {NULL, (size_t)st.st_size, true, 0, 0};
+    if (img.size > 0) {
+        img.data = mmap(NULL, img.size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (img.data == MAP_FAILED) {
+            perror("mmap");
+            close(fd);
+            return -1;
+        }
+    }
+    close(fd);
+
+    int status;
+    bool is_elf = img.size >= 4 && memcmp(img.data, "\177ELF", 4) == 0;
+
+    if (is_elf) {
+        status = load_elf(&img, load_addr, entry_pc);
+    } else {
+        // raw: 빅엔디안 워드 나열 -> 텍스트
+        size_t size = img.size & ~(size_t)3;
+        note_text(&img, load_addr, load_addr + (uint32_t)size);
+        status = (size > 0) ? copy_to_guest(load_addr, img.data, size, true) : 0;
+        *entry_pc = load_addr;
+    }
+
+    if (img.data != NULL) {
+        munmap(img.data, img.size);
+    }
+    if (status != 0) {
+        return -1;
+    }
+
+    init_decode_cache(img.text_start, img.text_end);
+    TRACE_INFO("Loaded %s%s, text 0x%08x-0x%08x, entry 0x%08x\n", filename,
+               is_elf ? (img.big_endian ? " (ELF32 BE)" : " (ELF32 LE)") : "",
+               img.text_start, img.text_end, *entry_pc);
+    return 0;
+}
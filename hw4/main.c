@@ -1,168 +1,107 @@
 #include "structure.h"
 #include <stdlib.h>
 
-uint8_t memory[MEMORY_SIZE] = {0};
-Registers registers = {{0}, 0};
-IF_ID_Latch if_id_latch = {0};
-ID_EX_Latch id_ex_latch = {0};
-EX_MEM_Latch ex_mem_latch = {0};
-MEM_WB_Latch mem_wb_latch = {0};
-
-uint64_t inst_count = 0;        
-uint64_t r_count = 0;
-uint64_t i_count = 0; 
-uint64_t branch_jr_count = 0;
-uint64_t lw_count = 0;
-uint64_t sw_count = 0;
-uint64_t nop_count = 0;
-uint64_t write_reg_count = 0;
-uint64_t g_stall_count = 0;  
-uint64_t branch_predictions = 0;
-uint64_t branch_correct_predictions = 0;
-uint64_t branch_mispredictions = 0;
-
-const char* get_instruction_name(uint32_t opcode, uint32_t funct) {
-    switch (opcode) {
-        case 0:
-            switch (funct) {
-                case 0x20: return "add";
-                case 0x21: return "addu";
-                case 0x22: return "sub";
-                case 0x23: return "subu";
-                case 0x24: return "and";
-                case 0x25: return "or";
-                case 0x27: return "nor";
-                case 0x2a: return "slt";
-                case 0x2b: return "sltu";
-                case 0x00: return "sll";
-                case 0x02: return "srl";
-                case 0x08: return "jr";
-                case 0x09: return "jalr";
-                default: return "unknown_r";
-            }
-        case 2: return "j";
-        case 3: return "jal";
-        case 4: return "beq";
-        case 5: return "bne";
-        case 8: return "addi";
-        case 9: return "addiu";
-        case 10: return "slti";
-        case 11: return "sltiu";
-        case 12: return "andi";
-        case 13: return "ori";
-        case 15: return "lui";
-        case 35: return "lw";
-        case 43: return "sw";
-        default: return "unknown";
-    }
-}
-
-void print_instruction_details(uint32_t pc, uint32_t instruction) {
-    uint32_t opcode = instruction >> 26;
-    uint32_t rs = (instruction >> 21) & 0x1f;
-    uint32_t rt = (instruction >> 16) & 0x1f;
-    uint32_t rd = (instruction >> 11) & 0x1f;
-    uint32_t shamt = (instruction >> 6) & 0x1f;
-    uint32_t funct = instruction & 0x3f;
-    uint32_t immediate = instruction & 0xffff;
-    uint32_t jump_target = instruction & 0x3ffffff;
-    
-    const char* inst_name = get_instruction_name(opcode, funct);
-    
-    printf("PC=0x%08x, Inst=0x%08x, %s ", pc, instruction, inst_name);
-    
-    // 명령어 타입별 상세 출력
-    if (opcode == 0) { // R-type
-        if (funct == 0x08) { // jr
-            printf("$%d", rs);
-        } else if (funct == 0x00 || funct == 0x02) { // sll, srl
-            printf("$%d, $%d, %d", rd, rt, shamt);
-        } else {
-            printf("$%d, $%d, $%d", rd, rs, rt);
-        }
-    } else if (opcode == 2 || opcode == 3) { // j, jal
-        printf("0x%x", jump_target << 2);
-    } else if (opcode == 4 || opcode == 5) { // beq, bne
-        int16_t signed_imm = (int16_t)immediate;
-        printf("$%d, $%d, %d", rs, rt, signed_imm);
-    } else if (opcode == 35 || opcode == 43) { // lw, sw
-        int16_t signed_imm = (int16_t)immediate;
-        printf("$%d, %d($%d)", rt, signed_imm, rs);
-    } else if (opcode == 15) { // lui
-        printf("$%d, 0x%x", rt, immediate);
-    } else { // I-type
-        if (opcode == 12 || opcode == 13) { // andi, ori (zero-extended)
-            printf("$%d, $%d, 0x%x", rt, rs, immediate);
-        } else { // sign-extended
-            int16_t signed_imm = (int16_t)immediate;
-            printf("$%d, $%d, %d", rt, rs, signed_imm);
-        }
-    }
-}
-
 void clear_latches(void) {
-    memset(&if_id_latch, 0, sizeof(if_id_latch));
-    memset(&id_ex_latch, 0, sizeof(id_ex_latch));
-    memset(&ex_mem_latch, 0, sizeof(ex_mem_latch));
-    memset(&mem_wb_latch, 0, sizeof(mem_wb_latch));
+    memset(&sim->if_id_latch, 0, sizeof(sim->if_id_latch));
+    memset(&sim->id_ex_latch, 0, sizeof(sim->id_ex_latch));
+    memset(&sim->ex_mem_latch, 0, sizeof(sim->ex_mem_latch));
+    memset(&sim->mem_wb_latch, 0, sizeof(sim->mem_wb_latch));
 }
 
 void init_registers(uint32_t entry_pc) {
-    memset(registers.regs, 0, sizeof(registers.regs));
-    registers.pc = entry_pc;
-    registers.regs[31] = 0xFFFFFFFF;
-    registers.regs[29] = 0x1000000;
+    memset(sim->registers.regs, 0, sizeof(sim->registers.regs));
+    sim->registers.pc = entry_pc;
+    sim->registers.regs[31] = 0xFFFFFFFF;
+    sim->registers.regs[29] = 0x1000000;
 
     init_branch_predictor();
 }
 
-int load_program(const char *filename, uint32_t load_addr) {
-    FILE *fp = fopen(filename, "rb");
-    if (!fp) {
-        perror("fopen");
-        return -1;
+// 다른 이유로 멈춘 cycles 사이클 동안에도 I-캐시 미스는 진행된다.
+// 겹친 사이클은 I-캐시 스톨로도 세고 따로 모아 두어 합계에서 한 번만 뺀다.
+static void overlap_fetch_wait(uint64_t cycles) {
+    if (sim->fetch_wait == 0) {
+        return;
+    }
+    uint64_t waited;
+    if (cycles >= sim->fetch_wait) {
+        // 마지막 사이클은 명령어를 ID로 넘기는 사이클이라 스톨이 아님
+        waited = sim->fetch_wait - 1;
+        sim->if_id_latch = sim->fetch_hold;
+        sim->fetch_wait = 0;
+    } else {
+        waited = cycles;
+        sim->fetch_wait -= (uint32_t)cycles;
     }
+    sim->icache_stall_cycles += waited;
+    sim->icache_overlap_cycles += waited;
+}
 
-    uint32_t temp;
-    size_t bytesRead;
-    size_t memoryIndex = load_addr;
-    
-    while ((bytesRead = fread(&temp, sizeof(uint32_t), 1, fp)) > 0) {
-        if (memoryIndex >= MEMORY_SIZE - 3) {
-            fprintf(stderr, "Program too big for memory.\n");
-            fclose(fp);
-            return -1;
+// 파이프라인이 비어 I-캐시만 기다리는 사이클은 한 번에 건너뛴다
+static void skip_idle_fetch_wait(void) {
+    if (sim->fetch_wait < 2 || sim->registers.pc == 0xffffffff || sim->if_id_latch.valid ||
+        sim->id_ex_latch.valid || sim->ex_mem_latch.valid || sim->mem_wb_latch.valid) {
+        return;
+    }
+    uint64_t skip = sim->fetch_wait - 1;
+    sim->inst_count += skip;
+    sim->icache_stall_cycles += skip;
+    sim->fetch_wait = 1;
+    if (sim->mshr != NULL) {
+        mshr_advance(skip);
+    }
+    // 건너뛴 사이클마다 새 슬롯(ctrl_flow[0] == 1)이 밀려 들어왔다
+    for (uint64_t k = 0; k < skip && k < 3; k++) {
+        for (int i = 3; i > 0; i--) {
+            sim->ctrl_flow[i] = sim->ctrl_flow[i-1];
         }
-        
-        memory[memoryIndex++] = (temp >> 24) & 0xFF;
-        memory[memoryIndex++] = (temp >> 16) & 0xFF;
-        memory[memoryIndex++] = (temp >> 8) & 0xFF;
-        memory[memoryIndex++] = temp & 0xFF;
     }
-    
-    fclose(fp);
-    printf("Loaded program at 0x%08x, size: %zu bytes\n", load_addr, memoryIndex - load_addr);
-    return 0;
+    TRACE(TRACE_PIPELINE, "[IF] Pipeline empty: skipped %llu cycles waiting for I-cache\n",
+          (unsigned long long)skip);
+}
+
+// D-캐시 지연: MEM과 그 앞 단계가 멈추는 동안 뒤의 WB는 이번 사이클에 이미 끝났으므로
+// 남은 사이클은 아무 일도 없다. 한 번에 건너뛴다.
+static void skip_mem_stall(void) {
+    uint64_t stall = sim->mem_stall;
+    sim->mem_stall = 0;
+    sim->inst_count += stall;
+    sim->dcache_stall_cycles += stall;
+    overlap_fetch_wait(stall);
+    if (sim->mshr != NULL) {
+        mshr_advance(stall);
+    }
+    TRACE(TRACE_PIPELINE, "[MEM] Waiting %llu cycles for D-cache\n", (unsigned long long)stall);
 }
 
 bool step_pipeline(void) {
-    static int exit_proc = 0;
-    static int ctrl_flow[4] = {-1, -1, -1, -1};  
+    int* ctrl_flow = sim->ctrl_flow;
     
-    printf("\n========== Cycle %llu ==========\n", (unsigned long long)inst_count + 1);
+    TRACE(TRACE_PIPELINE, "\n========== Cycle %llu ==========\n", (unsigned long long)sim->inst_count + 1);
     
-    inst_count++;
+    sim->inst_count++;
+    skip_idle_fetch_wait();
+    cache_set_clock(sim->inst_count - 1);
+
+    // 논블로킹 D-캐시: MEM의 새 미스에 줄 MSHR이 없으면 파이프라인 전체를 멈춤
+    if (sim->mshr != NULL) {
+        mshr_tick();
+        if (mshr_mem_blocked()) {
+            overlap_fetch_wait(1);
+            return true;
+        }
+    }
     
-    if (if_id_latch.valid && if_id_latch.instruction == 0) {
+    if (sim->if_id_latch.valid && sim->if_id_latch.instruction == 0) {
         ctrl_flow[0] = 0;
-        nop_count++;
+        sim->nop_count++;
     }
     
     // 1. 로드-사용 해저드 검출
     HazardUnit hazard_unit = detect_hazard();
     if (hazard_unit.stall) {
         handle_stall();
-        g_stall_count++;
+        sim->g_stall_count++;
         // 스톨 시 IF와 ID 단계를 멈춤
         ctrl_flow[0] = 0; // IF 스톨
         // ID는 이미 처리된 명령어를 유지
@@ -172,97 +111,161 @@ bool step_pipeline(void) {
     detect_forwarding();
     detect_branch_forwarding();
     
+    // 각 단계는 입력 래치가 비어 있으면 출력 래치를 비워서 버블을 전달한다
     if (ctrl_flow[3] == 1) {
-        if (mem_wb_latch.valid) {
-            stage_WB();
-        }
+        stage_WB();
     } else if (ctrl_flow[3] == 0) {
-        printf("[WB] NOP\n");
+        TRACE(TRACE_PIPELINE, "[WB] NOP\n");
     }
     
     if (ctrl_flow[2] == 1) {
-        if (ex_mem_latch.valid) {
-            stage_MEM();
-        }
+        stage_MEM();
     } else if (ctrl_flow[2] == 0) {
-        printf("[MEM] NOP\n");
-        mem_wb_latch.valid = false;
-        memset(&mem_wb_latch, 0, sizeof(mem_wb_latch));
+        TRACE(TRACE_PIPELINE, "[MEM] NOP\n");
+        sim->mem_wb_latch.valid = false;
+        memset(&sim->mem_wb_latch, 0, sizeof(sim->mem_wb_latch));
     }
     
-    if (if_id_latch.forward_a == 0b01 && mem_wb_latch.valid) {
-        if_id_latch.forward_a_val = (mem_wb_latch.control_signals.mem_read == 1) ? 
-                                    mem_wb_latch.rt_value : mem_wb_latch.alu_result;
+    if (sim->if_id_latch.forward_a == 0b01 && sim->mem_wb_latch.valid) {
+        sim->if_id_latch.forward_a_val = (sim->mem_wb_latch.control_signals.mem_read == 1) ? 
+                                    sim->mem_wb_latch.rt_value : sim->mem_wb_latch.alu_result;
     }
-    if (if_id_latch.forward_b == 0b01 && mem_wb_latch.valid) {
-        if_id_latch.forward_b_val = (mem_wb_latch.control_signals.mem_read == 1) ? 
-                                    mem_wb_latch.rt_value : mem_wb_latch.alu_result;
+    if (sim->if_id_latch.forward_b == 0b01 && sim->mem_wb_latch.valid) {
+        sim->if_id_latch.forward_b_val = (sim->mem_wb_latch.control_signals.mem_read == 1) ? 
+                                    sim->mem_wb_latch.rt_value : sim->mem_wb_latch.alu_result;
     }
     
     if (ctrl_flow[1] == 1) {
-        if (id_ex_latch.valid) {
-            stage_EX();
-        }
+        stage_EX();
     } else if (ctrl_flow[1] == 0) {
-        printf("[EX] NOP\n");
-        ex_mem_latch.valid = false;
-        memset(&ex_mem_latch, 0, sizeof(ex_mem_latch));
+        TRACE(TRACE_PIPELINE, "[EX] NOP\n");
+        sim->ex_mem_latch.valid = false;
+        memset(&sim->ex_mem_latch, 0, sizeof(sim->ex_mem_latch));
     }
     
-    if (if_id_latch.forward_a == 0b10 && ex_mem_latch.valid) {
-        if_id_latch.forward_a_val = ex_mem_latch.alu_result;
+    if (sim->if_id_latch.forward_a == 0b10 && sim->ex_mem_latch.valid) {
+        sim->if_id_latch.forward_a_val = sim->ex_mem_latch.alu_result;
     }
-    if (if_id_latch.forward_b == 0b10 && ex_mem_latch.valid) {
-        if_id_latch.forward_b_val = ex_mem_latch.alu_result;
+    if (sim->if_id_latch.forward_b == 0b10 && sim->ex_mem_latch.valid) {
+        sim->if_id_latch.forward_b_val = sim->ex_mem_latch.alu_result;
     }
     
+    // 아직 오지 않은 로드 값이 필요하면 ID와 IF를 잡아 두고 EX로는 버블을 보낸다.
+    // 뒤쪽 단계는 진행했으므로 ctrl_flow도 ID 뒤로만 민다. 다음 사이클에
+    // 포워딩을 다시 판단하도록 IF/ID의 포워딩 표시는 지운다.
+    if (ctrl_flow[0] == 1 && sim->mshr != NULL && mshr_id_blocked()) {
+        memset(&sim->id_ex_latch, 0, sizeof(sim->id_ex_latch));
+        sim->if_id_latch.forward_a = 0;
+        sim->if_id_latch.forward_b = 0;
+        ctrl_flow[3] = ctrl_flow[2];
+        ctrl_flow[2] = ctrl_flow[1];
+        ctrl_flow[1] = 0;
+        return true;
+    }
+
     if (ctrl_flow[0] == 1) {
-        if (if_id_latch.valid) {
-            stage_ID();
-        }
+        stage_ID();
     } else if (ctrl_flow[0] == 0) {
-        printf("[ID] NOP\n");
-        id_ex_latch.valid = false;
-        memset(&id_ex_latch, 0, sizeof(id_ex_latch));
+        TRACE(TRACE_PIPELINE, "[ID] NOP\n");
+        if (BINTRACE_ON() && sim->if_id_latch.valid) {
+            bintrace_record(sim->if_id_latch.pc, sim->if_id_latch.instruction, 0, 0);
+        }
+        sim->id_ex_latch.valid = false;
+        memset(&sim->id_ex_latch, 0, sizeof(sim->id_ex_latch));
     }
     
-    if (registers.pc != 0xffffffff) {
+    // ID가 페치 주소를 바로잡았으면 잘못된 경로로 가져온 슬롯들을 버린다
+    bool squashed = sim->fetch_squash_pending > 0;
+    bool waiting = sim->fetch_wait > 0;
+    if (squashed) {
+        sim->fetch_squash_pending--;
+        sim->fetch_squashed++;
+        memset(&sim->if_id_latch, 0, sizeof(sim->if_id_latch));
+        TRACE(TRACE_PIPELINE, "[IF] Squashed (fetch redirected to 0x%08x)\n", sim->registers.pc);
+    } else if (waiting) {
+        // I-캐시를 기다리는 동안 ID에는 버블, 다 기다리면 가져온 명령어를 넘긴다
+        if (--sim->fetch_wait == 0) {
+            sim->if_id_latch = sim->fetch_hold;
+        } else {
+            sim->icache_stall_cycles++;
+        }
+    } else if (sim->registers.pc != 0xffffffff) {
         stage_IF();
     }
     
-    if (registers.pc != 0xffffffff) {
-        registers.pc = registers.pc + 4;
+    // 마지막 명령어가 아직 페치 중이면 종료 카운트를 시작하지 않는다
+    if (sim->registers.pc != 0xffffffff || waiting || sim->fetch_wait > 0) {
+        // 바로잡힌 PC는 다음 사이클에 그대로 페치, 기다리는 동안은 이미 다음 PC
+        if (!squashed && !waiting) {
+            const IF_ID_Latch* fetched = (sim->fetch_wait > 0) ? &sim->fetch_hold : &sim->if_id_latch;
+            sim->registers.pc = fetched->valid ? fetched->next_pc : sim->registers.pc + 4;
+        }
         
         for (int i = 3; i > 0; i--) {
             ctrl_flow[i] = ctrl_flow[i-1];
         }
         
         ctrl_flow[0] = 1;
-    } else if (registers.pc == 0xffffffff) {
-        exit_proc++;
+    } else if (sim->registers.pc == 0xffffffff) {
+        sim->exit_proc++;
         for (int i = 3; i > 0; i--) {
             ctrl_flow[i] = ctrl_flow[i-1];
         }
-        if (exit_proc >= 3) {
+        if (sim->exit_proc >= 3) {
             ctrl_flow[0] = -1;
         }
     }
+
+    if (sim->mem_stall > 0) {
+        skip_mem_stall();
+    }
     
-    return !(exit_proc > 5);
+    return !(sim->exit_proc > 5);
+}
+
+// 원인별 스톨 사이클 (파이프라인이 새 명령어를 받지 못했거나 멈춰 있던 사이클)
+static void print_stall_breakdown(void) {
+    uint64_t data = 0, full = 0;
+    if (sim->mshr != NULL) {
+        get_mshr_stalls(&data, &full);
+    }
+    uint64_t total = sim->icache_stall_cycles + sim->dcache_stall_cycles + sim->g_stall_count +
+                     sim->fetch_squashed + data + full - sim->icache_overlap_cycles;
+
+    printf("stall cycles                         : %llu\n", (unsigned long long)total);
+    printf("  I-cache                            : %llu\n", (unsigned long long)sim->icache_stall_cycles);
+    printf("  D-cache                            : %llu\n", (unsigned long long)sim->dcache_stall_cycles);
+    if (sim->mshr != NULL) {
+        printf("  waiting for load data (MSHR)       : %llu\n", (unsigned long long)data);
+        printf("  MSHRs full                         : %llu\n", (unsigned long long)full);
+    }
+    printf("  load-use hazard                    : %llu\n", (unsigned long long)sim->g_stall_count);
+    printf("  fetch redirect                     : %llu\n", (unsigned long long)sim->fetch_squashed);
+    printf("  overlapped with I-cache (in both)  : %llu\n", (unsigned long long)sim->icache_overlap_cycles);
 }
 
 void print_statistics(void) {
     printf("================================================================================\n");
-    printf("Return register (r2)                 : %d\n", registers.regs[2]);
-    printf("Total clock cycle                    : %llu\n", (unsigned long long)inst_count);  
-    printf("r-type count                         : %llu\n", (unsigned long long)r_count);
-    printf("i-type count                         : %llu\n", (unsigned long long)i_count);
-    printf("branch, j-type count, jr             : %llu\n", (unsigned long long)branch_jr_count);
-    printf("lw count                             : %llu\n", (unsigned long long)lw_count);
-    printf("sw count                             : %llu\n", (unsigned long long)sw_count);
-    printf("nop count                            : %llu\n", (unsigned long long)nop_count);
-    printf("register write count                 : %llu\n", (unsigned long long)write_reg_count);
+    printf("Return register (r2)                 : %d\n", sim->registers.regs[2]);
+    printf("Total clock cycle                    : %llu\n", (unsigned long long)sim->inst_count);  
+    printf("r-type count                         : %llu\n", (unsigned long long)sim->r_count);
+    printf("i-type count                         : %llu\n", (unsigned long long)sim->i_count);
+    printf("branch, j-type count, jr             : %llu\n", (unsigned long long)sim->branch_jr_count);
+    printf("lw count                             : %llu\n", (unsigned long long)sim->lw_count);
+    printf("sw count                             : %llu\n", (unsigned long long)sim->sw_count);
+    printf("nop count                            : %llu\n", (unsigned long long)sim->nop_count);
+    printf("register write count                 : %llu\n", (unsigned long long)sim->write_reg_count);
+    print_stall_breakdown();
+    if (sim->ff_inst_count > 0) {
+        printf("fast-forwarded instructions          : %llu\n", (unsigned long long)sim->ff_inst_count);
+    }
+    printf("touched memory pages                 : %llu (%llu KB)\n",
+           (unsigned long long)sim->memory.touched_pages,
+           (unsigned long long)sim->memory.touched_pages * MEM_PAGE_SIZE / 1024);
     print_branch_prediction_stats();
+    print_target_prediction_stats();
+    print_mshr_stats();
+    print_bintrace_stats();
     
     // 캐시 통계 출력
     print_cache_statistics();
@@ -270,41 +273,255 @@ void print_statistics(void) {
     printf("=================================================================================\n");
 }
 
-int main(int argc, char *argv[]) {
-    if (argc < 2) {
-        fprintf(stderr, "사용법: %s <program.bin> [entry_pc (hex)]\n", argv[0]);
-        return 1;
+// 현재 컨텍스트(sim)에서 프로그램 하나를 끝까지 실행한다
+int sim_run(const char* program_path, uint32_t entry_pc) {
+    if (validate_cache_config() != 0) {
+        return -1;
     }
 
-    uint32_t entry_pc = (argc >= 3) ? strtoul(argv[2], NULL, 16) : 0x00000000;
-
-    printf("MIPS 5-Stage Pipeline Simulator with Cache\n");
-    printf("==========================================\n");
-
     clear_latches();
     init_registers(entry_pc);
     
     // 캐시 시스템 초기화
     init_cache();
+    init_mshr();
     
     // 캐시 설정 정보 출력
-    print_cache_configuration();
-    printf("\n");
+    if (TRACE_INFO_ON()) {
+        print_cache_configuration();
+        printf("\n");
+    }
 
-    if (load_program(argv[1], entry_pc) != 0)
-        return 1;
+    if (sim->restore_path != NULL) {
+        // 프로그램 로드와 워밍업 대신 저장된 상태에서 이어 간다
+        if (checkpoint_restore(sim->restore_path) != 0)
+            return -1;
+    } else if (load_program(program_path, entry_pc, &sim->registers.pc) != 0) {
+        // ELF 실행 파일은 헤더의 엔트리에서 시작
+        return -1;
+    }
 
-    printf("Starting simulation at PC=0x%08x\n", entry_pc);
+    if (sim->bintrace_path != NULL && bintrace_open(sim->bintrace_path) != 0) {
+        return -1;
+    }
+
+    bool halted = false;
+    if (sim->restore_path == NULL && (sim->ff_insts > 0 || sim->ff_use_pc)) {
+        uint64_t limit = (sim->ff_insts > 0) ? sim->ff_insts : UINT64_MAX;
+        uint64_t done = fast_forward(limit, sim->ff_use_pc, sim->ff_stop_pc, sim->ff_warm);
+        TRACE_INFO("Fast-forwarded %llu instructions%s, PC=0x%08x\n",
+                   (unsigned long long)done, sim->ff_warm ? " (warming caches/predictor)" : "", sim->registers.pc);
+        halted = (sim->registers.pc == 0xFFFFFFFF);
+    }
+
+    TRACE_INFO("Starting simulation at PC=0x%08x\n", sim->registers.pc);
+
+    if (sim->debug_enabled) {
+        // 명령을 읽어 가며 앞뒤로 실행하고, 통계는 마지막 위치 기준
+        debug_session(halted);
+        halted = true;
+    }
 
-    while (step_pipeline()) {
-        // 실행
+    // fast-forward 도중 프로그램이 끝났으면 파이프라인은 건너뜀
+    bool checkpoint_due = (sim->checkpoint_path != NULL);
+    while (!halted) {
+        if (checkpoint_due && sim->inst_count >= sim->checkpoint_at) {
+            if (checkpoint_save(sim->checkpoint_path) != 0)
+                return -1;
+            checkpoint_due = false;
+        }
+        if (!step_pipeline())
+            break;
+    }
+    if (checkpoint_due) {
+        fprintf(stderr, "Program finished before cycle %llu, no checkpoint written\n",
+                (unsigned long long)sim->checkpoint_at);
     }
     
     // 캐시 플러시 
     cache_flush();
+    return bintrace_close();
+}
+
+static void print_usage(const char* prog) {
+    fprintf(stderr, "사용법: %s [options] <program.bin|program.elf> [load_addr (hex)]\n", prog);
+    fprintf(stderr, "  (raw .bin과 .o는 load_addr에 배치해서 시작, ELF 실행 파일은 e_entry에서 시작)\n");
+    fprintf(stderr, "  -q, --quiet             print_statistics() 결과만 출력\n");
+    fprintf(stderr, "  --trace LIST            사이클 트레이스 카테고리 (pipeline,hazard,icache,dcache,branch,all)\n");
+    fprintf(stderr, "  --trace-level N         0=quiet, 1=info, 2=cycle (기본값 2)\n");
+    fprintf(stderr, "  --fast-forward N        처음 N개 명령어를 기능 시뮬레이션으로 실행\n");
+    fprintf(stderr, "  --ff-until-pc X         PC가 X(hex)에 도달할 때까지 기능 시뮬레이션\n");
+    fprintf(stderr, "  --trace-out FILE        동적 명령어 스트림을 압축된 바이너리 트레이스로 기록\n");
+    fprintf(stderr, "  --checkpoint-at N       N 사이클에서 전체 상태를 체크포인트로 저장 (0이면 fast-forward 직후)\n");
+    fprintf(stderr, "  --checkpoint-out FILE   체크포인트 파일 (기본값: <program>.ckpt)\n");
+    fprintf(stderr, "  --restore FILE          프로그램 로드와 fast-forward 대신 체크포인트에서 시작\n");
+    fprintf(stderr, "                          (구성이 다른 캐시/예측기는 비운 채로 시작)\n");
+    fprintf(stderr, "  --debug                 stdin에서 명령을 읽는 시간 여행 디버거 (step, reverse-step,\n");
+    fprintf(stderr, "                          continue, reverse-continue, break, watch, last-write, ...)\n");
+    fprintf(stderr, "  --snapshot-interval N   디버거 스냅샷 간격 사이클 (기본값 %d)\n", SNAPSHOT_DEFAULT_INTERVAL);
+    fprintf(stderr, "  --snapshot-mem MB       스냅샷 메모리 한도, 넘으면 스냅샷을 솎아 냄 (기본값 %d)\n", SNAPSHOT_DEFAULT_MEM_MB);
+    fprintf(stderr, "  --cache-sweep           한 번의 실행으로 여러 LRU 캐시 구성의 미스율 표 출력\n");
+    fprintf(stderr, "  --ff-warm               fast-forward 중 캐시와 분기 예측기 워밍\n");
+    fprintf(stderr, "  --l1i/--l1d/--l2/--l3 SETSxWAYSxLINE  캐시 레벨 구성 (L2/L3는 지정해야 활성화)\n");
+    fprintf(stderr, "  --<level>-repl P        교체 정책 (lru, fifo, random, plru, bitplru, srrip, brrip, drrip)\n");
+    fprintf(stderr, "  --cache-seed N          random/brrip/drrip 교체의 난수 시드\n");
+    fprintf(stderr, "  --<level>-latency N     캐시 히트 지연 사이클 (1..%d, 기본값 %d)\n", CACHE_MAX_LATENCY, CACHE_DEFAULT_LATENCY);
+    fprintf(stderr, "  --mem-latency N         메모리 접근 지연 사이클 (기본값 %d, 0이면 L2/L3 히트 지연을 포함한 미스 지연 전체를 끔)\n", MEMORY_DEFAULT_LATENCY);
+    fprintf(stderr, "  --l2-incl/--l3-incl P   포함 정책 (inclusive, exclusive, nine)\n");
+    fprintf(stderr, "  --l1d-pf P              D-캐시 프리페처 (none, nextline, stride, stream)\n");
+    fprintf(stderr, "  --l1i-pf P              I-캐시 프리페처 (none, nextline, target)\n");
+    fprintf(stderr, "  --l1d-victim/--l1i-victim N  L1과 하위 레벨 사이 완전 연관 victim cache 라인 수 (0..%d)\n", VICTIM_MAX_ENTRIES);
+    fprintf(stderr, "  --pf-degree N           앞서 가져올 라인 수 / 스트림 버퍼 깊이 (기본값 %d)\n", PF_DEFAULT_DEGREE);
+    fprintf(stderr, "  --bp NAME               분기 예측기 (bimodal, gshare, tournament, tage, perceptron)\n");
+    fprintf(stderr, "  --bp-budget BYTES       분기 예측기 저장 공간 예산 (기본값 %d)\n", BP_DEFAULT_BUDGET);
+    fprintf(stderr, "  --btb-entries N         BTB 엔트리 수, 0 또는 2의 거듭제곱 (기본값 %d)\n", BTB_DEFAULT_ENTRIES);
+    fprintf(stderr, "  --ras-depth N           리턴 주소 스택 깊이, 0이면 사용 안 함 (기본값 %d)\n", RAS_DEFAULT_DEPTH);
+    fprintf(stderr, "  --mispredict-penalty N  잘못 페치한 경로를 바로잡을 때 버리는 사이클 (기본값 %d)\n", MISPREDICT_DEFAULT_PENALTY);
+    fprintf(stderr, "  --mshrs N               논블로킹 D-캐시의 MSHR 수 (1..%d), 0이면 미스 지연 없음 (기본값)\n", MSHR_MAX_ENTRIES);
+    fprintf(stderr, "  --sweep-configs FILE    FILE의 각 줄(구성 옵션)을 별도 컨텍스트로 병렬 실행\n");
+    fprintf(stderr, "  --jobs N                스윕 워커 스레드 수 (기본값: 코어 수)\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char* program_path = NULL;
+    uint32_t entry_pc = 0x00000000;
+    unsigned int categories = TRACE_ALL;
+    int positional = 0;
+    bool sweep = false;
+    const char* sweep_configs = NULL;
+    int jobs = 0;
+    bool checkpoint = false;
+
+    sim = sim_create();
+    if (sim == NULL) {
+        fprintf(stderr, "Failed to allocate simulator context\n");
+        return 1;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        int used = sim_apply_option(sim, argc, argv, i);
+
+        if (used < 0) {
+            return 1;
+        } else if (used > 0) {
+            i += used - 1;
+        } else if (strcmp(arg, "-q") == 0 || strcmp(arg, "--quiet") == 0) {
+            trace_level = TRACE_LEVEL_QUIET;
+        } else if (strcmp(arg, "--trace") == 0 && i + 1 < argc) {
+            if (parse_trace_categories(argv[++i], &categories) != 0) return 1;
+            trace_level = TRACE_LEVEL_CYCLE;
+        } else if (strncmp(arg, "--trace=", 8) == 0) {
+            if (parse_trace_categories(arg + 8, &categories) != 0) return 1;
+            trace_level = TRACE_LEVEL_CYCLE;
+        } else if (strcmp(arg, "--trace-level") == 0 && i + 1 < argc) {
+            trace_level = atoi(argv[++i]);
+        } else if (strcmp(arg, "--cache-sweep") == 0) {
+            sweep = true;
+        } else if (strcmp(arg, "--sweep-configs") == 0 && i + 1 < argc) {
+            sweep_configs = argv[++i];
+        } else if (strcmp(arg, "--trace-out") == 0 && i + 1 < argc) {
+            sim->bintrace_path = argv[++i];
+        } else if (strcmp(arg, "--checkpoint-at") == 0 && i + 1 < argc) {
+            sim->checkpoint_at = strtoull(argv[++i], NULL, 0);
+            checkpoint = true;
+        } else if (strcmp(arg, "--checkpoint-out") == 0 && i + 1 < argc) {
+            sim->checkpoint_path = argv[++i];
+        } else if (strcmp(arg, "--restore") == 0 && i + 1 < argc) {
+            sim->restore_path = argv[++i];
+        } else if (strcmp(arg, "--debug") == 0) {
+            sim->debug_enabled = true;
+        } else if (strcmp(arg, "--snapshot-interval") == 0 && i + 1 < argc) {
+            sim->snapshot_interval = strtoull(argv[++i], NULL, 0);
+            if (sim->snapshot_interval == 0) {
+                fprintf(stderr, "--snapshot-interval must be at least 1\n");
+                return 1;
+            }
+        } else if (strcmp(arg, "--snapshot-mem") == 0 && i + 1 < argc) {
+            sim->snapshot_limit = strtoull(argv[++i], NULL, 0) << 20;
+        } else if (strcmp(arg, "--jobs") == 0 && i + 1 < argc) {
+            jobs = atoi(argv[++i]);
+        } else if (arg[0] == '-' && arg[1] == '-') {
+            print_usage(argv[0]);
+            return 1;
+        } else if (positional == 0) {
+            program_path = arg;
+            positional++;
+        } else if (positional == 1) {
+            entry_pc = strtoul(arg, NULL, 16);
+            positional++;
+        }
+    }
+
+    // 체크포인트에는 프로그램이 메모리에 들어 있으므로 --restore면 생략 가능
+    if (program_path == NULL && sim->restore_path == NULL) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (sim->restore_path != NULL && (sim->ff_insts > 0 || sim->ff_use_pc)) {
+        fprintf(stderr, "--restore cannot be combined with --fast-forward or --ff-until-pc\n");
+        return 1;
+    }
+
+    // 디버거는 되감은 구간을 다시 실행하므로 한 번만 기록해야 하는 출력과는 함께 쓸 수 없다
+    if (sim->debug_enabled && (sim->bintrace_path != NULL || checkpoint)) {
+        fprintf(stderr, "--debug cannot be combined with --trace-out or --checkpoint-at\n");
+        return 1;
+    }
+
+    char* default_checkpoint = NULL;
+    if (!checkpoint) {
+        sim->checkpoint_path = NULL;
+    } else if (sim->checkpoint_path == NULL) {
+        const char* base = program_path ? program_path : sim->restore_path;
+        default_checkpoint = malloc(strlen(base) + sizeof(".ckpt"));
+        if (default_checkpoint == NULL) {
+            fprintf(stderr, "Failed to allocate checkpoint path\n");
+            return 1;
+        }
+        strcpy(default_checkpoint, base);
+        strcat(default_checkpoint, ".ckpt");
+        sim->checkpoint_path = default_checkpoint;
+    }
+
+    // 병렬 스윕: 명령행 구성을 기본값으로 각 줄의 구성을 따로 실행
+    if (sweep_configs != NULL) {
+        if (sim->bintrace_path != NULL) {
+            fprintf(stderr, "--trace-out cannot be combined with --sweep-configs\n");
+            return 1;
+        }
+        if (sim->checkpoint_path != NULL) {
+            fprintf(stderr, "--checkpoint-at cannot be combined with --sweep-configs\n");
+            return 1;
+        }
+        if (sim->debug_enabled) {
+            fprintf(stderr, "--debug cannot be combined with --sweep-configs\n");
+            return 1;
+        }
+        int status = run_design_sweep(program_path, entry_pc, sweep_configs, jobs);
+        sim_destroy(sim);
+        return (status == 0) ? 0 : 1;
+    }
+
+    trace_mask = (trace_level >= TRACE_LEVEL_CYCLE) ? categories : 0;
+
+    TRACE_INFO("MIPS 5-Stage Pipeline Simulator with Cache\n");
+    TRACE_INFO("==========================================\n");
+
+    if (sweep) {
+        init_cache_sweep();
+    }
+
+    if (sim_run(program_path, entry_pc) != 0)
+        return 1;
 
     print_statistics();
-    printf("\nSimulation completed.\n");
+    if (sweep) {
+        print_cache_sweep();
+    }
+    TRACE_INFO("\nSimulation completed.\n");
 
+    sim_destroy(sim);
+    free(default_checkpoint);
     return 0;
-}
\ No newline at end of file
+}
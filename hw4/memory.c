@@ -0,0 +1,215 @@
+#define _POSIX_C_SOURCE 200809L
+#include "structure.h"
+#include <stdlib.h>
+#include <stddef.h>
+#include <sys/mman.h>
+
+const uint8_t mem_zero_page[MEM_PAGE_SIZE] = {0};
+
+// 힙 페이지 앞에 붙는 참조 수. 시간 여행 스냅샷(timetravel.c)이 페이지를 함께
+// 가리키면 2 이상이 되고, 그런 페이지에 쓰기 전에 복사한다 (copy-on-write).
+typedef struct {
+    uint64_t refs;
+    uint8_t data[MEM_PAGE_SIZE];
+} HeapPage;
+
+static HeapPage* heap_page(uint8_t* data) {
+    return (HeapPage*)(data - offsetof(HeapPage, data));
+}
+
+void mem_init(GuestMemory* m) {
+    memset(m, 0, sizeof(*m));
+    m->last_page = UINT32_MAX;      // 페이지 번호는 20비트이므로 일치할 수 없음
+    m->write_page = UINT32_MAX;
+}
+
+static bool in_mapping(const GuestMemory* m, const uint8_t* data) {
+    return data >= m->mapped && data < m->mapped + m->mapped_size;
+}
+
+// 체크포인트 매핑 안의 페이지는 참조 수가 없으므로 항상 공유로 본다 (처음 쓸 때 복사)
+static bool page_shared(const GuestMemory* m, uint8_t* data) {
+    return in_mapping(m, data) || heap_page(data)->refs > 1;
+}
+
+static uint8_t* page_alloc(const uint8_t* init) {
+    HeapPage* p = init ? malloc(sizeof(HeapPage)) : calloc(1, sizeof(HeapPage));
+    if (p == NULL) {
+        fprintf(stderr, "guest memory: out of memory\n");
+        exit(1);
+    }
+    p->refs = 1;
+    if (init != NULL) {
+        memcpy(p->data, init, MEM_PAGE_SIZE);
+    }
+    return p->data;
+}
+
+static void page_retain(const GuestMemory* m, uint8_t* data) {
+    if (!in_mapping(m, data)) {
+        heap_page(data)->refs++;
+    }
+}
+
+static void page_release(const GuestMemory* m, uint8_t* data) {
+    if (data != NULL && !in_mapping(m, data) && --heap_page(data)->refs == 0) {
+        free(heap_page(data));
+    }
+}
+
+static uint8_t** page_slot(GuestMemory* m, uint32_t page) {
+    uint32_t d = page >> (MEM_DIR_SHIFT - MEM_PAGE_SHIFT);
+    if (m->dir[d] == NULL) {
+        m->dir[d] = calloc(MEM_TABLE_SIZE, sizeof(uint8_t*));
+        if (m->dir[d] == NULL) {
+            fprintf(stderr, "guest memory: out of memory\n");
+            exit(1);
+        }
+    }
+    return &m->dir[d][page & (MEM_TABLE_SIZE - 1)];
+}
+
+// 모든 페이지의 참조를 놓는다 (페이지 테이블은 남김)
+static void release_all_pages(GuestMemory* m) {
+    for (int d = 0; d < MEM_DIR_SIZE; d++) {
+        for (int t = 0; m->dir[d] != NULL && t < MEM_TABLE_SIZE; t++) {
+            page_release(m, m->dir[d][t]);
+            m->dir[d][t] = NULL;
+        }
+    }
+    m->touched_pages = 0;
+    m->last_page = UINT32_MAX;
+    m->write_page = UINT32_MAX;
+}
+
+void mem_free(GuestMemory* m) {
+    release_all_pages(m);
+    for (int d = 0; d < MEM_DIR_SIZE; d++) {
+        free(m->dir[d]);
+    }
+    if (m->mapped != NULL) {
+        munmap(m->mapped, m->mapped_size);
+    }
+    mem_init(m);
+}
+
+// 체크포인트 매핑을 메모리가 소유하게 한다 (mem_free에서 해제)
+void mem_attach_mapping(GuestMemory* m, uint8_t* base, size_t size) {
+    m->mapped = base;
+    m->mapped_size = size;
+}
+
+// 매핑 안의 페이지를 그대로 게스트 페이지로 쓴다. 쓰는 페이지만 처음 쓸 때 힙으로 복사.
+void mem_map_page(GuestMemory* m, uint32_t page, uint8_t* data) {
+    uint8_t** slot = page_slot(m, page);
+    if (*slot == NULL) {
+        m->touched_pages++;
+    } else {
+        page_release(m, *slot);
+    }
+    *slot = data;
+    m->last_page = UINT32_MAX;
+    m->write_page = UINT32_MAX;
+}
+
+// 할당된 모든 페이지를 공유 상태로 만들고 (페이지 번호, 데이터) 목록을 돌려준다.
+// 목록이 페이지마다 참조 하나씩을 가지며, 이후 게스트가 쓰는 페이지는 복사된다.
+size_t mem_share_pages(GuestMemory* m, MemPageRef** out) {
+    MemPageRef* pages = malloc(sizeof(MemPageRef) * (m->touched_pages ? m->touched_pages : 1));
+    size_t count = 0;
+    if (pages == NULL) {
+        fprintf(stderr, "guest memory: out of memory\n");
+        exit(1);
+    }
+    for (uint32_t d = 0; d < MEM_DIR_SIZE; d++) {
+        for (uint32_t t = 0; m->dir[d] != NULL && t < MEM_TABLE_SIZE; t++) {
+            if (m->dir[d][t] != NULL) {
+                page_retain(m, m->dir[d][t]);
+                pages[count].page = (d << (MEM_DIR_SHIFT - MEM_PAGE_SHIFT)) | t;
+                pages[count].data = m->dir[d][t];
+                count++;
+            }
+        }
+    }
+    m->write_page = UINT32_MAX;     // 쓰기 단축 경로의 페이지도 이제 공유 중
+    *out = pages;
+    return count;
+}
+
+// 게스트 메모리를 목록의 페이지들로 되돌린다 (목록은 그대로 유지)
+void mem_restore_pages(GuestMemory* m, const MemPageRef* pages, size_t count) {
+    release_all_pages(m);
+    for (size_t i = 0; i < count; i++) {
+        page_retain(m, pages[i].data);
+        *page_slot(m, pages[i].page) = pages[i].data;
+    }
+    m->touched_pages = count;
+}
+
+void mem_release_pages(GuestMemory* m, MemPageRef* pages, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        page_release(m, pages[i].data);
+    }
+    free(pages);
+}
+
+// 페이지 테이블 탐색. alloc이면 없는 페이지를 만들고, 아니면 NULL을 반환.
+// 할당된 페이지만 last_page 단축 경로에 넣고 (zero 페이지는 쓰기 불가),
+// write_page 단축 경로에는 공유 중이 아닌 페이지만 넣는다.
+uint8_t* mem_page_slow(GuestMemory* m, uint32_t page, int alloc) {
+    if (m->dir[page >> (MEM_DIR_SHIFT - MEM_PAGE_SHIFT)] == NULL && !alloc) {
+        return NULL;
+    }
+    uint8_t** slot = page_slot(m, page);
+    uint8_t* data = *slot;
+    if (data == NULL) {
+        if (!alloc) {
+            return NULL;
+        }
+        *slot = data = page_alloc(NULL);
+        m->touched_pages++;
+    } else if (alloc && page_shared(m, data)) {
+        // 스냅샷이나 체크포인트 매핑이 함께 보는 페이지는 복사해서 쓴다
+        uint8_t* copy = page_alloc(data);
+        page_release(m, data);
+        *slot = data = copy;
+    }
+
+    m->last_page = page;
+    m->last_data = data;
+    if (alloc) {
+        m->write_page = page;
+        m->write_data = data;
+    }
+    return data;
+}
+
+void mem_read(GuestMemory* m, uint32_t address, void* out, size_t size) {
+    uint8_t* dst = out;
+    while (size > 0) {
+        size_t offset = address & MEM_PAGE_MASK;
+        size_t chunk = MEM_PAGE_SIZE - offset;
+        if (chunk > size) {
+            chunk = size;
+        }
+        memcpy(dst, mem_read_page(m, address) + offset, chunk);
+        dst += chunk;
+        address += (uint32_t)chunk;
+        size -= chunk;
+    }
+}
+
+void mem_write(GuestMemory* m, uint32_t address, const void* in, size_t size) {
+    const uint8_t* src = in;
+    while (size > 0) {
+        size_t offset = address & MEM_PAGE_MASK;
+        size_t chunk = MEM_PAGE_SIZE - offset;
+        if (chunk > size) {
+            chunk = size;
+        }
+        memcpy(mem_write_page(m, address) + offset, src, chunk);
+        src += chunk;
+        address += (uint32_t)chunk;
+        size -= chunk;
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 페이지 단위로 필요할 때 할당하는 게스트 메모리
+// 32비트 주소 = 디렉터리 인덱스(10) | 페이지 인덱스(10) | 오프셋(12).
+// 처음 쓰는 순간 4KB 페이지를 할당하고, 쓴 적 없는 페이지의 읽기는
+// 공유 zero 페이지에서 처리한다. 스냅샷과 공유 중인 페이지는 쓸 때 복사한다.
+#define MEM_PAGE_SHIFT  12
+#define MEM_PAGE_SIZE   (1u << MEM_PAGE_SHIFT)
+#define MEM_PAGE_MASK   (MEM_PAGE_SIZE - 1)
+#define MEM_DIR_SHIFT   22
+#define MEM_DIR_SIZE    1024
+#define MEM_TABLE_SIZE  1024
+
+typedef struct {
+    uint8_t** dir[MEM_DIR_SIZE];    // 디렉터리 -> 페이지 포인터 테이블
+    uint32_t last_page;             // 마지막으로 접근한 (할당된) 페이지 번호
+    uint8_t* last_data;
+    uint32_t write_page;            // 마지막으로 쓴 페이지 (공유 중이 아님)
+    uint8_t* write_data;
+    uint64_t touched_pages;         // 할당된 페이지 수
+    uint8_t* mapped;                // 복원한 체크포인트 파일 매핑, 이 안의 페이지는 free하지 않음
+    size_t mapped_size;
+} GuestMemory;
+
+// 스냅샷이 가진 페이지 하나 (참조 하나를 잡고 있음)
+typedef struct {
+    uint32_t page;
+    uint8_t* data;
+} MemPageRef;
+
+extern const uint8_t mem_zero_page[MEM_PAGE_SIZE];
+
+extern void mem_init(GuestMemory* m);
+extern void mem_free(GuestMemory* m);
+extern uint8_t* mem_page_slow(GuestMemory* m, uint32_t page, int alloc);
+extern void mem_attach_mapping(GuestMemory* m, uint8_t* base, size_t size);
+extern void mem_map_page(GuestMemory* m, uint32_t page, uint8_t* data);
+extern size_t mem_share_pages(GuestMemory* m, MemPageRef** out);
+extern void mem_restore_pages(GuestMemory* m, const MemPageRef* pages, size_t count);
+extern void mem_release_pages(GuestMemory* m, MemPageRef* pages, size_t count);
+extern void mem_read(GuestMemory* m, uint32_t address, void* out, size_t size);
+extern void mem_write(GuestMemory* m, uint32_t address, const void* in, size_t size);
+
+// 읽기용 페이지: 할당되지 않았으면 zero 페이지
+static inline const uint8_t* mem_read_page(GuestMemory* m, uint32_t address) {
+    uint32_t page = address >> MEM_PAGE_SHIFT;
+    if (page == m->last_page) {
+        return m->last_data;
+    }
+    const uint8_t* data = mem_page_slow(m, page, 0);
+    return data ? data : mem_zero_page;
+}
+
+// 쓰기용 페이지: 처음 쓰면 할당, 공유 중이면 복사
+static inline uint8_t* mem_write_page(GuestMemory* m, uint32_t address) {
+    uint32_t page = address >> MEM_PAGE_SHIFT;
+    if (page == m->write_page) {
+        return m->write_data;
+    }
+    return mem_page_slow(m, page, 1);
+}
+
+static inline uint8_t mem_read_byte(GuestMemory* m, uint32_t address) {
+    return mem_read_page(m, address)[address & MEM_PAGE_MASK];
+}
+
+static inline void mem_write_byte(GuestMemory* m, uint32_t address, uint8_t value) {
+    mem_write_page(m, address)[address & MEM_PAGE_MASK] = value;
+}
+
+#endif
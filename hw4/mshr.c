@@ -0,0 +1,227 @@
+#include "structure.h"
+#include <stdlib.h>
+
+// 논블로킹 D-캐시 (--mshrs N)
+// 캐시 내용은 접근 즉시 바뀌고 값도 바로 나오지만, 하위 레벨을 기다리는 미스는
+// MSHR 하나를 완료 시각까지 잡고, 로드의 목적 레지스터는 그때까지 스코어보드에
+// 대기 중으로 남는다. 파이프라인은
+//   - ID의 명령어가 대기 중인 레지스터를 읽거나 쓰면 ID에서 (의존성 스톨)
+//   - MEM의 접근이 새 미스인데 MSHR이 모두 차 있으면 전체가 (구조적 스톨)
+// 멈춘다. 이미 진행 중인 라인에 대한 미스는 그 MSHR에 합쳐지고 같은 시각에 끝난다.
+// 시각은 사이클 수(sim->inst_count), 미스 지연은 cache_miss_latency.
+
+typedef struct {
+    uint32_t block;             // 라인 주소
+    uint64_t ready;             // 완료 사이클, 0이면 빈 칸
+    uint32_t merged;            // 합쳐진 2차 미스 수
+} MshrEntry;
+
+typedef struct {
+    uint64_t primary;           // MSHR을 새로 잡은 미스
+    uint64_t merged;            // 진행 중인 MSHR에 합쳐진 미스
+    uint64_t full_stalls;       // MSHR이 모자라 멈춘 사이클
+    uint64_t dep_stalls;        // 대기 중인 로드 값을 기다린 사이클
+    uint64_t busy_cycles;       // 미스가 하나 이상 진행 중인 사이클
+    uint64_t outstanding_sum;   // 그 사이클들의 진행 중인 미스 수 합 (평균 MLP)
+    int peak;
+} MshrStats;
+
+struct MshrFile {
+    int entries;
+    int active;
+    uint32_t line_mask;
+    MshrEntry slot[MSHR_MAX_ENTRIES];
+    uint64_t reg_ready[32];     // 레지스터 값이 준비되는 사이클
+    uint32_t pending;           // reg_ready가 아직 안 지난 레지스터 비트맵
+    MshrStats stats;
+};
+
+void init_mshr(void) {
+    if (sim->mshr != NULL || sim->mshr_entries == 0) {
+        return;
+    }
+    struct MshrFile* m = calloc(1, sizeof(struct MshrFile));
+    if (m == NULL) {
+        fprintf(stderr, "MSHR: out of memory\n");
+        exit(1);
+    }
+    m->entries = sim->mshr_entries;
+    m->line_mask = ~(uint32_t)(sim->cache_config[CACHE_L1D].line_size - 1);
+    sim->mshr = m;
+}
+
+void free_mshr(void) {
+    free(sim->mshr);
+    sim->mshr = NULL;
+}
+
+// 사이클 시작: 끝난 미스와 준비된 레지스터를 정리하고 MLP를 센다
+void mshr_tick(void) {
+    struct MshrFile* m = sim->mshr;
+    uint64_t now = sim->inst_count;
+
+    if (m->active > 0) {
+        for (int i = 0; i < m->entries; i++) {
+            if (m->slot[i].ready != 0 && m->slot[i].ready <= now) {
+                m->slot[i].ready = 0;
+                m->active--;
+            }
+        }
+        if (m->active > 0) {
+            m->stats.busy_cycles++;
+            m->stats.outstanding_sum += (uint64_t)m->active;
+        }
+    }
+    for (uint32_t p = m->pending; p != 0; p &= p - 1) {
+        int r = __builtin_ctz(p);
+        if (m->reg_ready[r] <= now) {
+            m->pending &= ~(1u << r);
+        }
+    }
+}
+
+// 한 번에 건너뛴 cycles 사이클을 MLP 통계에 반영한다 (끝난 칸은 다음 mshr_tick이 정리)
+void mshr_advance(uint64_t cycles) {
+    struct MshrFile* m = sim->mshr;
+    uint64_t now = sim->inst_count - cycles;
+    uint64_t busy = 0;
+
+    for (int i = 0; i < m->entries; i++) {
+        if (m->slot[i].ready > now + 1) {
+            uint64_t left = m->slot[i].ready - now - 1;
+            if (left > cycles) left = cycles;
+            m->stats.outstanding_sum += left;
+            if (left > busy) busy = left;
+        }
+    }
+    m->stats.busy_cycles += busy;
+}
+
+void get_mshr_stalls(uint64_t* data, uint64_t* full) {
+    *data = sim->mshr->stats.dep_stalls;
+    *full = sim->mshr->stats.full_stalls;
+}
+
+static MshrEntry* mshr_find(struct MshrFile* m, uint32_t block) {
+    for (int i = 0; i < m->entries; i++) {
+        if (m->slot[i].ready != 0 && m->slot[i].block == block) {
+            return &m->slot[i];
+        }
+    }
+    return NULL;
+}
+
+// MEM의 load/store가 새 MSHR이 필요한데 남은 것이 없으면 true
+bool mshr_mem_blocked(void) {
+    struct MshrFile* m = sim->mshr;
+    const EX_MEM_Latch* l = &sim->ex_mem_latch;
+
+    if (m->active < m->entries || sim->ctrl_flow[2] != 1 || !l->valid ||
+        (!l->control_signals.mem_read && !l->control_signals.mem_write)) {
+        return false;
+    }
+    uint32_t address = l->alu_result;
+    if (address + 4 > MEMORY_SIZE || cache_contains(CACHE_L1D, address) ||
+        mshr_find(m, address & m->line_mask) != NULL) {
+        return false;
+    }
+    m->stats.full_stalls++;
+    TRACE(TRACE_HAZARD, "[HAZARD] MSHRs full: MEM stalled at 0x%08x\n", address);
+    return true;
+}
+
+// 방금 끝난 D-캐시 접근을 기록한다. dest_reg는 로드의 목적 레지스터 (store면 0).
+void mshr_record(uint32_t address, uint32_t dest_reg) {
+    struct MshrFile* m = sim->mshr;
+    uint32_t block = address & m->line_mask;
+    uint32_t latency = cache_miss_latency();
+    uint64_t ready = 0;
+
+    MshrEntry* e = mshr_find(m, block);
+    if (e != NULL) {
+        // 캐시에는 이미 라인이 들어와 있어 히트로 보이지만 데이터는 아직 오는 중
+        e->merged++;
+        m->stats.merged++;
+        ready = e->ready;
+    } else if (latency > 0) {
+        for (int i = 0; i < m->entries; i++) {
+            if (m->slot[i].ready == 0) {
+                e = &m->slot[i];
+                break;
+            }
+        }
+        if (e == NULL) {
+            return;         // mshr_mem_blocked가 막으므로 오지 않음
+        }
+        ready = sim->inst_count + latency;
+        e->block = block;
+        e->ready = ready;
+        e->merged = 0;
+        m->active++;
+        m->stats.primary++;
+        if (m->active > m->stats.peak) {
+            m->stats.peak = m->active;
+        }
+        TRACE(TRACE_DCACHE, "[D-CACHE] MSHR allocated: Block=0x%08x, ready at cycle %llu (%d outstanding)\n",
+              block, (unsigned long long)ready, m->active);
+    }
+
+    if (dest_reg != 0 && ready > sim->inst_count) {
+        m->reg_ready[dest_reg] = ready;
+        m->pending |= 1u << dest_reg;
+    }
+}
+
+// ID의 명령어가 아직 오지 않은 로드 값을 읽거나 덮어쓰면 true
+bool mshr_id_blocked(void) {
+    struct MshrFile* m = sim->mshr;
+    const IF_ID_Latch* l = &sim->if_id_latch;
+
+    if (m->pending == 0 || !l->valid) {
+        return false;
+    }
+    // 디코드 테이블 통계를 건드리지 않도록 제어 신호만 따로 만든다
+    Instruction inst = {0};
+    Control_Signals ctrl;
+    inst.opcode = l->opcode;
+    inst.funct = l->funct;
+    setup_control_signals(&inst, &ctrl);
+
+    uint32_t rd = (l->instruction >> 11) & 0x1f;
+    uint32_t regs = 0;
+    if (ctrl.rs_ch) regs |= 1u << l->reg_src;
+    if (ctrl.rt_ch) regs |= 1u << l->reg_tar;
+    if (ctrl.reg_wb) regs |= 1u << (ctrl.reg_dst ? rd : l->reg_tar);
+
+    if ((regs & m->pending & ~1u) == 0) {
+        return false;
+    }
+    m->stats.dep_stalls++;
+    TRACE(TRACE_HAZARD, "[HAZARD] Waiting for outstanding load: PC=0x%08x\n", l->pc);
+    return true;
+}
+
+// MshrFile에는 포인터가 없으므로 통째로 저장한다
+void mshr_checkpoint(Checkpoint* ck) {
+    if (sim->mshr != NULL) {
+        ckpt_region(ck, sim->mshr, sizeof(struct MshrFile));
+    }
+}
+
+void print_mshr_stats(void) {
+    const struct MshrFile* m = sim->mshr;
+    if (m == NULL) {
+        return;
+    }
+    const MshrStats* s = &m->stats;
+
+    printf("Non-blocking D-cache Statistics:\n");
+    printf("  MSHRs: %d, %llu primary misses, %llu merged secondary misses\n",
+           m->entries, (unsigned long long)s->primary, (unsigned long long)s->merged);
+    printf("  Stall cycles: %llu waiting for load data, %llu with MSHRs full\n",
+           (unsigned long long)s->dep_stalls, (unsigned long long)s->full_stalls);
+    if (s->busy_cycles > 0) {
+        printf("  Outstanding misses: %.2f average while busy (%llu cycles), peak %d\n",
+               (double)s->outstanding_sum / s->busy_cycles, (unsigned long long)s->busy_cycles, s->peak);
+    }
+}
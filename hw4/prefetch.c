@@ -0,0 +1,434 @@
+#include "structure.h"
+#include <stdlib.h>
+
+// 하드웨어 프리페처 (L1 I/D)
+// 캐시는 demand 접근이 끝날 때마다 prefetch_observe를 부르고, 프리페처는
+// cache_prefetch(캐시에 바로 채움)나 cache_prefetch_to_buffer(자기 버퍼에 보관)로
+// 블록을 가져온다. 유용/늦음/오염 집계는 캐시(cache.c)가 한다.
+//   nextline  미스나 프리페치한 라인을 처음 쓸 때 다음 N개 라인 (tagged next-N-line)
+//   stride    PC로 찾는 reference prediction table. 보폭이 확인되면 N걸음 앞까지
+//   stream    스트림 버퍼 (깊이 N). 버퍼의 블록은 미스가 났을 때만 캐시로 옮긴다
+//   target    nextline + 분기/점프 목적지 라인 (I-캐시)
+
+typedef struct {
+    uint32_t pc;
+    uint32_t address;
+    uint32_t word;              // I-캐시: 읽은 명령어, D-캐시: 0
+    bool hit;                   // 스트림 버퍼에서 받은 것도 히트
+    bool prefetched;            // 프리페치한 라인을 처음 쓴 접근
+} PrefetchAccess;
+
+typedef struct {
+    const char* name;
+    void* (*create)(int level, int line_size, int degree);
+    void (*observe)(void* state, const PrefetchAccess* a);
+    // 미스 난 블록이 프리페처 버퍼에 있으면 꺼낸다 (스트림 버퍼만, 나머지는 NULL)
+    bool (*take)(void* state, uint32_t block, uint8_t* out, uint64_t* ready);
+    void (*destroy)(void* state);
+    // 체크포인트할 학습 상태 (없으면 NULL)
+    void (*checkpoint)(void* state, Checkpoint* ck);
+} PrefetcherOps;
+
+struct PrefetchUnits {
+    const PrefetcherOps* ops[2];    // CACHE_L1I, CACHE_L1D
+    void* state[2];
+};
+
+// ---------------------------------------------------------------------------
+// next-N-line
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    int level;
+    uint32_t line_size;
+    int degree;
+} NextLineState;
+
+static void* next_line_create(int level, int line_size, int degree) {
+    NextLineState* s = malloc(sizeof(NextLineState));
+    if (s != NULL) {
+        s->level = level;
+        s->line_size = (uint32_t)line_size;
+        s->degree = degree;
+    }
+    return s;
+}
+
+static void next_line_issue(const NextLineState* s, const PrefetchAccess* a) {
+    if (a->hit && !a->prefetched) {
+        return;
+    }
+    uint32_t block = a->address & ~(s->line_size - 1);
+    for (int k = 1; k <= s->degree; k++) {
+        cache_prefetch(s->level, block + (uint32_t)k * s->line_size);
+    }
+}
+
+static void next_line_observe(void* state, const PrefetchAccess* a) {
+    next_line_issue(state, a);
+}
+
+// ---------------------------------------------------------------------------
+// stride (Chen & Baer reference prediction table)
+// ---------------------------------------------------------------------------
+
+#define RPT_ENTRIES 64
+
+typedef enum { RPT_INIT = 0, RPT_TRANSIENT, RPT_STEADY, RPT_NO_PRED } RptState;
+
+typedef struct {
+    uint32_t pc;
+    uint32_t last;
+    int32_t stride;
+    uint8_t state;
+    bool valid;
+} RptEntry;
+
+typedef struct {
+    int level;
+    uint32_t line_size;
+    int degree;
+    RptEntry table[RPT_ENTRIES];
+} StrideState;
+
+static void* stride_create(int level, int line_size, int degree) {
+    StrideState* s = calloc(1, sizeof(StrideState));
+    if (s != NULL) {
+        s->level = level;
+        s->line_size = (uint32_t)line_size;
+        s->degree = degree;
+    }
+    return s;
+}
+
+static void stride_observe(void* state, const PrefetchAccess* a) {
+    StrideState* s = state;
+    RptEntry* e = &s->table[(a->pc >> 2) & (RPT_ENTRIES - 1)];
+
+    if (!e->valid || e->pc != a->pc) {
+        *e = (RptEntry){a->pc, a->address, 0, RPT_INIT, true};
+        return;
+    }
+
+    int32_t stride = (int32_t)(a->address - e->last);
+    bool correct = (stride == e->stride);
+    switch (e->state) {
+        case RPT_INIT:
+            e->state = correct ? RPT_STEADY : RPT_TRANSIENT;
+            break;
+        case RPT_TRANSIENT:
+            e->state = correct ? RPT_STEADY : RPT_NO_PRED;
+            break;
+        case RPT_STEADY:
+            if (!correct) {
+                e->state = RPT_INIT;
+                stride = e->stride;         // 한 번 어긋난 것으로는 보폭을 바꾸지 않는다
+            }
+            break;
+        case RPT_NO_PRED:
+            if (correct) {
+                e->state = RPT_TRANSIENT;
+            }
+            break;
+    }
+    e->stride = stride;
+    e->last = a->address;
+
+    if (e->state != RPT_STEADY || e->stride == 0) {
+        return;
+    }
+
+    // 보폭이 라인보다 작으면 같은 라인을 거듭 고르지 않도록 라인 단위로 앞서 간다
+    uint32_t magnitude = (uint32_t)(e->stride < 0 ? -e->stride : e->stride);
+    int32_t step = (magnitude < s->line_size)
+                   ? (e->stride < 0 ? -(int32_t)s->line_size : (int32_t)s->line_size)
+                   : e->stride;
+    for (int k = 1; k <= s->degree; k++) {
+        cache_prefetch(s->level, a->address + (uint32_t)(step * k));
+    }
+}
+
+static void stride_checkpoint(void* state, Checkpoint* ck) {
+    StrideState* s = state;
+    ckpt_region(ck, s->table, sizeof(s->table));
+}
+
+// ---------------------------------------------------------------------------
+// 스트림 버퍼 (Jouppi). 미스마다 가장 오래 안 쓴 버퍼를 그 다음 블록부터 다시 채운다.
+// 버퍼 블록은 L1과 다른 버퍼에 없을 때만 가져오고, L1 미스는 캐시보다 먼저 버퍼를
+// 찾으므로 한 블록의 사본은 L1이나 버퍼 중 한 곳에만 있다 (버퍼 사본이 낡지 않음).
+// ---------------------------------------------------------------------------
+
+#define STREAM_BUFFERS 4
+
+typedef struct {
+    uint32_t* blocks;           // [depth] 원형 큐
+    uint64_t* ready;
+    uint8_t* data;              // [depth][line_size]
+    int head;
+    int count;
+    uint32_t next;              // 다음에 가져올 블록
+    uint64_t last_use;
+} StreamBuffer;
+
+typedef struct {
+    int level;
+    uint32_t line_size;
+    int depth;
+    uint64_t tick;
+    StreamBuffer buf[STREAM_BUFFERS];
+} StreamState;
+
+static void stream_destroy(void* state) {
+    StreamState* s = state;
+    if (s == NULL) {
+        return;
+    }
+    for (int i = 0; i < STREAM_BUFFERS; i++) {
+        free(s->buf[i].blocks);
+        free(s->buf[i].ready);
+        free(s->buf[i].data);
+    }
+    free(s);
+}
+
+static void* stream_create(int level, int line_size, int degree) {
+    StreamState* s = calloc(1, sizeof(StreamState));
+    if (s == NULL) {
+        return NULL;
+    }
+    s->level = level;
+    s->line_size = (uint32_t)line_size;
+    s->depth = degree;
+    for (int i = 0; i < STREAM_BUFFERS; i++) {
+        StreamBuffer* b = &s->buf[i];
+        b->blocks = malloc(sizeof(uint32_t) * degree);
+        b->ready = malloc(sizeof(uint64_t) * degree);
+        b->data = malloc((size_t)degree * line_size);
+        if (!b->blocks || !b->ready || !b->data) {
+            stream_destroy(s);
+            return NULL;
+        }
+    }
+    return s;
+}
+
+static void stream_checkpoint(void* state, Checkpoint* ck) {
+    StreamState* s = state;
+    for (int i = 0; i < STREAM_BUFFERS; i++) {
+        StreamBuffer* b = &s->buf[i];
+        ckpt_region(ck, b->blocks, sizeof(uint32_t) * s->depth);
+        ckpt_region(ck, b->ready, sizeof(uint64_t) * s->depth);
+        ckpt_region(ck, b->data, (size_t)s->depth * s->line_size);
+        ckpt_region(ck, &b->head, sizeof(b->head));
+        ckpt_region(ck, &b->count, sizeof(b->count));
+        ckpt_region(ck, &b->next, sizeof(b->next));
+        ckpt_region(ck, &b->last_use, sizeof(b->last_use));
+    }
+    ckpt_region(ck, &s->tick, sizeof(s->tick));
+}
+
+static uint8_t* stream_slot_data(StreamState* s, StreamBuffer* b, int slot) {
+    return b->data + (size_t)slot * s->line_size;
+}
+
+// 맨 앞 블록을 버린다 (쓰지 않은 채로 버리면 캐시에 알림)
+static void stream_pop(StreamState* s, StreamBuffer* b, bool used) {
+    if (!used) {
+        cache_release_buffer(s->level, b->blocks[b->head], stream_slot_data(s, b, b->head));
+    }
+    b->head = (b->head + 1) % s->depth;
+    b->count--;
+}
+
+static bool stream_holds(const StreamState* s, uint32_t block) {
+    for (int i = 0; i < STREAM_BUFFERS; i++) {
+        const StreamBuffer* b = &s->buf[i];
+        for (int k = 0; k < b->count; k++) {
+            if (b->blocks[(b->head + k) % s->depth] == block) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// 빈 칸을 이어지는 블록으로 채운다. 이미 L1이나 다른 버퍼에 있는 블록은 건너뛴다.
+static void stream_fill(StreamState* s, StreamBuffer* b) {
+    for (int tries = 0; b->count < s->depth && tries < s->depth; tries++) {
+        uint32_t block = b->next;
+        if (block >= MEMORY_SIZE) {
+            return;
+        }
+        b->next += s->line_size;
+        if (stream_holds(s, block)) {
+            continue;
+        }
+
+        int slot = (b->head + b->count) % s->depth;
+        if (cache_prefetch_to_buffer(s->level, block, stream_slot_data(s, b, slot), &b->ready[slot])) {
+            b->blocks[slot] = block;
+            b->count++;
+        }
+    }
+}
+
+static void stream_observe(void* state, const PrefetchAccess* a) {
+    StreamState* s = state;
+    if (a->hit) {
+        return;
+    }
+
+    StreamBuffer* victim = &s->buf[0];
+    for (int i = 1; i < STREAM_BUFFERS; i++) {
+        if (s->buf[i].last_use < victim->last_use) {
+            victim = &s->buf[i];
+        }
+    }
+    while (victim->count > 0) {
+        stream_pop(s, victim, false);
+    }
+    victim->head = 0;
+    victim->next = (a->address & ~(s->line_size - 1)) + s->line_size;
+    victim->last_use = ++s->tick;
+    stream_fill(s, victim);
+}
+
+static bool stream_take(void* state, uint32_t block, uint8_t* out, uint64_t* ready) {
+    StreamState* s = state;
+
+    for (int i = 0; i < STREAM_BUFFERS; i++) {
+        StreamBuffer* b = &s->buf[i];
+        for (int k = 0; k < b->count; k++) {
+            int slot = (b->head + k) % s->depth;
+            if (b->blocks[slot] != block) {
+                continue;
+            }
+            // 앞선 블록들은 건너뛴 것이므로 버린다
+            for (int skip = 0; skip < k; skip++) {
+                stream_pop(s, b, false);
+            }
+            memcpy(out, stream_slot_data(s, b, b->head), s->line_size);
+            *ready = b->ready[b->head];
+            stream_pop(s, b, true);
+            b->last_use = ++s->tick;
+            stream_fill(s, b);
+            return true;
+        }
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// target: next-N-line에 더해 분기/점프의 정적 목적지 라인을 미리 가져온다 (jr 제외)
+// ---------------------------------------------------------------------------
+
+static void target_observe(void* state, const PrefetchAccess* a) {
+    const NextLineState* s = state;
+    uint32_t opcode = a->word >> 26;
+    uint32_t target;
+
+    next_line_issue(s, a);
+
+    if (opcode == 0x02 || opcode == 0x03) {
+        target = ((a->pc + 4) & 0xF0000000) | ((a->word & 0x03FFFFFF) << 2);
+    } else if (opcode == 0x04 || opcode == 0x05) {
+        target = a->pc + 4 + ((uint32_t)(int32_t)(int16_t)(a->word & 0xFFFF) << 2);
+    } else {
+        return;
+    }
+    cache_prefetch(s->level, target);
+}
+
+// ---------------------------------------------------------------------------
+
+static const PrefetcherOps prefetcher_list[] = {
+    [PF_NONE]      = {"none", NULL, NULL, NULL, NULL, NULL},
+    [PF_NEXT_LINE] = {"nextline", next_line_create, next_line_observe, NULL, free, NULL},
+    [PF_STRIDE]    = {"stride", stride_create, stride_observe, NULL, free, stride_checkpoint},
+    [PF_STREAM]    = {"stream", stream_create, stream_observe, stream_take, stream_destroy, stream_checkpoint},
+    [PF_TARGET]    = {"target", next_line_create, target_observe, NULL, free, NULL},
+};
+
+#define NUM_PREFETCHERS ((int)(sizeof(prefetcher_list) / sizeof(prefetcher_list[0])))
+
+int parse_prefetcher(const char* name, PrefetcherKind* kind) {
+    for (int i = 0; i < NUM_PREFETCHERS; i++) {
+        if (strcmp(name, prefetcher_list[i].name) == 0) {
+            *kind = (PrefetcherKind)i;
+            return 0;
+        }
+    }
+    fprintf(stderr, "Unknown prefetcher: %s (", name);
+    for (int i = 0; i < NUM_PREFETCHERS; i++) {
+        fprintf(stderr, "%s%s", i ? ", " : "", prefetcher_list[i].name);
+    }
+    fprintf(stderr, ")\n");
+    return -1;
+}
+
+const char* prefetcher_name(PrefetcherKind kind) {
+    return prefetcher_list[kind].name;
+}
+
+void free_prefetchers(void) {
+    struct PrefetchUnits* u = sim->prefetch;
+    if (u == NULL) {
+        return;
+    }
+    for (int level = CACHE_L1I; level <= CACHE_L1D; level++) {
+        if (u->ops[level] != NULL && u->state[level] != NULL) {
+            u->ops[level]->destroy(u->state[level]);
+        }
+    }
+    free(u);
+    sim->prefetch = NULL;
+}
+
+// init_cache가 L1을 만든 뒤 부른다
+void init_prefetchers(void) {
+    free_prefetchers();
+
+    struct PrefetchUnits* u = calloc(1, sizeof(struct PrefetchUnits));
+    if (u == NULL) {
+        fprintf(stderr, "prefetcher: out of memory\n");
+        exit(1);
+    }
+    sim->prefetch = u;
+
+    for (int level = CACHE_L1I; level <= CACHE_L1D; level++) {
+        const CacheConfig* cfg = &sim->cache_config[level];
+        if (cfg->prefetcher == PF_NONE) {
+            continue;
+        }
+        u->ops[level] = &prefetcher_list[cfg->prefetcher];
+        u->state[level] = u->ops[level]->create(level, cfg->line_size, sim->prefetch_degree);
+        if (u->state[level] == NULL) {
+            fprintf(stderr, "prefetcher: out of memory\n");
+            exit(1);
+        }
+    }
+}
+
+void prefetch_observe(int level, uint32_t pc, uint32_t address, uint32_t word, bool hit, bool prefetched) {
+    struct PrefetchUnits* u = sim->prefetch;
+    PrefetchAccess a = {pc, address, word, hit, prefetched};
+    u->ops[level]->observe(u->state[level], &a);
+}
+
+bool prefetch_take(int level, uint32_t block, uint8_t* out, uint64_t* ready) {
+    struct PrefetchUnits* u = sim->prefetch;
+    if (u->ops[level]->take == NULL) {
+        return false;
+    }
+    return u->ops[level]->take(u->state[level], block, out, ready);
+}
+
+void prefetch_checkpoint(Checkpoint* ck) {
+    struct PrefetchUnits* u = sim->prefetch;
+    for (int level = CACHE_L1I; level <= CACHE_L1D; level++) {
+        if (u->ops[level] != NULL && u->ops[level]->checkpoint != NULL) {
+            u->ops[level]->checkpoint(u->state[level], ck);
+        }
+    }
+}
@@ -0,0 +1,572 @@
+#define _POSIX_C_SOURCE 200809L
+#include "structure.h"
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// 트레이스 기반 캐시/분기 예측기 재생 (mips_replay)
+// mips_pipeline --trace-out으로 기록한 동적 명령어 스트림을 한 번만 mmap하고,
+// 구성마다 독립된 SimContext를 만들어 cache.c, branch_*.c, btb.c에 그대로 흘려 넣는다.
+// 파이프라인 없이 프로그램 순서로 접근하지만 파이프라인도 잘못된 경로의 슬롯은
+// 페치 전에 버리므로 L1 I/D와 분기 방향/목적지 예측 통계는 mips_pipeline과 같다.
+// 통합 L2/L3에서는 같은 사이클의 I/D 접근 순서가 달라 미세하게 어긋날 수 있다.
+
+typedef struct {
+    const uint8_t* data;        // mmap 안의 청크 내용
+    TraceChunkHeader hdr;
+} ChunkRef;
+
+typedef struct {
+    const uint8_t* map;
+    size_t size;
+    ChunkRef* chunks;
+    int num_chunks;
+    uint64_t records;
+} TraceFile;
+
+typedef struct {
+    uint64_t records;           // 통계를 모은 명령어 수
+    uint64_t skipped;           // fast-forward 구간의 명령어 수
+    bool in_ff;
+    bool jump_pending;          // j/jal/jr의 목적지는 다음 레코드의 PC
+    uint32_t jump_pc;
+    uint32_t jump_word;
+} ReplayState;
+
+typedef struct {
+    char* config;               // 구성 파일의 원래 줄 (보고서용)
+    SimContext* ctx;
+    int status;
+
+    uint64_t records;
+    uint64_t branch_predictions;
+    uint64_t branch_correct;
+    uint64_t fetch_redirects;
+    CacheLevelSummary levels[CACHE_NUM_LEVELS];
+    bool level_enabled[CACHE_NUM_LEVELS];
+    double seconds;
+} ReplayJob;
+
+typedef struct {
+    const TraceFile* trace;
+    ReplayJob* jobs;
+    int num_jobs;
+    int next_job;               // 워커들이 원자적으로 가져가는 다음 작업 번호
+} ReplayPool;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// 파일을 매핑하고 청크 목차를 만든다. 내용은 워커들이 필요할 때 읽는다.
+static int open_trace(const char* path, TraceFile* tf) {
+    memset(tf, 0, sizeof(*tf));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < BINTRACE_FILE_HEADER_SIZE) {
+        fprintf(stderr, "%s: not a binary trace\n", path);
+        close(fd);
+        return -1;
+    }
+    tf->size = (size_t)st.st_size;
+    void* map = mmap(NULL, tf->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("mmap");
+        return -1;
+    }
+    tf->map = map;
+
+    if (bintrace_check_file_header(tf->map, tf->size) != 0) {
+        fprintf(stderr, "%s: not a binary trace (or unsupported version)\n", path);
+        return -1;
+    }
+
+    int capacity = 0;
+    size_t pos = BINTRACE_FILE_HEADER_SIZE;
+    bool ended = false;
+
+    while (pos + BINTRACE_CHUNK_HEADER_SIZE <= tf->size) {
+        TraceChunkHeader hdr;
+        bintrace_read_chunk_header(tf->map + pos, &hdr);
+        pos += BINTRACE_CHUNK_HEADER_SIZE;
+
+        if (hdr.first_seq != tf->records) {
+            fprintf(stderr, "%s: chunk out of sequence at offset %zu\n", path, pos);
+            return -1;
+        }
+        if (hdr.records == 0) {
+            ended = true;
+            break;
+        }
+        if (hdr.stored_bytes > tf->size - pos) {
+            break;
+        }
+        if (hdr.raw_bytes > BINTRACE_CHUNK_SIZE ||
+            (hdr.method != BT_CHUNK_LZ && (hdr.method != BT_CHUNK_RAW || hdr.stored_bytes != hdr.raw_bytes))) {
+            fprintf(stderr, "%s: corrupt chunk header at offset %zu\n", path, pos);
+            return -1;
+        }
+
+        if (tf->num_chunks == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            tf->chunks = realloc(tf->chunks, sizeof(ChunkRef) * capacity);
+        }
+        tf->chunks[tf->num_chunks].data = tf->map + pos;
+        tf->chunks[tf->num_chunks].hdr = hdr;
+        tf->num_chunks++;
+        tf->records += hdr.records;
+        pos += hdr.stored_bytes;
+    }
+
+    // 기록 도중 끊긴 트레이스는 남은 청크까지만 재생한다
+    if (!ended) {
+        fprintf(stderr, "%s: warning: no end marker, trace is truncated\n", path);
+    }
+    return 0;
+}
+
+static void close_trace(TraceFile* tf) {
+    if (tf->map != NULL) {
+        munmap((void*)tf->map, tf->size);
+    }
+    free(tf->chunks);
+}
+
+static void count_redirect(uint32_t predicted_next, uint32_t actual_next) {
+    if (predicted_next != actual_next) {
+        sim->fetch_redirects++;
+        sim->fetch_squashed += sim->mispredict_penalty;
+    }
+}
+
+// stage_IF의 BTB 조회와 stage_ID의 결과 반영. 점프는 목적지를 알게 된 뒤 한 번에 처리한다.
+static void resolve_jump(ReplayState* rs, uint32_t target) {
+    uint32_t opcode = rs->jump_word >> 26;
+    uint32_t rs_reg = (rs->jump_word >> 21) & 0x1f;
+    ControlFlowKind kind = CF_JUMP;
+    bool btb_hit;
+
+    if (opcode == 0x3) {
+        kind = CF_CALL;
+    } else if (opcode == 0x0) {
+        kind = (rs_reg == 31) ? CF_RETURN : CF_INDIRECT;
+    }
+
+    uint32_t next = predict_fetch_target(rs->jump_pc, false, &btb_hit);
+    resolve_control_flow(rs->jump_pc, kind, target, true, btb_hit);
+    count_redirect(next, target);
+    rs->jump_pending = false;
+}
+
+// fast-forward 구간이 끝났는지 (functional.c의 fast_forward와 같은 조건)
+static bool ff_done(const ReplayState* rs, uint32_t pc) {
+    if (sim->ff_insts > 0 && rs->skipped >= sim->ff_insts) {
+        return true;
+    }
+    return sim->ff_use_pc && pc == sim->ff_stop_pc;
+}
+
+static void replay_record(ReplayState* rs, const TraceRecord* rec) {
+    if (rs->jump_pending) {
+        resolve_jump(rs, rec->pc);
+    }
+
+    if (rs->in_ff) {
+        if (ff_done(rs, rec->pc)) {
+            rs->in_ff = false;
+            // 워밍했으면 상태는 두고 통계만 비운다
+            if (sim->ff_warm) {
+                reset_cache_statistics();
+                if (sim->cache_sweep_enabled) {
+                    reset_cache_sweep_statistics();
+                }
+                reset_branch_predictor();
+                reset_target_predictor();
+            }
+        } else {
+            rs->skipped++;
+            if (!sim->ff_warm) {
+                return;
+            }
+        }
+    }
+    if (!rs->in_ff) {
+        rs->records++;
+    }
+
+    cache_read_instruction(rec->pc);
+
+    if (rec->flags & BT_BRANCH) {
+        bool taken = (rec->flags & BT_TAKEN) != 0;
+        uint32_t target = rec->pc + 4 + ((uint32_t)(int32_t)(int16_t)(rec->word & 0xffff) << 2);
+        bool predicted = predict_branch(rec->pc);
+        bool btb_hit;
+        uint32_t next = predict_fetch_target(rec->pc, predicted, &btb_hit);
+
+        update_branch_predictor(rec->pc, taken, predicted);
+        resolve_control_flow(rec->pc, CF_BRANCH, target, taken, btb_hit);
+        count_redirect(next, taken ? target : rec->pc + 4);
+    } else if (rec->flags & BT_JUMP) {
+        rs->jump_pending = true;
+        rs->jump_pc = rec->pc;
+        rs->jump_word = rec->word;
+    } else if (rec->addr + 4 <= MEMORY_SIZE) {
+        // 범위를 벗어난 주소는 stage_MEM처럼 캐시에 가지 않는다
+        if (rec->flags & BT_LOAD) {
+            cache_read_data(rec->addr, rec->pc);
+        } else if (rec->flags & BT_STORE) {
+            cache_write_data(rec->addr, 0, rec->pc);
+        }
+    }
+}
+
+// 현재 컨텍스트(sim)에 트레이스 전체를 재생한다
+static int replay_trace(const TraceFile* tf, ReplayState* rs) {
+    uint8_t* raw = malloc(BINTRACE_CHUNK_SIZE);
+    TraceCodec* codec = malloc(sizeof(TraceCodec));
+    if (raw == NULL || codec == NULL) {
+        fprintf(stderr, "replay: out of memory\n");
+        free(raw);
+        free(codec);
+        return -1;
+    }
+
+    memset(rs, 0, sizeof(*rs));
+    rs->in_ff = (sim->ff_insts > 0 || sim->ff_use_pc);
+    init_cache();
+    init_branch_predictor();
+    init_target_predictor();
+
+    int status = 0;
+    for (int c = 0; c < tf->num_chunks && status == 0; c++) {
+        const ChunkRef* chunk = &tf->chunks[c];
+        const uint8_t* in = chunk->data;
+
+        if (chunk->hdr.method == BT_CHUNK_LZ) {
+            if (bintrace_lz_decompress(chunk->data, chunk->hdr.stored_bytes, raw, chunk->hdr.raw_bytes) != 0) {
+                fprintf(stderr, "replay: corrupt chunk %d\n", c);
+                status = -1;
+                break;
+            }
+            in = raw;
+        }
+
+        bintrace_codec_reset(codec);
+        size_t pos = 0;
+        for (uint32_t r = 0; r < chunk->hdr.records; r++) {
+            TraceRecord rec;
+            size_t n = bintrace_decode(codec, in + pos, chunk->hdr.raw_bytes - pos, &rec);
+            if (n == 0) {
+                fprintf(stderr, "replay: corrupt record in chunk %d\n", c);
+                status = -1;
+                break;
+            }
+            pos += n;
+            replay_record(rs, &rec);
+        }
+    }
+
+    // 마지막 jr $31은 0xFFFFFFFF로 돌아간다
+    if (rs->jump_pending) {
+        resolve_jump(rs, 0xFFFFFFFF);
+    }
+    cache_flush();
+    sim->ff_inst_count = rs->skipped;
+
+    free(raw);
+    free(codec);
+    return status;
+}
+
+static void* replay_worker(void* arg) {
+    ReplayPool* pool = arg;
+
+    for (;;) {
+        int index = __atomic_fetch_add(&pool->next_job, 1, __ATOMIC_RELAXED);
+        if (index >= pool->num_jobs) {
+            break;
+        }
+
+        ReplayJob* job = &pool->jobs[index];
+        double start = now_seconds();
+        ReplayState rs;
+
+        sim = job->ctx;
+        job->status = replay_trace(pool->trace, &rs);
+        if (job->status == 0) {
+            job->records = rs.records;
+            job->branch_predictions = sim->branch_predictions;
+            job->branch_correct = sim->branch_correct_predictions;
+            job->fetch_redirects = sim->fetch_redirects;
+            for (int level = 0; level < CACHE_NUM_LEVELS; level++) {
+                job->level_enabled[level] = sim->cache_config[level].sets > 0;
+                get_cache_level_summary(level, &job->levels[level]);
+            }
+        }
+        sim = NULL;
+
+        sim_destroy(job->ctx);
+        job->ctx = NULL;
+        job->seconds = now_seconds() - start;
+    }
+    return NULL;
+}
+
+static void print_hit_rate(const ReplayJob* job, int level) {
+    const CacheLevelSummary* s = &job->levels[level];
+    if (!job->level_enabled[level] || s->access == 0) {
+        printf("  %8s", "-");
+    } else {
+        printf("  %7.3f%%", 100.0 * s->hit / s->access);
+    }
+}
+
+static void print_replay_report(const ReplayPool* pool, int threads, double wall) {
+    uint64_t total_records = 0;
+    double cpu_seconds = 0;
+    int failed = 0;
+
+    printf("================================================================================\n");
+    printf("Trace Replay: %llu records, %d configurations, %d threads\n",
+           (unsigned long long)pool->trace->records, pool->num_jobs, threads);
+    printf("================================================================================\n");
+    printf("%3s  %12s  %8s  %8s  %8s  %8s  %8s  %10s  %s\n",
+           "#", "insts", "L1I hit", "L1D hit", "L2 hit", "L3 hit", "bp acc", "redirects", "config");
+
+    for (int i = 0; i < pool->num_jobs; i++) {
+        const ReplayJob* job = &pool->jobs[i];
+        cpu_seconds += job->seconds;
+
+        if (job->status != 0) {
+            printf("%3d  %12s  %s (failed)\n", i + 1, "-", job->config);
+            failed++;
+            continue;
+        }
+
+        total_records += pool->trace->records;
+        printf("%3d  %12llu", i + 1, (unsigned long long)job->records);
+        for (int level = 0; level < CACHE_NUM_LEVELS; level++) {
+            print_hit_rate(job, level);
+        }
+        if (job->branch_predictions > 0) {
+            printf("  %7.2f%%", 100.0 * job->branch_correct / job->branch_predictions);
+        } else {
+            printf("  %8s", "-");
+        }
+        printf("  %10llu  %s\n", (unsigned long long)job->fetch_redirects, job->config);
+    }
+
+    printf("\nMerged:\n");
+    printf("  completed configurations             : %d\n", pool->num_jobs - failed);
+    printf("  total replayed records               : %llu\n", (unsigned long long)total_records);
+    printf("  wall time                            : %.3f s\n", wall);
+    printf("  summed per-config time               : %.3f s\n", cpu_seconds);
+    if (wall > 0) {
+        printf("  replayed records per second          : %.0f\n", total_records / wall);
+    }
+    printf("=================================================================================\n");
+}
+
+static int run_replay_sweep(const TraceFile* tf, const char* config_file, int jobs) {
+    ReplayPool pool = {tf, NULL, 0, 0};
+    SimContext** ctxs;
+    char** lines;
+
+    pool.num_jobs = sim_read_config_file(config_file, sim, &ctxs, &lines);
+    if (pool.num_jobs < 0) {
+        return -1;
+    }
+    if (pool.num_jobs == 0) {
+        fprintf(stderr, "%s: no configurations\n", config_file);
+        return -1;
+    }
+
+    pool.jobs = calloc(pool.num_jobs, sizeof(ReplayJob));
+    for (int i = 0; i < pool.num_jobs; i++) {
+        pool.jobs[i].ctx = ctxs[i];
+        pool.jobs[i].config = lines[i];
+    }
+    free(ctxs);
+    free(lines);
+
+    if (jobs <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        jobs = (cores > 0) ? (int)cores : 1;
+    }
+    if (jobs > pool.num_jobs) {
+        jobs = pool.num_jobs;
+    }
+
+    // 워커는 출력하지 않는다 (보고서만 메인 스레드에서)
+    trace_level = TRACE_LEVEL_QUIET;
+
+    pthread_t* threads = malloc(sizeof(pthread_t) * jobs);
+    double start = now_seconds();
+
+    int started = 0;
+    for (int i = 0; i < jobs; i++) {
+        if (pthread_create(&threads[i], NULL, replay_worker, &pool) != 0) {
+            break;
+        }
+        started++;
+    }
+
+    if (started == 0) {
+        // 스레드를 만들 수 없으면 현재 스레드에서 순서대로 실행
+        SimContext* saved = sim;
+        replay_worker(&pool);
+        sim = saved;
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    print_replay_report(&pool, started ? started : 1, now_seconds() - start);
+
+    for (int i = 0; i < pool.num_jobs; i++) {
+        free(pool.jobs[i].config);
+    }
+    free(pool.jobs);
+    free(threads);
+    return 0;
+}
+
+// 명령행 구성 하나를 재생하고 mips_pipeline과 같은 형식으로 통계를 출력한다
+static int run_single_replay(const TraceFile* tf, bool cache_sweep) {
+    ReplayState rs;
+
+    if (validate_cache_config() != 0) {
+        return -1;
+    }
+    if (cache_sweep) {
+        init_cache_sweep();
+    }
+    if (TRACE_INFO_ON()) {
+        print_cache_configuration();
+        printf("\n");
+    }
+
+    double start = now_seconds();
+    if (replay_trace(tf, &rs) != 0) {
+        return -1;
+    }
+    double seconds = now_seconds() - start;
+
+    printf("================================================================================\n");
+    printf("replayed instructions                : %llu\n", (unsigned long long)rs.records);
+    if (rs.skipped > 0) {
+        printf("fast-forwarded instructions          : %llu\n", (unsigned long long)rs.skipped);
+    }
+    printf("replay time                          : %.3f s (%.0f records/s)\n",
+           seconds, seconds > 0 ? tf->records / seconds : 0.0);
+    print_branch_prediction_stats();
+    print_target_prediction_stats();
+    print_cache_statistics();
+    printf("=================================================================================\n");
+    if (cache_sweep) {
+        print_cache_sweep();
+    }
+    return 0;
+}
+
+static void print_usage(const char* prog) {
+    fprintf(stderr, "사용법: %s [options] <trace file>\n", prog);
+    fprintf(stderr, "  (mips_pipeline --trace-out으로 기록한 트레이스를 캐시/분기 예측기에 재생)\n");
+    fprintf(stderr, "  -q, --quiet             구성 정보 출력 생략\n");
+    fprintf(stderr, "  --sweep-configs FILE    FILE의 각 줄(구성 옵션)을 별도 컨텍스트로 병렬 재생\n");
+    fprintf(stderr, "  --jobs N                재생 워커 스레드 수 (기본값: 코어 수)\n");
+    fprintf(stderr, "  --cache-sweep           한 번의 재생으로 여러 LRU 캐시 구성의 미스율 표 출력\n");
+    fprintf(stderr, "  --fast-forward N        처음 N개 명령어는 통계에서 제외 (--ff-warm이면 워밍에 사용)\n");
+    fprintf(stderr, "  --ff-until-pc X         PC가 X(hex)에 도달할 때까지 통계에서 제외\n");
+    fprintf(stderr, "  --ff-warm               fast-forward 구간으로 캐시와 분기 예측기 워밍\n");
+    fprintf(stderr, "  --l1i/--l1d/--l2/--l3 SETSxWAYSxLINE  캐시 레벨 구성 (L2/L3는 지정해야 활성화)\n");
+    fprintf(stderr, "  --<level>-repl P        교체 정책 (lru, fifo, random, plru, bitplru, srrip, brrip, drrip)\n");
+    fprintf(stderr, "  --cache-seed N          random/brrip/drrip 교체의 난수 시드\n");
+    fprintf(stderr, "  --<level>-latency N     캐시 히트 지연 사이클 (1..%d, 기본값 %d)\n", CACHE_MAX_LATENCY, CACHE_DEFAULT_LATENCY);
+    fprintf(stderr, "  --mem-latency N         메모리 접근 지연 사이클 (기본값 %d)\n", MEMORY_DEFAULT_LATENCY);
+    fprintf(stderr, "  --l2-incl/--l3-incl P   포함 정책 (inclusive, exclusive, nine)\n");
+    fprintf(stderr, "  --l1d-pf P              D-캐시 프리페처 (none, nextline, stride, stream)\n");
+    fprintf(stderr, "  --l1i-pf P              I-캐시 프리페처 (none, nextline, target)\n");
+    fprintf(stderr, "  --l1d-victim/--l1i-victim N  L1과 하위 레벨 사이 완전 연관 victim cache 라인 수 (0..%d)\n", VICTIM_MAX_ENTRIES);
+    fprintf(stderr, "  --pf-degree N           앞서 가져올 라인 수 / 스트림 버퍼 깊이 (기본값 %d)\n", PF_DEFAULT_DEGREE);
+    fprintf(stderr, "  --bp NAME               분기 예측기 (bimodal, gshare, tournament, tage, perceptron)\n");
+    fprintf(stderr, "  --bp-budget BYTES       분기 예측기 저장 공간 예산 (기본값 %d)\n", BP_DEFAULT_BUDGET);
+    fprintf(stderr, "  --btb-entries N         BTB 엔트리 수, 0 또는 2의 거듭제곱 (기본값 %d)\n", BTB_DEFAULT_ENTRIES);
+    fprintf(stderr, "  --ras-depth N           리턴 주소 스택 깊이, 0이면 사용 안 함 (기본값 %d)\n", RAS_DEFAULT_DEPTH);
+    fprintf(stderr, "  --mispredict-penalty N  페치 방향 전환마다 버리는 슬롯 수 (기본값 %d)\n", MISPREDICT_DEFAULT_PENALTY);
+}
+
+int main(int argc, char *argv[]) {
+    const char* trace_path = NULL;
+    const char* sweep_configs = NULL;
+    bool cache_sweep = false;
+    int jobs = 0;
+
+    sim = sim_create();
+    if (sim == NULL) {
+        fprintf(stderr, "Failed to allocate simulator context\n");
+        return 1;
+    }
+
+    // 재생에는 사이클 트레이스가 없다
+    trace_level = TRACE_LEVEL_INFO;
+    trace_mask = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        int used = sim_apply_option(sim, argc, argv, i);
+
+        if (used < 0) {
+            return 1;
+        } else if (used > 0) {
+            i += used - 1;
+        } else if (strcmp(arg, "-q") == 0 || strcmp(arg, "--quiet") == 0) {
+            trace_level = TRACE_LEVEL_QUIET;
+        } else if (strcmp(arg, "--sweep-configs") == 0 && i + 1 < argc) {
+            sweep_configs = argv[++i];
+        } else if (strcmp(arg, "--jobs") == 0 && i + 1 < argc) {
+            jobs = atoi(argv[++i]);
+        } else if (strcmp(arg, "--cache-sweep") == 0) {
+            cache_sweep = true;
+        } else if (arg[0] == '-' && arg[1] == '-') {
+            print_usage(argv[0]);
+            return 1;
+        } else if (trace_path == NULL) {
+            trace_path = arg;
+        }
+    }
+
+    if (trace_path == NULL) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    TraceFile tf;
+    if (open_trace(trace_path, &tf) != 0) {
+        close_trace(&tf);
+        return 1;
+    }
+
+    int status;
+    if (sweep_configs != NULL) {
+        status = run_replay_sweep(&tf, sweep_configs, jobs);
+    } else {
+        status = run_single_replay(&tf, cache_sweep);
+    }
+
+    close_trace(&tf);
+    sim_destroy(sim);
+    return (status == 0) ? 0 : 1;
+}
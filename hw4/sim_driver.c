@@ -0,0 +1,213 @@
+#define _POSIX_C_SOURCE 200809L
+#include "structure.h"
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+// 설계 공간 탐색 드라이버
+// 구성 파일의 각 줄(명령행과 같은 구성 옵션, 예: "--l1d 64x2x16 --l2 256x4x32")을
+// 독립된 SimContext로 만들어 스레드 풀에서 실행하고, 결과를 한 표로 합친다.
+
+typedef struct {
+    char* config;               // 구성 파일의 원래 줄 (보고서용)
+    SimContext* ctx;
+    int status;
+
+    // 실행이 끝난 뒤 컨텍스트에서 모은 통계
+    uint32_t r2;
+    uint64_t cycles;
+    uint64_t ff_insts;
+    uint64_t branch_predictions;
+    uint64_t branch_correct;
+    uint64_t touched_pages;
+    CacheLevelSummary levels[CACHE_NUM_LEVELS];
+    bool level_enabled[CACHE_NUM_LEVELS];
+    double seconds;
+} SweepJob;
+
+typedef struct {
+    const char* program_path;
+    uint32_t entry_pc;
+    SweepJob* jobs;
+    int num_jobs;
+    int next_job;               // 워커들이 원자적으로 가져가는 다음 작업 번호
+} SweepPool;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void collect_job_results(SweepJob* job) {
+    job->r2 = sim->registers.regs[2];
+    job->cycles = sim->inst_count;
+    job->ff_insts = sim->ff_inst_count;
+    job->branch_predictions = sim->branch_predictions;
+    job->branch_correct = sim->branch_correct_predictions;
+    job->touched_pages = sim->memory.touched_pages;
+    for (int level = 0; level < CACHE_NUM_LEVELS; level++) {
+        job->level_enabled[level] = sim->cache_config[level].sets > 0;
+        get_cache_level_summary(level, &job->levels[level]);
+    }
+}
+
+static void* sweep_worker(void* arg) {
+    SweepPool* pool = arg;
+
+    for (;;) {
+        int index = __atomic_fetch_add(&pool->next_job, 1, __ATOMIC_RELAXED);
+        if (index >= pool->num_jobs) {
+            break;
+        }
+
+        SweepJob* job = &pool->jobs[index];
+        double start = now_seconds();
+
+        sim = job->ctx;
+        job->status = sim_run(pool->program_path, pool->entry_pc);
+        if (job->status == 0) {
+            collect_job_results(job);
+        }
+        sim = NULL;
+
+        // 게스트 페이지는 결과를 모은 즉시 돌려준다
+        sim_destroy(job->ctx);
+        job->ctx = NULL;
+        job->seconds = now_seconds() - start;
+    }
+    return NULL;
+}
+
+static int read_sweep_configs(const char* path, const SimContext* base, SweepJob** jobs_out) {
+    SimContext** ctxs;
+    char** lines;
+    int num_jobs = sim_read_config_file(path, base, &ctxs, &lines);
+    if (num_jobs < 0) {
+        return -1;
+    }
+
+    SweepJob* jobs = calloc(num_jobs ? num_jobs : 1, sizeof(SweepJob));
+    for (int i = 0; i < num_jobs; i++) {
+        jobs[i].ctx = ctxs[i];
+        jobs[i].config = lines[i];
+    }
+    free(ctxs);
+    free(lines);
+    *jobs_out = jobs;
+    return num_jobs;
+}
+
+static void print_hit_rate(const SweepJob* job, int level) {
+    const CacheLevelSummary* s = &job->levels[level];
+    if (!job->level_enabled[level] || s->access == 0) {
+        printf("  %8s", "-");
+    } else {
+        printf("  %7.3f%%", 100.0 * s->hit / s->access);
+    }
+}
+
+static void print_sweep_report(const SweepPool* pool, int threads, double wall) {
+    uint64_t total_cycles = 0;
+    uint64_t total_pages = 0;
+    double cpu_seconds = 0;
+    int failed = 0;
+
+    printf("================================================================================\n");
+    printf("Design Sweep: %d configurations, %d threads\n", pool->num_jobs, threads);
+    printf("================================================================================\n");
+    printf("%3s  %12s  %6s  %8s  %8s  %8s  %8s  %8s  %6s  %s\n",
+           "#", "cycles", "r2", "L1I hit", "L1D hit", "L2 hit", "L3 hit", "bp acc", "pages", "config");
+
+    for (int i = 0; i < pool->num_jobs; i++) {
+        const SweepJob* job = &pool->jobs[i];
+        cpu_seconds += job->seconds;
+
+        if (job->status != 0) {
+            printf("%3d  %12s  %6s  %s (failed)\n", i + 1, "-", "-", job->config);
+            failed++;
+            continue;
+        }
+
+        total_cycles += job->cycles;
+        total_pages += job->touched_pages;
+        printf("%3d  %12llu  %6d", i + 1, (unsigned long long)job->cycles, (int32_t)job->r2);
+        for (int level = 0; level < CACHE_NUM_LEVELS; level++) {
+            print_hit_rate(job, level);
+        }
+        if (job->branch_predictions > 0) {
+            printf("  %7.2f%%", 100.0 * job->branch_correct / job->branch_predictions);
+        } else {
+            printf("  %8s", "-");
+        }
+        printf("  %6llu  %s\n", (unsigned long long)job->touched_pages, job->config);
+    }
+
+    printf("\nMerged:\n");
+    printf("  completed configurations             : %d\n", pool->num_jobs - failed);
+    printf("  total simulated cycles               : %llu\n", (unsigned long long)total_cycles);
+    printf("  total touched guest memory           : %llu KB\n",
+           (unsigned long long)total_pages * MEM_PAGE_SIZE / 1024);
+    printf("  wall time                            : %.3f s\n", wall);
+    printf("  summed per-config time               : %.3f s\n", cpu_seconds);
+    if (wall > 0) {
+        printf("  simulated cycles per second          : %.0f\n", total_cycles / wall);
+    }
+    printf("=================================================================================\n");
+}
+
+int run_design_sweep(const char* program_path, uint32_t entry_pc, const char* config_file, int jobs) {
+    SweepPool pool = {program_path, entry_pc, NULL, 0, 0};
+
+    pool.num_jobs = read_sweep_configs(config_file, sim, &pool.jobs);
+    if (pool.num_jobs < 0) {
+        return -1;
+    }
+    if (pool.num_jobs == 0) {
+        fprintf(stderr, "%s: no configurations\n", config_file);
+        return -1;
+    }
+
+    if (jobs <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        jobs = (cores > 0) ? (int)cores : 1;
+    }
+    if (jobs > pool.num_jobs) {
+        jobs = pool.num_jobs;
+    }
+
+    // 워커는 출력하지 않는다 (보고서만 메인 스레드에서)
+    trace_level = TRACE_LEVEL_QUIET;
+    trace_mask = 0;
+
+    pthread_t* threads = malloc(sizeof(pthread_t) * jobs);
+    double start = now_seconds();
+
+    int started = 0;
+    for (int i = 0; i < jobs; i++) {
+        if (pthread_create(&threads[i], NULL, sweep_worker, &pool) != 0) {
+            break;
+        }
+        started++;
+    }
+
+    if (started == 0) {
+        // 스레드를 만들 수 없으면 현재 스레드에서 순서대로 실행
+        SimContext* saved = sim;
+        sweep_worker(&pool);
+        sim = saved;
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    print_sweep_report(&pool, started ? started : 1, now_seconds() - start);
+
+    for (int i = 0; i < pool.num_jobs; i++) {
+        free(pool.jobs[i].config);
+    }
+    free(pool.jobs);
+    free(threads);
+    return 0;
+}
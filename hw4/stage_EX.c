@@ -32,70 +32,79 @@ uint32_t alu_operate(uint32_t operand1, uint32_t operand2, int alu_ctrl, Instruc
 }
 
 void stage_EX(void) {
-    if (!id_ex_latch.valid) {
-        ex_mem_latch.valid = false;
+    if (!sim->id_ex_latch.valid) {
+        sim->ex_mem_latch.valid = false;
         return;
     }
 
-    memset(&ex_mem_latch, 0, sizeof(ex_mem_latch));
+    memset(&sim->ex_mem_latch, 0, sizeof(sim->ex_mem_latch));
 
-    Instruction inst = id_ex_latch.instruction;
-    Control_Signals ctrl = id_ex_latch.control_signals;
+    Instruction inst = sim->id_ex_latch.instruction;
+    Control_Signals ctrl = sim->id_ex_latch.control_signals;
 
-    ex_mem_latch.control_signals = ctrl;
+    sim->ex_mem_latch.control_signals = ctrl;
 
     if (ctrl.get_imm == 3) {
-        ex_mem_latch.valid = true;
-        ex_mem_latch.pc = id_ex_latch.pc;
-        ex_mem_latch.instruction = inst;
-        ex_mem_latch.alu_result = id_ex_latch.sign_imm;
-        ex_mem_latch.rt_value = 0;
-        ex_mem_latch.write_reg = id_ex_latch.write_reg;
+        sim->ex_mem_latch.valid = true;
+        sim->ex_mem_latch.pc = sim->id_ex_latch.pc;
+        sim->ex_mem_latch.instruction = inst;
+        sim->ex_mem_latch.alu_result = sim->id_ex_latch.sign_imm;
+        sim->ex_mem_latch.rt_value = 0;
+        sim->ex_mem_latch.write_reg = sim->id_ex_latch.write_reg;
         
-        printf("[EX] PC=0x%08x, lui: immediate = 0x%08x\n", 
-               id_ex_latch.pc, id_ex_latch.sign_imm);
+        TRACE(TRACE_PIPELINE, "[EX] PC=0x%08x, lui: immediate = 0x%08x\n", 
+               sim->id_ex_latch.pc, sim->id_ex_latch.sign_imm);
+        if (BINTRACE_ON()) {
+            bintrace_record(sim->id_ex_latch.pc, sim->id_ex_latch.word, 0, 0);
+        }
         return;
     }
 
     if (ctrl.ex_skip != 0) {
-        ex_mem_latch.valid = false;
+        sim->ex_mem_latch.valid = false;
         return;
     }
 
     if (ctrl.reg_wb == 1) {         
-        ex_mem_latch.write_reg = id_ex_latch.write_reg;
+        sim->ex_mem_latch.write_reg = sim->id_ex_latch.write_reg;
     }
 
-    uint32_t operand1 = (id_ex_latch.forward_a >= 1) ? id_ex_latch.forward_a_val : id_ex_latch.rs_value;
+    uint32_t operand1 = (sim->id_ex_latch.forward_a >= 1) ? sim->id_ex_latch.forward_a_val : sim->id_ex_latch.rs_value;
 
     uint32_t alu_result = 0;
 
     if (ctrl.reg_dst == 1) {
-        uint32_t operand2 = (id_ex_latch.forward_b >= 1) ? id_ex_latch.forward_b_val : id_ex_latch.rt_value;
+        uint32_t operand2 = (sim->id_ex_latch.forward_b >= 1) ? sim->id_ex_latch.forward_b_val : sim->id_ex_latch.rt_value;
 
         if (ctrl.alu_ctrl >= 0b1110) {
-            alu_result = alu_operate(operand2, id_ex_latch.shamt, ctrl.alu_ctrl, &inst);
+            alu_result = alu_operate(operand2, sim->id_ex_latch.shamt, ctrl.alu_ctrl, &inst);
         } else {
             alu_result = alu_operate(operand1, operand2, ctrl.alu_ctrl, &inst);
         }
     }
     // SW 명령어 
     else if (ctrl.mem_write == 1) {
-        alu_result = alu_operate(operand1, id_ex_latch.sign_imm, ctrl.alu_ctrl, &inst);
-        ex_mem_latch.rt_value = (id_ex_latch.forward_b >= 1) ? id_ex_latch.forward_b_val : id_ex_latch.rt_value;
+        alu_result = alu_operate(operand1, sim->id_ex_latch.sign_imm, ctrl.alu_ctrl, &inst);
+        sim->ex_mem_latch.rt_value = (sim->id_ex_latch.forward_b >= 1) ? sim->id_ex_latch.forward_b_val : sim->id_ex_latch.rt_value;
     }
     // I-type 명령어
     else {
-        alu_result = alu_operate(operand1, id_ex_latch.sign_imm, ctrl.alu_ctrl, &inst);
+        alu_result = alu_operate(operand1, sim->id_ex_latch.sign_imm, ctrl.alu_ctrl, &inst);
     }
 
-    ex_mem_latch.valid = true;
-    ex_mem_latch.pc = id_ex_latch.pc;
-    ex_mem_latch.instruction = inst;
-    ex_mem_latch.alu_result = alu_result;
+    sim->ex_mem_latch.valid = true;
+    sim->ex_mem_latch.pc = sim->id_ex_latch.pc;
+    sim->ex_mem_latch.instruction = inst;
+    sim->ex_mem_latch.alu_result = alu_result;
 
-    printf("[EX] PC=0x%08x, %s: ALU result = 0x%08x\n", 
-           id_ex_latch.pc, 
-           get_instruction_name(id_ex_latch.instruction.opcode, id_ex_latch.instruction.funct),
+    TRACE(TRACE_PIPELINE, "[EX] PC=0x%08x, %s: ALU result = 0x%08x\n", 
+           sim->id_ex_latch.pc, 
+           get_instruction_name(sim->id_ex_latch.instruction.opcode, sim->id_ex_latch.instruction.funct),
            alu_result);
+
+    // 분기/점프가 아닌 명령어는 주소가 정해지는 여기서 기록 (EX가 ID보다 먼저 실행되므로 프로그램 순서 유지)
+    if (BINTRACE_ON()) {
+        uint8_t flags = (ctrl.mem_read ? BT_LOAD : 0) | (ctrl.mem_write ? BT_STORE : 0);
+        bintrace_record(sim->id_ex_latch.pc, sim->id_ex_latch.word, flags, alu_result);
+    }
 }
\ No newline at end of file
@@ -1,94 +1,66 @@
 #include "structure.h"
 
-extern uint64_t r_count;
-extern uint64_t i_count;
-extern uint64_t branch_jr_count;
+// IF가 이어서 가져온 주소가 실제 다음 PC와 다르면 페치를 바로잡는다.
+// 잘못된 경로의 페치 슬롯 mispredict_penalty개는 step_pipeline에서 버블로 처리.
+static void redirect_fetch(uint32_t target) {
+    if (sim->if_id_latch.next_pc == target) {
+        TRACE(TRACE_BRANCH, "[ID] Target predicted: 0x%x\n", target);
+        return;
+    }
+    TRACE(TRACE_BRANCH, "[ID] Fetch redirect: 0x%x -> 0x%x\n", sim->if_id_latch.next_pc, target);
+    sim->registers.pc = target;
+    sim->fetch_redirects++;
+    sim->fetch_squash_pending = sim->mispredict_penalty;
+}
 
 void stage_ID() {
-    if (!if_id_latch.valid) {
-        id_ex_latch.valid = false;
+    if (!sim->if_id_latch.valid) {
+        sim->id_ex_latch.valid = false;
         return;
     }
 
-    uint32_t instruction = if_id_latch.instruction;
-    uint32_t pc = if_id_latch.pc;
-    uint32_t opcode = if_id_latch.opcode;
-    uint32_t funct = if_id_latch.funct;
+    uint32_t instruction = sim->if_id_latch.instruction;
+    uint32_t pc = sim->if_id_latch.pc;
 
-    printf("[ID] ");
-    print_instruction_details(pc, instruction);
-    printf("\n");
+    if (TRACE_ON(TRACE_PIPELINE)) {
+        printf("[ID] ");
+        print_instruction_details(pc, instruction);
+        printf("\n");
+    }
 
-    memset(&id_ex_latch, 0, sizeof(id_ex_latch));
+    memset(&sim->id_ex_latch, 0, sizeof(sim->id_ex_latch));
 
-    Control_Signals ctrl;
-    initialize_control(&ctrl);
-    
-    Instruction inst;
-    memset(&inst, 0, sizeof(inst));
-    inst.opcode = opcode;
-    inst.rs = if_id_latch.reg_src;
-    inst.rt = if_id_latch.reg_tar;
-    inst.funct = funct;
-    
-    // R-type
-    if (opcode == 0) {
-        inst.rd = (instruction >> 11) & 0x1f;
-        inst.shamt = (instruction >> 6) & 0x1f;
-    }
+    // 디코드 테이블 조회 (필드, 제어 신호, 확장된 immediate가 이미 준비됨)
+    const DecodedInst* dec = decode_lookup(pc, instruction);
+    const Control_Signals* ctrl = &dec->ctrl;
+    Instruction inst = dec->inst;
     
-    // J-type
-    if (opcode == 2 || opcode == 3) {
-        inst.jump_target = instruction & 0x3ffffff;
+    if (ctrl->reg_dst == 1) {
+        sim->r_count++;
     }
-    
-    setup_control_signals(&inst, &ctrl);
-    
-    if (ctrl.reg_dst == 1) {
-        r_count++;
-    }
-    if (ctrl.get_imm != 0) {
-        i_count++;
-    }
-    if (ctrl.ex_skip == 1) {
-        branch_jr_count++;
+    if (ctrl->get_imm != 0) {
+        sim->i_count++;
     }
-    
-    if (ctrl.reg_dst == 1) {                                
-        id_ex_latch.write_reg = (instruction >> 11) & 0x0000001f;        // rd
-    }
-    
-    if (ctrl.get_imm != 0) {
-        inst.immediate = instruction & 0xffff;
-        id_ex_latch.write_reg = inst.rt;
-        
-        if (ctrl.get_imm == 1) {
-            if ((inst.immediate >> 15) == 0) {
-                inst.immediate = (inst.immediate & 0x0000ffff);
-            } else {
-                inst.immediate = (inst.immediate | 0xffff0000);
-            }
-        } else if (ctrl.get_imm == 2) {
-            inst.immediate = (inst.immediate & 0x0000ffff);
-        } else if (ctrl.get_imm == 3) {
-            inst.immediate = inst.immediate << 16;
-        }
+    if (ctrl->ex_skip == 1) {
+        sim->branch_jr_count++;
     }
     
-    if (ctrl.ex_skip == 1) {
+    switch (dec->kind) {
+        case DECODE_BRANCH: {       // beq, bne
+            uint32_t opcode = inst.opcode;
 
-        if (opcode == 0x4 || opcode == 0x5) {        // beq, bne
-
-            bool predicted_taken = predict_branch(pc);
+            // 방향은 IF에서 이미 예측했고 그 경로로 페치 중
+            bool predicted_taken = sim->if_id_latch.predicted_taken;
             
-            uint32_t oper1 = (if_id_latch.forward_a >= 1) ? if_id_latch.forward_a_val : registers.regs[inst.rs];
-            uint32_t oper2 = (if_id_latch.forward_b >= 1) ? if_id_latch.forward_b_val : registers.regs[inst.rt];
+            uint32_t oper1 = (sim->if_id_latch.forward_a >= 1) ? sim->if_id_latch.forward_a_val : sim->registers.regs[inst.rs];
+            uint32_t oper2 = (sim->if_id_latch.forward_b >= 1) ? sim->if_id_latch.forward_b_val : sim->registers.regs[inst.rt];
 
             int beq_bne = (opcode == 0x4) ? 1 : 0;   // beq = 1, bne = 0
             int check = (oper1 == oper2);    
             bool actual_taken = (check == beq_bne);
+            uint32_t target = pc + 4 + dec->branch_offset;
             
-            printf("[ID] Branch: R%d(0x%x) %s R%d(0x%x), predicted=%s, actual=%s\n", 
+            TRACE(TRACE_BRANCH, "[ID] Branch: R%d(0x%x) %s R%d(0x%x), predicted=%s, actual=%s\n", 
                    inst.rs, oper1, 
                    (opcode == 0x4) ? "==" : "!=", 
                    inst.rt, oper2,
@@ -97,81 +69,89 @@ void stage_ID() {
             
             
             update_branch_predictor(pc, actual_taken, predicted_taken);
+            resolve_control_flow(pc, CF_BRANCH, target, actual_taken, sim->if_id_latch.btb_hit);
             
             if (actual_taken) {
-                
-                uint32_t sign_imm = instruction & 0xffff;                     
-                uint32_t branchaddr = sign_imm;
-
-                if ((sign_imm >> 15) == 1) { // branch-addr
-                    branchaddr = ((sign_imm << 2) | 0xfffc0000);
-                }
-                else if ((sign_imm >> 15) == 0) {
-                    branchaddr = ((sign_imm << 2) & 0x3ffc);
-                }
-                uint32_t new_pc = registers.pc + branchaddr;
-                printf("[ID] Branch taken: PC = 0x%x -> 0x%x\n", registers.pc, new_pc);
-                registers.pc = new_pc;
-                
+                TRACE(TRACE_BRANCH, "[ID] Branch taken: PC = 0x%x -> 0x%x\n", pc, target);
                 if (!predicted_taken) {
-                    printf("[ID] Branch misprediction: predicted not taken, actually taken\n");
+                    TRACE(TRACE_BRANCH, "[ID] Branch misprediction: predicted not taken, actually taken\n");
                 }
-                return;
             }
             else {
-                printf("[ID] Branch not taken: PC continues to 0x%x\n", registers.pc + 4);
+                TRACE(TRACE_BRANCH, "[ID] Branch not taken: PC continues to 0x%x\n", pc + 4);
                 if (predicted_taken) {
-                    printf("[ID] Branch misprediction: predicted taken, actually not taken\n");
+                    TRACE(TRACE_BRANCH, "[ID] Branch misprediction: predicted taken, actually not taken\n");
                 }
-                return;
             }
-        }   
-        // J (점프는 예측 불필요 - 항상 taken)
-        else if (opcode == 0x2) {   // j
+            if (BINTRACE_ON()) {
+                bintrace_record(pc, instruction, BT_BRANCH | (actual_taken ? BT_TAKEN : 0), 0);
+            }
+            // 예측 방향이 맞아도 BTB에 목적지가 없었으면 fall-through를 페치했다
+            redirect_fetch(actual_taken ? target : pc + 4);
+            return;
+        }
+        // J, JAL: 목적지는 명령어에 있지만 IF가 알려면 BTB가 필요
+        case DECODE_J: {
             uint32_t jaddr = inst.jump_target << 2;
-            printf("[ID] Jump: PC = 0x%x -> 0x%x\n", registers.pc, jaddr);
-            registers.pc = jaddr;
+            TRACE(TRACE_BRANCH, "[ID] Jump: PC = 0x%x -> 0x%x\n", pc, jaddr);
+            resolve_control_flow(pc, CF_JUMP, jaddr, true, sim->if_id_latch.btb_hit);
+            if (BINTRACE_ON()) {
+                bintrace_record(pc, instruction, BT_JUMP | BT_TAKEN, 0);
+            }
+            redirect_fetch(jaddr);
             return;
-        }   
-        // JAL (점프는 예측 불필요 - 항상 taken)
-        else if (opcode == 0x3) {   // jal
+        }
+        case DECODE_JAL: {
             uint32_t jaddr = inst.jump_target << 2;
-            printf("[ID] Jump and Link: PC = 0x%x -> 0x%x, R31 = 0x%x\n", 
-                   registers.pc, jaddr, registers.pc + 4);
-            registers.regs[31] = registers.pc + 4; // pc+8 
-            registers.pc = jaddr;
+            TRACE(TRACE_BRANCH, "[ID] Jump and Link: PC = 0x%x -> 0x%x, R31 = 0x%x\n", 
+                   pc, jaddr, pc + 8);
+            sim->registers.regs[31] = pc + 8;
+            resolve_control_flow(pc, CF_CALL, jaddr, true, sim->if_id_latch.btb_hit);
+            if (BINTRACE_ON()) {
+                bintrace_record(pc, instruction, BT_JUMP | BT_TAKEN, 0);
+            }
+            redirect_fetch(jaddr);
             return;
-        }   
-        // JR (레지스터 점프는 예측하기 어려움 - 일단 예측 없이)
-        else {// jr
-            uint32_t oper1 = (if_id_latch.forward_a >= 1) ? if_id_latch.forward_a_val : registers.regs[inst.rs];
-            printf("[ID] Jump Register: PC = 0x%x -> 0x%x (from R%d)\n", 
-                   registers.pc, oper1, inst.rs);
-            registers.pc = oper1;
+        }
+        // JR: jr $31은 RAS로, 나머지는 BTB의 마지막 목적지로 예측
+        case DECODE_JR: {
+            uint32_t oper1 = (sim->if_id_latch.forward_a >= 1) ? sim->if_id_latch.forward_a_val : sim->registers.regs[inst.rs];
+            TRACE(TRACE_BRANCH, "[ID] Jump Register: PC = 0x%x -> 0x%x (from R%d)\n", 
+                   pc, oper1, inst.rs);
+            resolve_control_flow(pc, (inst.rs == 31) ? CF_RETURN : CF_INDIRECT, oper1, true,
+                                 sim->if_id_latch.btb_hit);
+            if (BINTRACE_ON()) {
+                bintrace_record(pc, instruction, BT_JUMP | BT_TAKEN, 0);
+            }
+            redirect_fetch(oper1);
             return;
         }
+        case DECODE_ALU:
+            break;
     }
     
-    inst.rs_value = registers.regs[inst.rs];     
-    inst.rt_value = registers.regs[inst.rt];
+    inst.rs_value = sim->registers.regs[inst.rs];     
+    inst.rt_value = sim->registers.regs[inst.rt];
 
     if (inst.rs != 0 || inst.rt != 0) {
-        printf("[ID] Read: R%d=0x%x, R%d=0x%x\n", 
+        TRACE(TRACE_PIPELINE, "[ID] Read: R%d=0x%x, R%d=0x%x\n", 
                inst.rs, inst.rs_value, inst.rt, inst.rt_value);
     }
     
-    id_ex_latch.valid = true;
-    id_ex_latch.pc = pc;
-    id_ex_latch.instruction = inst;
-    id_ex_latch.control_signals = ctrl;
-    id_ex_latch.rs_value = inst.rs_value;
-    id_ex_latch.rt_value = inst.rt_value;
-    id_ex_latch.sign_imm = inst.immediate;
-    id_ex_latch.shamt = inst.shamt;
-    id_ex_latch.forward_a = 0;
-    id_ex_latch.forward_b = 0;
-    id_ex_latch.forward_a_val = 0;
-    id_ex_latch.forward_b_val = 0;
+    sim->id_ex_latch.valid = true;
+    sim->id_ex_latch.pc = pc;
+    sim->id_ex_latch.word = instruction;
+    sim->id_ex_latch.instruction = inst;
+    sim->id_ex_latch.control_signals = *ctrl;
+    sim->id_ex_latch.write_reg = dec->write_reg;
+    sim->id_ex_latch.rs_value = inst.rs_value;
+    sim->id_ex_latch.rt_value = inst.rt_value;
+    sim->id_ex_latch.sign_imm = inst.immediate;
+    sim->id_ex_latch.shamt = inst.shamt;
+    sim->id_ex_latch.forward_a = 0;
+    sim->id_ex_latch.forward_b = 0;
+    sim->id_ex_latch.forward_a_val = 0;
+    sim->id_ex_latch.forward_b_val = 0;
 }
 
 void decode_rtype(uint32_t instruction, Instruction* inst) {
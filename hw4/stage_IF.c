@@ -1,44 +1,62 @@
 #include "structure.h"
 
-extern uint64_t inst_count;
-
 void stage_IF() {
 
-    memset(&if_id_latch, 0, sizeof(if_id_latch));
+    memset(&sim->if_id_latch, 0, sizeof(sim->if_id_latch));
     
-    if (registers.pc == 0xFFFFFFFF) {
-        if_id_latch.valid = false;
-        printf("[IF] PC=0xFFFFFFFF (HALT)\n");
+    if (sim->registers.pc == 0xFFFFFFFF) {
+        sim->if_id_latch.valid = false;
+        TRACE(TRACE_PIPELINE, "[IF] PC=0xFFFFFFFF (HALT)\n");
         return;
     }
 
-    if ((registers.pc & 0x3) || registers.pc + 3 >= MEMORY_SIZE) {
-        if_id_latch.valid = false;
-        printf("[IF] PC=0x%08x (OUT OF BOUNDS)\n", registers.pc);
+    if ((sim->registers.pc & 0x3) || sim->registers.pc + 3 >= MEMORY_SIZE) {
+        sim->if_id_latch.valid = false;
+        TRACE(TRACE_PIPELINE, "[IF] PC=0x%08x (OUT OF BOUNDS)\n", sim->registers.pc);
         return;
     }
 
     uint32_t instruction = 0;
-    uint32_t pc = registers.pc;
+    uint32_t pc = sim->registers.pc;
     
     // 캐시를 통해 명령어 읽기
     instruction = cache_read_instruction(pc);
+    uint32_t stall = (uint32_t)cache_hit_latency(CACHE_L1I) - 1 + cache_miss_latency();
 
-    if_id_latch.next_pc = pc + 4;  
-    if_id_latch.instruction = instruction;
-    if_id_latch.pc = pc;
-    if_id_latch.valid = true;
+    // 사전 디코드로 beq/bne를 알아보고 방향 예측, 목적지는 BTB/RAS에서.
+    // 예측한 경로로 계속 페치하고, 틀리면 ID에서 바로잡는다.
+    uint32_t opcode = instruction >> 26;
+    bool predicted_taken = false;
+    if (opcode == 0x4 || opcode == 0x5) {
+        predicted_taken = predict_branch(pc);
+    }
+    sim->if_id_latch.predicted_taken = predicted_taken;
+    sim->if_id_latch.next_pc = predict_fetch_target(pc, predicted_taken, &sim->if_id_latch.btb_hit);
+    sim->if_id_latch.instruction = instruction;
+    sim->if_id_latch.pc = pc;
+    sim->if_id_latch.valid = true;
     
-    if_id_latch.opcode = instruction >> 26;                            
-    if_id_latch.reg_src = (instruction >> 21) & 0x0000001f;       
-    if_id_latch.reg_tar = (instruction >> 16) & 0x0000001f;         
-    if_id_latch.funct = instruction & 0x3f;                                
-    if_id_latch.forward_a = 0;
-    if_id_latch.forward_b = 0;
-    if_id_latch.forward_a_val = 0;
-    if_id_latch.forward_b_val = 0;
+    sim->if_id_latch.opcode = instruction >> 26;                            
+    sim->if_id_latch.reg_src = (instruction >> 21) & 0x0000001f;       
+    sim->if_id_latch.reg_tar = (instruction >> 16) & 0x0000001f;         
+    sim->if_id_latch.funct = instruction & 0x3f;                                
+    sim->if_id_latch.forward_a = 0;
+    sim->if_id_latch.forward_b = 0;
+    sim->if_id_latch.forward_a_val = 0;
+    sim->if_id_latch.forward_b_val = 0;
 
-    printf("[IF] ");
-    print_instruction_details(pc, instruction);
-    printf("\n");
-}
\ No newline at end of file
+    if (TRACE_ON(TRACE_PIPELINE)) {
+        printf("[IF] ");
+        print_instruction_details(pc, instruction);
+        printf("\n");
+    }
+
+    // I-캐시 지연: 가져온 명령어는 fetch_hold에 두었다가 기다린 뒤 ID로 넘긴다 (step_pipeline)
+    if (stall > 0) {
+        sim->fetch_hold = sim->if_id_latch;
+        sim->fetch_wait = stall;
+        sim->icache_stall_cycles++;
+        memset(&sim->if_id_latch, 0, sizeof(sim->if_id_latch));
+        TRACE(TRACE_PIPELINE, "[IF] Waiting %u cycles for I-cache\n", stall);
+    }
+}
@@ -5,10 +5,17 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include "trace.h"
+#include "memory.h"
+#include "bintrace.h"
 
-#define MEMORY_SIZE 0x1000000
+#define MEMORY_SIZE 0x1000000     // 게스트가 접근할 수 있는 주소 범위 (페이지는 필요할 때 할당)
+
+// 체크포인트 스트림 (checkpoint.c). 모듈의 *_checkpoint 함수가 자기 상태 영역을
+// 항상 같은 순서로 넘기면, 저장할 때는 파일에 쓰고 복원할 때는 그 자리로 읽어 온다.
+typedef struct Checkpoint Checkpoint;
+extern void ckpt_region(Checkpoint* ck, void* data, size_t size);
 
-extern uint8_t memory[MEMORY_SIZE];
 
 typedef struct {
     uint32_t regs[32];
@@ -45,10 +52,34 @@ typedef struct {
     uint32_t pc_plus_4;
 } Instruction;
 
+// 디코드 테이블의 dispatch 종류 (stage_ID에서 switch)
+typedef enum {
+    DECODE_ALU = 0,     // EX로 진행하는 일반 명령어 (lw/sw/lui 포함)
+    DECODE_BRANCH,      // beq, bne
+    DECODE_J,
+    DECODE_JAL,
+    DECODE_JR
+} DecodeKind;
+
+// PC별로 미리 디코드된 명령어
+typedef struct {
+    bool valid;
+    uint32_t pc;
+    uint32_t instruction;
+    DecodeKind kind;
+    Instruction inst;           // 필드와 확장된 immediate
+    Control_Signals ctrl;
+    uint32_t write_reg;
+    uint32_t branch_offset;     // beq/bne 목적지 = PC+4 + branch_offset
+    const char* name;
+} DecodedInst;
+
 typedef struct {
     uint32_t instruction;
     uint32_t pc;
-    uint32_t next_pc;  
+    uint32_t next_pc;           // IF가 이어서 페치한 주소 (BTB/RAS 예측)
+    bool btb_hit;
+    bool predicted_taken;       // beq/bne에 대한 IF 시점 방향 예측
     bool valid;
     uint32_t reg_src;
     uint32_t reg_tar;
@@ -63,6 +94,7 @@ typedef struct {
 typedef struct {
     bool valid;
     uint32_t pc;
+    uint32_t word;              // 원래 명령어 워드 (바이너리 트레이스용)
     Instruction instruction;
     Control_Signals control_signals;
     uint32_t rs_value;
@@ -106,11 +138,6 @@ typedef struct {
     bool flush;
 } HazardUnit;
 
-extern IF_ID_Latch if_id_latch;
-extern ID_EX_Latch id_ex_latch;
-extern EX_MEM_Latch ex_mem_latch;
-extern MEM_WB_Latch mem_wb_latch;
-extern Registers registers;
 
 // 파이프라인 스테이지
 extern void stage_IF(void);
@@ -145,25 +172,310 @@ extern bool predict_branch(uint32_t pc);
 extern void update_branch_predictor(uint32_t pc, bool actual_taken, bool predicted_taken);
 extern void print_branch_prediction_stats(void);
 extern void reset_branch_predictor(void);
+extern void branch_predictor_checkpoint(Checkpoint* ck);
+
+// 분기 예측기 구현 (branch_*.c). 예산(바이트) 안에서 테이블 크기를 정한다.
+typedef struct {
+    const char* name;
+    void* (*create)(uint32_t budget_bytes);
+    bool (*predict)(void* state, uint32_t pc);
+    void (*update)(void* state, uint32_t pc, bool taken);
+    void (*destroy)(void* state);
+    uint64_t (*storage_bits)(const void* state);
+    void (*describe)(const void* state, char* buf, size_t len);
+    void (*checkpoint)(void* state, Checkpoint* ck);
+} BranchPredictorOps;
+
+#define BP_DEFAULT_BUDGET 64        // 바이트, 기존 256-엔트리 bimodal과 같은 크기
+
+extern const BranchPredictorOps bimodal_predictor;
+extern const BranchPredictorOps gshare_predictor;
+extern const BranchPredictorOps tournament_predictor;
+extern const BranchPredictorOps tage_predictor;
+extern const BranchPredictorOps perceptron_predictor;
+
+extern int parse_branch_predictor(const char* name, int* kind);
+extern uint64_t branch_predictor_storage_bits(void);
+extern const char* branch_predictor_name(void);
+extern uint32_t bp_floor_pow2(uint64_t n);
+extern int bp_log2(uint32_t n);
+extern void bp_counter_update(uint8_t* counter, bool taken);
 
-extern uint64_t branch_predictions;
-extern uint64_t branch_correct_predictions;
-extern uint64_t branch_mispredictions;
+// 분기 목적지 버퍼와 리턴 주소 스택 (btb.c)
+typedef enum { CF_BRANCH = 0, CF_JUMP, CF_CALL, CF_RETURN, CF_INDIRECT } ControlFlowKind;
+
+#define BTB_DEFAULT_ENTRIES 64
+#define RAS_DEFAULT_DEPTH   8
+#define MISPREDICT_DEFAULT_PENALTY 1    // ID에서 해석하므로 최소 한 슬롯
+
+extern void init_target_predictor(void);
+extern uint32_t predict_fetch_target(uint32_t pc, bool predicted_taken, bool* btb_hit);
+extern void resolve_control_flow(uint32_t pc, ControlFlowKind kind, uint32_t target, bool taken, bool btb_hit);
+extern void reset_target_predictor(void);
+extern void print_target_prediction_stats(void);
+extern void target_predictor_checkpoint(Checkpoint* ck);
+
+
+// 캐시 계층 구성 (L1 I/D -> L2 -> L3 -> memory)
+#define CACHE_L1I 0
+#define CACHE_L1D 1
+#define CACHE_L2  2
+#define CACHE_L3  3
+#define CACHE_NUM_LEVELS 4
+
+typedef enum {
+    REPL_LRU = 0, REPL_FIFO, REPL_RANDOM,
+    REPL_PLRU,                      // 트리 PLRU (assoc는 2의 거듭제곱)
+    REPL_BIT_PLRU,                  // way별 MRU 비트
+    REPL_SRRIP, REPL_BRRIP,         // 2비트 RRIP
+    REPL_DRRIP,                     // SRRIP/BRRIP set dueling
+} ReplacementPolicy;
+typedef enum { INCL_NINE = 0, INCL_INCLUSIVE, INCL_EXCLUSIVE } InclusionPolicy;
+typedef enum { PF_NONE = 0, PF_NEXT_LINE, PF_STRIDE, PF_STREAM, PF_TARGET } PrefetcherKind;
+
+typedef struct {
+    int sets;                       // 0이면 사용하지 않는 레벨
+    int assoc;
+    int line_size;                  // 바이트, 2의 거듭제곱
+    ReplacementPolicy replacement;
+    InclusionPolicy inclusion;      // 바로 위 레벨들에 대한 포함 정책 (L2/L3)
+    PrefetcherKind prefetcher;      // L1 I/D만
+    int victim_entries;             // L1 I/D만, 0이면 victim cache 없음
+    int latency;                    // 히트 지연 (사이클). L1의 첫 사이클은 파이프라인 단계에 포함
+} CacheConfig;
+
+#define CACHE_DEFAULT_LATENCY   1
+#define CACHE_MAX_LATENCY       1000
+#define MEMORY_DEFAULT_LATENCY  0       // 기본값은 지연 없음 (기존 출력 유지), --mem-latency로 켬
+#define MEMORY_MAX_LATENCY      100000
+#define VICTIM_MAX_ENTRIES 256
+
+#define CACHE_DEFAULT_SEED 0x2545F491u
+
+extern const CacheConfig default_cache_config[CACHE_NUM_LEVELS];
+extern int validate_cache_config(void);
+extern int parse_cache_geometry(const char* spec, CacheConfig* config);
+extern int parse_replacement_policy(const char* name, ReplacementPolicy* policy);
+extern int parse_inclusion_policy(const char* name, InclusionPolicy* policy);
+
+// 3C 미스 분류용 완전 연관 LRU 섀도 캐시 (cache_3c.c)
+typedef enum { MISS_COMPULSORY = 0, MISS_CAPACITY, MISS_CONFLICT } MissClass;
+typedef struct ShadowCache ShadowCache;
+extern ShadowCache* shadow_create(int lines, int line_size);
+extern void shadow_free(ShadowCache* s);
+extern MissClass shadow_access(ShadowCache* s, uint32_t address);
+extern void shadow_checkpoint(ShadowCache* s, Checkpoint* ck);
 
 // 캐시 관련 함수들
 extern void init_cache(void);
 extern uint32_t cache_read_instruction(uint32_t address);
-extern uint32_t cache_read_data(uint32_t address);
-extern void cache_write_data(uint32_t address, uint32_t data);
+extern uint32_t cache_read_data(uint32_t address, uint32_t pc);
+extern void cache_write_data(uint32_t address, uint32_t data, uint32_t pc);
 extern void cache_flush(void);
+extern bool cache_contains(int level, uint32_t address);
+extern uint32_t cache_miss_latency(void);
+extern int cache_hit_latency(int level);
+extern void cache_set_clock(uint64_t cycles);
+extern const char* cache_tag_match_name(void);
+extern void reset_cache_statistics(void);
 extern void print_cache_statistics(void);
 extern void print_cache_configuration(void);
+extern void cache_sync_memory(void);
+extern void cache_checkpoint(Checkpoint* ck);
+
+// 하드웨어 프리페처 (prefetch.c). L1 캐시가 demand 접근마다 prefetch_observe를 부른다.
+#define PF_DEFAULT_DEGREE 4
+extern int parse_prefetcher(const char* name, PrefetcherKind* kind);
+extern const char* prefetcher_name(PrefetcherKind kind);
+extern void init_prefetchers(void);
+extern void free_prefetchers(void);
+extern void prefetch_observe(int level, uint32_t pc, uint32_t address, uint32_t word, bool hit, bool prefetched);
+extern bool prefetch_take(int level, uint32_t block, uint8_t* out, uint64_t* ready);
+extern void prefetch_checkpoint(Checkpoint* ck);
+// 프리페처가 쓰는 캐시 쪽 함수
+extern void cache_prefetch(int level, uint32_t address);
+extern bool cache_prefetch_to_buffer(int level, uint32_t block, uint8_t* out, uint64_t* ready);
+extern void cache_release_buffer(int level, uint32_t block, const uint8_t* data);
+
+// 스택 거리 기반 다중 구성 캐시 스윕
+#define SWEEP_STREAM_INST 0
+#define SWEEP_STREAM_DATA 1
+extern void init_cache_sweep(void);
+extern void cache_sweep_access(int stream_id, uint32_t address);
+extern void reset_cache_sweep_statistics(void);
+extern void print_cache_sweep(void);
+extern void cache_sweep_checkpoint(Checkpoint* ck);
 
 extern const char* get_instruction_name(uint32_t opcode, uint32_t funct);
 
+// 디코드 테이블
+extern void init_decode_cache(uint32_t text_start, uint32_t text_end);
+extern const DecodedInst* decode_lookup(uint32_t pc, uint32_t instruction);
+extern void decode_cache_invalidate(uint32_t address);
+extern void decode_cache_checkpoint(Checkpoint* ck);
+extern void decode_cache_clear(void);
+
 extern void extend_imm_val(Instruction*);
 
-extern uint64_t g_inst_count;
+
+// 기능 시뮬레이션 (fast-forward)
+extern bool functional_step(bool warm);
+extern uint64_t fast_forward(uint64_t max_insts, bool use_stop_pc, uint32_t stop_pc, bool warm);
 
 extern void print_instruction_details(uint32_t pc, uint32_t instruction);
-#endif
\ No newline at end of file
+
+// 논블로킹 D-캐시 (mshr.c)
+#define MSHR_MAX_ENTRIES 64
+extern void init_mshr(void);
+extern void mshr_tick(void);
+extern bool mshr_mem_blocked(void);
+extern void mshr_record(uint32_t address, uint32_t dest_reg);
+extern bool mshr_id_blocked(void);
+extern void mshr_advance(uint64_t cycles);
+extern void get_mshr_stalls(uint64_t* data, uint64_t* full);
+extern void print_mshr_stats(void);
+extern void mshr_checkpoint(Checkpoint* ck);
+
+// 체크포인트 파일 (checkpoint.c)
+extern int checkpoint_save(const char* path);
+extern int checkpoint_restore(const char* path);
+extern int checkpoint_write_state(FILE* fp);
+extern int checkpoint_read_state(const uint8_t* data, size_t size);
+
+// 시간 여행 디버거 (timetravel.c, --debug)
+#define SNAPSHOT_DEFAULT_INTERVAL   100000      // 사이클
+#define SNAPSHOT_DEFAULT_MEM_MB     64
+
+extern void debug_session(bool halted);
+extern void debug_note_retire(uint32_t pc);
+extern void debug_note_store(uint32_t address, uint32_t value, uint32_t pc);
+
+// 프로그램 로더 (raw .bin, ELF32 BE/LE)
+extern int load_program(const char* filename, uint32_t load_addr, uint32_t* entry_pc);
+
+// 바이너리 실행 트레이스 (bintrace_writer.c, 형식은 bintrace.h)
+extern int bintrace_open(const char* path);
+extern void bintrace_record(uint32_t pc, uint32_t word, uint8_t flags, uint32_t addr);
+extern int bintrace_close(void);
+extern void print_bintrace_stats(void);
+
+#define BINTRACE_ON()   __builtin_expect(sim->bintrace != NULL, 0)
+
+// 시뮬레이터 컨텍스트
+// 한 번의 시뮬레이션에 필요한 모든 상태. 스레드마다 sim이 자기 컨텍스트를
+// 가리키므로 여러 구성을 한 프로세스에서 동시에 실행할 수 있다.
+struct CacheHierarchy;
+struct PredictorState;
+struct TargetPredictor;
+struct DecodeTable;
+struct SweepState;
+struct TraceWriter;
+struct MshrFile;
+struct TimeTravel;
+
+typedef struct SimContext {
+    GuestMemory memory;             // 페이지 단위 지연 할당
+
+    // registers부터 mem_stall까지는 포인터 없는 값만 둔다. 체크포인트가 이 범위를 통째로 저장한다.
+    Registers registers;
+    IF_ID_Latch if_id_latch;
+    ID_EX_Latch id_ex_latch;
+    EX_MEM_Latch ex_mem_latch;
+    MEM_WB_Latch mem_wb_latch;
+
+    // step_pipeline 제어 상태
+    int exit_proc;
+    int ctrl_flow[4];
+
+    // 통계
+    uint64_t inst_count;
+    uint64_t r_count;
+    uint64_t i_count;
+    uint64_t branch_jr_count;
+    uint64_t lw_count;
+    uint64_t sw_count;
+    uint64_t nop_count;
+    uint64_t write_reg_count;
+    uint64_t g_stall_count;
+    uint64_t stall_count;
+    uint64_t branch_predictions;
+    uint64_t branch_correct_predictions;
+    uint64_t branch_mispredictions;
+    uint64_t ff_inst_count;
+    uint64_t fetch_redirects;       // ID에서 페치 주소를 바로잡은 횟수
+    uint64_t fetch_squashed;        // 그 때문에 버린 페치 슬롯
+    int fetch_squash_pending;       // 앞으로 버블로 대체할 IF 사이클 수
+    uint64_t icache_stall_cycles;   // I-캐시 지연으로 ID에 버블을 보낸 사이클
+    uint64_t dcache_stall_cycles;   // D-캐시 지연으로 MEM과 그 앞 단계가 멈춘 사이클
+    uint64_t icache_overlap_cycles; // 그중 I-캐시 지연과 겹친 사이클 (양쪽에 모두 셈)
+
+    // 캐시 지연
+    IF_ID_Latch fetch_hold;         // 아직 도착하지 않은 페치 결과
+    uint32_t fetch_wait;            // fetch_hold를 ID로 넘기기까지 남은 사이클
+    uint32_t mem_stall;             // 이번 사이클의 D-캐시 접근이 더 걸리는 사이클
+
+    // 구성
+    CacheConfig cache_config[CACHE_NUM_LEVELS];
+    bool cache_sweep_enabled;
+    uint32_t cache_seed;            // --cache-seed (random/BRRIP 교체의 난수 시드)
+    int prefetch_degree;            // --pf-degree
+    int memory_latency;             // --mem-latency (마지막 캐시 레벨 미스에 더해지는 사이클)
+    uint64_t ff_insts;              // --fast-forward
+    bool ff_use_pc;                 // --ff-until-pc
+    uint32_t ff_stop_pc;
+    bool ff_warm;
+    int bp_kind;                    // --bp
+    uint32_t bp_budget;             // --bp-budget
+    uint32_t btb_entries;           // --btb-entries
+    int ras_depth;                  // --ras-depth
+    int mispredict_penalty;         // --mispredict-penalty (버리는 페치 슬롯 수)
+    int mshr_entries;               // --mshrs (0이면 미스가 파이프라인을 멈추지 않음)
+
+    // 모듈별 내부 상태 (각 .c 파일에서 정의)
+    struct CacheHierarchy* cache;
+    struct PrefetchUnits* prefetch;
+    struct PredictorState* predictor;
+    struct TargetPredictor* target;
+    struct DecodeTable* decode;
+    struct SweepState* sweep;
+    struct TraceWriter* bintrace;   // --trace-out이 없으면 NULL
+    struct MshrFile* mshr;          // --mshrs가 없으면 NULL
+    const char* bintrace_path;
+    const char* checkpoint_path;    // --checkpoint-at이 있으면 저장할 파일, 아니면 NULL
+    uint64_t checkpoint_at;         // --checkpoint-at (사이클)
+    const char* restore_path;       // --restore
+    bool debug_enabled;             // --debug
+    uint64_t snapshot_interval;     // --snapshot-interval (사이클)
+    uint64_t snapshot_limit;        // --snapshot-mem (바이트)
+    struct TimeTravel* debug;       // 디버그 세션 중에만 NULL이 아님
+} SimContext;
+
+extern _Thread_local SimContext* sim;
+
+extern SimContext* sim_create(void);
+extern void sim_destroy(SimContext* ctx);
+extern int sim_apply_option(SimContext* ctx, int argc, char** argv, int i);
+extern SimContext* sim_create_from_line(const SimContext* base, const char* config, int line_no);
+extern int sim_read_config_file(const char* path, const SimContext* base,
+                                SimContext*** ctxs_out, char*** lines_out);
+extern int sim_run(const char* program_path, uint32_t entry_pc);
+extern bool step_pipeline(void);
+extern void free_cache(void);
+extern void free_branch_predictor(void);
+extern void free_target_predictor(void);
+extern void free_decode_cache(void);
+extern void free_cache_sweep(void);
+extern void free_bintrace(void);
+extern void free_mshr(void);
+
+// 설계 공간 탐색 (sim_driver.c)
+typedef struct {
+    uint64_t access;
+    uint64_t hit;
+} CacheLevelSummary;
+
+extern void get_cache_level_summary(int level, CacheLevelSummary* out);
+extern int run_design_sweep(const char* program_path, uint32_t entry_pc,
+                            const char* config_file, int jobs);
+
+#endif
@@ -0,0 +1,512 @@
+#define _POSIX_C_SOURCE 200809L
+#include "structure.h"
+#include <stdlib.h>
+
+// 시간 여행 디버거 (--debug)
+// 처음 가 보는 구간을 실행하는 동안 --snapshot-interval 사이클마다 스냅샷을 잡는다.
+// 스냅샷은 체크포인트와 같은 상태(컨텍스트 값과 모듈 섹션)를 메모리 스트림에 쓴 것과
+// 게스트 페이지 목록이다. 페이지는 복사하지 않고 참조만 늘려 두므로, 그 뒤 게스트가
+// 쓰는 페이지만 memory.c가 복사한다 (copy-on-write).
+// 뒤로 가는 명령은 목표보다 앞선 가장 가까운 스냅샷을 되돌리고 목표까지 다시 실행한다.
+// 시뮬레이션은 결정적이므로 다시 실행한 결과는 처음 실행과 같다.
+// 위치는 step_pipeline 호출 횟수(step)로 센다. 한 번의 호출이 지연을 건너뛰며 여러
+// 사이클을 진행할 수 있으므로 사용자에게는 그 step이 끝난 사이클을 보여 준다.
+// 스냅샷 메모리가 --snapshot-mem을 넘으면 첫 스냅샷만 남기고 하나 건너 하나씩 버리고
+// 간격을 두 배로 늘린다. 뒤로 갈 때 다시 실행할 구간이 길어지는 대신 메모리는
+// 실행 길이와 상관없이 한도 안에 머문다.
+
+#define MAX_BREAKPOINTS 16
+#define LINE_MAX_CHARS  256
+
+typedef struct {
+    uint64_t step;              // 이 스냅샷까지 부른 step_pipeline 횟수
+    uint64_t cycle;
+    uint8_t* state;             // checkpoint_write_state 결과
+    size_t state_size;
+    MemPageRef* pages;
+    size_t num_pages;
+    uint64_t cost;              // 앞 스냅샷과 공유하지 않는 바이트
+} Snapshot;
+
+enum { HIT_NONE, HIT_BREAK, HIT_STORE };
+
+struct TimeTravel {
+    Snapshot* snaps;
+    int count;
+    int capacity;
+    uint64_t used;              // cost 합
+    uint64_t interval;          // 현재 스냅샷 간격 (사이클)
+    uint64_t next_snapshot;     // 다음 스냅샷을 잡을 사이클
+    uint64_t thinned;           // 메모리 한도 때문에 버린 스냅샷 수
+
+    uint64_t step;              // 현재 위치
+    uint64_t frontier;          // 지금까지 실행한 가장 먼 step
+    bool finished;              // 현재 위치에서 프로그램이 끝났음
+
+    // 정지 조건. query면 last-write 질의 중이라 query_word에 대한 store만 본다.
+    uint32_t breakpoints[MAX_BREAKPOINTS];
+    int num_breakpoints;
+    bool watching;
+    uint32_t watch_word;
+    bool query;
+    uint32_t query_word;
+
+    // 마지막 step에서 걸린 정지 조건
+    int hit;
+    uint32_t hit_pc;
+    uint32_t hit_address;
+    uint32_t hit_value;
+};
+
+// ---------------------------------------------------------------------------
+// 파이프라인 훅 (stage_WB, stage_MEM)
+// ---------------------------------------------------------------------------
+
+void debug_note_retire(uint32_t pc) {
+    struct TimeTravel* tt = sim->debug;
+    if (tt->query) {
+        return;
+    }
+    for (int i = 0; i < tt->num_breakpoints; i++) {
+        if (tt->breakpoints[i] == pc) {
+            tt->hit = HIT_BREAK;
+            tt->hit_pc = pc;
+            return;
+        }
+    }
+}
+
+// 워드 단위로 비교한다 (정렬되지 않은 SW도 시작 주소의 워드로 센다)
+void debug_note_store(uint32_t address, uint32_t value, uint32_t pc) {
+    struct TimeTravel* tt = sim->debug;
+    bool on = tt->query || tt->watching;
+    uint32_t word = tt->query ? tt->query_word : tt->watch_word;
+
+    if (on && (address & ~3u) == word) {
+        tt->hit = HIT_STORE;
+        tt->hit_pc = pc;
+        tt->hit_address = address;
+        tt->hit_value = value;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 스냅샷
+// ---------------------------------------------------------------------------
+
+static void out_of_memory(void) {
+    fprintf(stderr, "time travel: out of memory\n");
+    exit(1);
+}
+
+// 앞 스냅샷과 다른 페이지만 새로 메모리를 쓴다 (두 목록 모두 페이지 번호 순)
+static uint64_t snapshot_cost(const Snapshot* prev, const Snapshot* s) {
+    uint64_t bytes = s->state_size + s->num_pages * sizeof(MemPageRef);
+    size_t j = 0;
+
+    for (size_t i = 0; i < s->num_pages; i++) {
+        while (prev != NULL && j < prev->num_pages && prev->pages[j].page < s->pages[i].page) {
+            j++;
+        }
+        if (prev == NULL || j == prev->num_pages || prev->pages[j].page != s->pages[i].page ||
+            prev->pages[j].data != s->pages[i].data) {
+            bytes += MEM_PAGE_SIZE;
+        }
+    }
+    return bytes;
+}
+
+static void drop_snapshot(Snapshot* s) {
+    free(s->state);
+    mem_release_pages(&sim->memory, s->pages, s->num_pages);
+}
+
+// 첫 스냅샷과 마지막 스냅샷은 남기고 그 사이를 하나 건너 하나씩 버린다
+static void thin_snapshots(struct TimeTravel* tt) {
+    int kept = 1;
+    for (int i = 1; i < tt->count; i++) {
+        if (i % 2 == 0 || i == tt->count - 1) {
+            tt->snaps[kept++] = tt->snaps[i];
+        } else {
+            drop_snapshot(&tt->snaps[i]);
+            tt->thinned++;
+        }
+    }
+    tt->count = kept;
+
+    tt->used = 0;
+    for (int i = 0; i < tt->count; i++) {
+        tt->snaps[i].cost = snapshot_cost(i > 0 ? &tt->snaps[i - 1] : NULL, &tt->snaps[i]);
+        tt->used += tt->snaps[i].cost;
+    }
+    tt->interval *= 2;
+}
+
+static void take_snapshot(struct TimeTravel* tt) {
+    if (tt->count == tt->capacity) {
+        int capacity = tt->capacity ? tt->capacity * 2 : 64;
+        Snapshot* snaps = realloc(tt->snaps, sizeof(Snapshot) * capacity);
+        if (snaps == NULL) {
+            out_of_memory();
+        }
+        tt->snaps = snaps;
+        tt->capacity = capacity;
+    }
+
+    Snapshot* s = &tt->snaps[tt->count];
+    char* state = NULL;
+    size_t state_size = 0;
+    FILE* fp = open_memstream(&state, &state_size);
+    if (fp == NULL) {
+        out_of_memory();
+    }
+    int status = checkpoint_write_state(fp);
+    if (fclose(fp) != 0 || status != 0) {
+        out_of_memory();
+    }
+
+    s->step = tt->step;
+    s->cycle = sim->inst_count;
+    s->state = (uint8_t*)state;
+    s->state_size = state_size;
+    s->num_pages = mem_share_pages(&sim->memory, &s->pages);
+    s->cost = snapshot_cost(tt->count > 0 ? &tt->snaps[tt->count - 1] : NULL, s);
+    tt->used += s->cost;
+    tt->count++;
+
+    while (tt->used > sim->snapshot_limit && tt->count > 2) {
+        thin_snapshots(tt);
+    }
+    tt->next_snapshot = sim->inst_count + tt->interval;
+}
+
+static void restore_snapshot(struct TimeTravel* tt, const Snapshot* s) {
+    mem_restore_pages(&sim->memory, s->pages, s->num_pages);
+    if (checkpoint_read_state(s->state, s->state_size) != 0) {
+        fprintf(stderr, "time travel: snapshot at cycle %llu is corrupt\n", (unsigned long long)s->cycle);
+        exit(1);
+    }
+    decode_cache_clear();
+    tt->step = s->step;
+    tt->finished = false;
+    tt->hit = HIT_NONE;
+}
+
+// step 이하에서 가장 늦은 스냅샷 (첫 스냅샷은 step 0)
+static int snapshot_before(const struct TimeTravel* tt, uint64_t step) {
+    int lo = 0, hi = tt->count - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (tt->snaps[mid].step <= step) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return lo;
+}
+
+// ---------------------------------------------------------------------------
+// 실행과 되감기
+// ---------------------------------------------------------------------------
+
+// 한 step 진행. 처음 가 보는 구간이면 간격마다 스냅샷을 잡는다.
+static bool advance(struct TimeTravel* tt) {
+    tt->hit = HIT_NONE;
+    bool running = step_pipeline();
+    tt->step++;
+    if (!running) {
+        tt->finished = true;
+    }
+    if (tt->step > tt->frontier) {
+        tt->frontier = tt->step;
+        if (running && sim->inst_count >= tt->next_snapshot) {
+            take_snapshot(tt);
+        }
+    }
+    return running;
+}
+
+// 다시 실행하는 구간은 이미 본 출력이므로 트레이스를 끈다
+typedef struct {
+    int level;
+    unsigned int mask;
+} TraceSave;
+
+static TraceSave trace_off(void) {
+    TraceSave saved = {trace_level, trace_mask};
+    trace_level = TRACE_LEVEL_QUIET;
+    trace_mask = 0;
+    return saved;
+}
+
+static void trace_restore(TraceSave saved) {
+    trace_level = saved.level;
+    trace_mask = saved.mask;
+}
+
+// target step으로 간다. 뒤로 가면 스냅샷을 되돌리고 조용히 다시 실행한다.
+static void replay_to(struct TimeTravel* tt, uint64_t target) {
+    TraceSave saved = trace_off();
+    if (target < tt->step) {
+        restore_snapshot(tt, &tt->snaps[snapshot_before(tt, target)]);
+    }
+    while (tt->step < target && !tt->finished) {
+        advance(tt);
+    }
+    trace_restore(saved);
+}
+
+// before보다 앞선 step 중 정지 조건이 걸린 마지막 step, 없으면 0
+// 가장 늦은 스냅샷 구간부터 거꾸로 하나씩 다시 실행해 본다.
+static uint64_t find_last_hit(struct TimeTravel* tt, uint64_t before) {
+    TraceSave saved = trace_off();
+    uint64_t found = 0;
+
+    if (before > 0) {
+        for (int k = snapshot_before(tt, before - 1); k >= 0 && found == 0; k--) {
+            uint64_t end = before - 1;
+            if (k + 1 < tt->count && tt->snaps[k + 1].step < end) {
+                end = tt->snaps[k + 1].step;
+            }
+            restore_snapshot(tt, &tt->snaps[k]);
+            while (tt->step < end && !tt->finished) {
+                advance(tt);
+                if (tt->hit != HIT_NONE) {
+                    found = tt->step;
+                }
+            }
+        }
+    }
+    trace_restore(saved);
+    return found;
+}
+
+// ---------------------------------------------------------------------------
+// 명령
+// ---------------------------------------------------------------------------
+
+static void print_position(const struct TimeTravel* tt) {
+    switch (tt->hit) {
+    case HIT_BREAK:
+        printf("Breakpoint: PC=0x%08x retired\n", tt->hit_pc);
+        break;
+    case HIT_STORE:
+        printf("Watchpoint: Mem[0x%08x] = 0x%08x by PC=0x%08x\n", tt->hit_address, tt->hit_value, tt->hit_pc);
+        break;
+    }
+    printf("cycle %llu, PC=0x%08x%s\n", (unsigned long long)sim->inst_count, sim->registers.pc,
+           tt->finished ? " (program finished)" : "");
+}
+
+static void print_latch(const char* name, bool valid, uint32_t pc) {
+    if (valid) {
+        printf("  %-6s PC=0x%08x\n", name, pc);
+    } else {
+        printf("  %-6s (bubble)\n", name);
+    }
+}
+
+static void print_state(const struct TimeTravel* tt) {
+    printf("cycle %llu (step %llu), PC=0x%08x%s\n", (unsigned long long)sim->inst_count,
+           (unsigned long long)tt->step, sim->registers.pc, tt->finished ? " (program finished)" : "");
+    for (int r = 0; r < 32; r++) {
+        printf("  R%-2d = 0x%08x%s", r, sim->registers.regs[r], (r % 4 == 3) ? "\n" : "");
+    }
+    print_latch("IF/ID", sim->if_id_latch.valid, sim->if_id_latch.pc);
+    print_latch("ID/EX", sim->id_ex_latch.valid, sim->id_ex_latch.pc);
+    print_latch("EX/MEM", sim->ex_mem_latch.valid, sim->ex_mem_latch.pc);
+    print_latch("MEM/WB", sim->mem_wb_latch.valid, sim->mem_wb_latch.pc);
+    printf("snapshots: %d (%.1f of %llu MB, interval %llu cycles, %llu dropped)\n", tt->count,
+           tt->used / 1048576.0, (unsigned long long)(sim->snapshot_limit >> 20),
+           (unsigned long long)tt->interval, (unsigned long long)tt->thinned);
+}
+
+static void cmd_step(struct TimeTravel* tt, uint64_t n) {
+    if (tt->finished) {
+        printf("The program has finished\n");
+        return;
+    }
+    for (uint64_t i = 0; i < n; i++) {
+        if (!advance(tt) || tt->hit != HIT_NONE) {
+            break;
+        }
+    }
+    print_position(tt);
+}
+
+static void cmd_reverse_step(struct TimeTravel* tt, uint64_t n) {
+    if (tt->step == 0) {
+        printf("Already at the start\n");
+        return;
+    }
+    replay_to(tt, (n < tt->step) ? tt->step - n : 0);
+    print_position(tt);
+}
+
+static void cmd_continue(struct TimeTravel* tt) {
+    if (tt->finished) {
+        printf("The program has finished\n");
+        return;
+    }
+    while (advance(tt) && tt->hit == HIT_NONE) {
+    }
+    print_position(tt);
+}
+
+static void cmd_reverse_continue(struct TimeTravel* tt) {
+    if (tt->step == 0) {
+        printf("Already at the start\n");
+        return;
+    }
+    uint64_t target = find_last_hit(tt, tt->step);
+    replay_to(tt, target);
+    if (target == 0) {
+        printf("No earlier stop, at the start\n");
+    }
+    print_position(tt);
+}
+
+static void cmd_goto(struct TimeTravel* tt, uint64_t cycle) {
+    if (cycle < sim->inst_count) {
+        // 목표 사이클 이전의 가장 늦은 스냅샷부터
+        int k = 0;
+        while (k + 1 < tt->count && tt->snaps[k + 1].cycle <= cycle) {
+            k++;
+        }
+        TraceSave saved = trace_off();
+        restore_snapshot(tt, &tt->snaps[k]);
+        while (sim->inst_count < cycle && !tt->finished) {
+            advance(tt);
+        }
+        trace_restore(saved);
+    } else {
+        while (sim->inst_count < cycle && !tt->finished) {
+            advance(tt);
+        }
+    }
+    tt->hit = HIT_NONE;
+    print_position(tt);
+}
+
+// 현재 위치 전에 address가 든 워드를 마지막으로 쓴 store를 찾고 제자리로 돌아온다
+static void cmd_last_write(struct TimeTravel* tt, uint32_t address) {
+    uint64_t here = tt->step;
+    uint64_t here_cycle = sim->inst_count;      // 검색이 시뮬레이터를 옮기기 전에 저장
+    tt->query = true;
+    tt->query_word = address & ~3u;
+
+    // 현재 step의 store도 포함한다 (이미 실행된 MEM)
+    uint64_t found = find_last_hit(tt, here + 1);
+    if (found == 0) {
+        printf("Mem[0x%08x] was not written before cycle %llu\n", address, (unsigned long long)here_cycle);
+    } else {
+        replay_to(tt, found);
+        printf("Mem[0x%08x] last written at cycle %llu: 0x%08x by PC=0x%08x (SW to 0x%08x)\n",
+               address, (unsigned long long)sim->inst_count, tt->hit_value, tt->hit_pc, tt->hit_address);
+    }
+    tt->query = false;
+    replay_to(tt, here);
+    tt->hit = HIT_NONE;
+}
+
+static void cmd_break(struct TimeTravel* tt, const char* arg) {
+    if (arg == NULL) {
+        printf("usage: break PC\n");
+    } else if (tt->num_breakpoints == MAX_BREAKPOINTS) {
+        printf("Too many breakpoints (max %d)\n", MAX_BREAKPOINTS);
+    } else {
+        uint32_t pc = (uint32_t)strtoul(arg, NULL, 16);
+        tt->breakpoints[tt->num_breakpoints++] = pc;
+        printf("Breakpoint %d at PC=0x%08x\n", tt->num_breakpoints, pc);
+    }
+}
+
+static void print_help(void) {
+    printf("step|s [N]             N step 앞으로 (기본값 1)\n");
+    printf("reverse-step|rs [N]    N step 뒤로\n");
+    printf("continue|c             정지 조건까지 앞으로\n");
+    printf("reverse-continue|rc    앞선 정지 조건까지 뒤로\n");
+    printf("break|b PC             PC(hex)의 명령어가 WB를 지나면 정지\n");
+    printf("watch|w ADDR           ADDR(hex)가 든 워드에 SW하면 정지\n");
+    printf("delete|d               정지 조건 모두 지우기\n");
+    printf("last-write|lw ADDR     ADDR(hex)가 든 워드를 마지막으로 쓴 사이클과 PC\n");
+    printf("goto|g CYCLE           CYCLE 사이클로 이동\n");
+    printf("info|i                 레지스터, 래치, 스냅샷 상태\n");
+    printf("quit|q                 현재 위치의 통계를 출력하고 종료\n");
+}
+
+static bool is_command(const char* cmd, const char* name, const char* alias) {
+    return strcmp(cmd, name) == 0 || strcmp(cmd, alias) == 0;
+}
+
+static void command_loop(struct TimeTravel* tt) {
+    char line[LINE_MAX_CHARS];
+
+    for (;;) {
+        printf("(mips) ");
+        fflush(stdout);
+        if (fgets(line, sizeof(line), stdin) == NULL) {
+            printf("\n");
+            return;
+        }
+        char* save = NULL;
+        char* cmd = strtok_r(line, " \t\r\n", &save);
+        char* arg = strtok_r(NULL, " \t\r\n", &save);
+        uint64_t n = (arg != NULL) ? strtoull(arg, NULL, 0) : 1;
+
+        if (cmd == NULL) {
+            continue;
+        } else if (is_command(cmd, "step", "s")) {
+            cmd_step(tt, n);
+        } else if (is_command(cmd, "reverse-step", "rs")) {
+            cmd_reverse_step(tt, n);
+        } else if (is_command(cmd, "continue", "c")) {
+            cmd_continue(tt);
+        } else if (is_command(cmd, "reverse-continue", "rc")) {
+            cmd_reverse_continue(tt);
+        } else if (is_command(cmd, "break", "b")) {
+            cmd_break(tt, arg);
+        } else if (is_command(cmd, "watch", "w") && arg != NULL) {
+            tt->watching = true;
+            tt->watch_word = (uint32_t)strtoul(arg, NULL, 16) & ~3u;
+            printf("Watchpoint on Mem[0x%08x]\n", tt->watch_word);
+        } else if (is_command(cmd, "delete", "d")) {
+            tt->num_breakpoints = 0;
+            tt->watching = false;
+        } else if (is_command(cmd, "last-write", "lw") && arg != NULL) {
+            cmd_last_write(tt, (uint32_t)strtoul(arg, NULL, 16));
+        } else if (is_command(cmd, "goto", "g") && arg != NULL) {
+            cmd_goto(tt, strtoull(arg, NULL, 0));
+        } else if (is_command(cmd, "info", "i")) {
+            print_state(tt);
+        } else if (is_command(cmd, "quit", "q")) {
+            return;
+        } else {
+            print_help();
+        }
+    }
+}
+
+// 프로그램을 올린 sim에서 명령을 받아 실행한다. 끝나면 sim은 마지막 위치의 상태.
+// halted면 fast-forward 중 프로그램이 이미 끝난 것.
+void debug_session(bool halted) {
+    struct TimeTravel* tt = calloc(1, sizeof(struct TimeTravel));
+    if (tt == NULL) {
+        out_of_memory();
+    }
+    tt->interval = sim->snapshot_interval;
+    tt->finished = halted;
+    sim->debug = tt;
+
+    take_snapshot(tt);
+    print_position(tt);
+    command_loop(tt);
+
+    for (int i = 0; i < tt->count; i++) {
+        drop_snapshot(&tt->snaps[i]);
+    }
+    free(tt->snaps);
+    free(tt);
+    sim->debug = NULL;
+}
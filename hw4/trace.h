@@ -0,0 +1,41 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+
+// 트레이스 카테고리 (비트마스크)
+#define TRACE_PIPELINE  0x01    // 스테이지별 진행, 사이클 헤더
+#define TRACE_HAZARD    0x02    // 포워딩, 스톨, 플러시
+#define TRACE_ICACHE    0x04    // 명령어 캐시 hit/miss
+#define TRACE_DCACHE    0x08    // 데이터 캐시 hit/miss
+#define TRACE_BRANCH    0x10    // 분기/점프 해석과 예측
+#define TRACE_ALL       0x1f
+
+// 트레이스 레벨
+#define TRACE_LEVEL_QUIET   0   // print_statistics()만 출력
+#define TRACE_LEVEL_INFO    1   // 로드, 설정, 플러시 등 진행 메시지
+#define TRACE_LEVEL_CYCLE   2   // 사이클 단위 상세 출력 (기본값)
+
+extern int trace_level;
+extern unsigned int trace_mask;     // trace_level < CYCLE이면 0
+
+// NO_TRACE로 빌드하면 사이클 단위 출력 경로가 컴파일 단계에서 사라진다.
+// 그 외에는 전역 마스크 검사 한 번으로 끝나는, 거의 항상 not-taken인 분기.
+#ifdef NO_TRACE
+#define TRACE_ON(cat)   0
+#else
+#define TRACE_ON(cat)   __builtin_expect((trace_mask & (cat)) != 0, 0)
+#endif
+
+#define TRACE_INFO_ON() (trace_level >= TRACE_LEVEL_INFO)
+
+// 인자는 트레이스가 켜져 있을 때만 평가된다
+#define TRACE(cat, ...) \
+    do { if (TRACE_ON(cat)) printf(__VA_ARGS__); } while (0)
+
+#define TRACE_INFO(...) \
+    do { if (TRACE_INFO_ON()) printf(__VA_ARGS__); } while (0)
+
+extern int parse_trace_categories(const char* list, unsigned int* mask);
+
+#endif
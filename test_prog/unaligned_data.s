@@ -0,0 +1,18 @@
+# 크기가 4의 배수가 아닌 .data (6바이트) 로더 회귀 테스트
+# llvm-mc -triple=mipsel -filetype=obj unaligned_data.s -o unaligned_data.o
+# LE 파일의 데이터 워드는 로드할 때 뒤집히므로 data+4의 워드는
+# 바이트 05 06 00 00 = 0x00000605, 기대하는 r2 = 1541
+        .set    noreorder
+        .text
+        .globl  main
+main:
+        lui     $8, %hi(data)
+        addiu   $8, $8, %lo(data)
+        lw      $2, 4($8)
+        nop
+        jr      $31
+        nop
+
+        .data
+data:
+        .byte   1, 2, 3, 4, 5, 6